@@ -1,3 +1,6 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
 #include<memory>
 
 using CameraAPI = void;
@@ -64,10 +67,11 @@ private:
     void* internal_ = nullptr;   // CameraAPI を外から絶対見えないように opaque にする
 };
 
-CameraFrame makeCameraFrame(CameraAPI* api)
+inline CameraFrame makeCameraFrame(CameraAPI* api)
 {
-    uint8_t* p;
-    size_t size;
+    uint8_t* p = nullptr;
+    size_t size = 0;
+    (void)api;
     // FrameHandle h;
 
     // api->RecvFrame(&p, &size, &h);
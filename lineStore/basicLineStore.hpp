@@ -0,0 +1,79 @@
+#pragma once
+// BasicLineStore.hpp
+// 画素型・線形/リング・2 のべき乗容量をコンパイル時に固定した LineStore
+// Push / 窓取得は特殊化された実装を直接呼ぶ（LineStore の関数ポインタ経由の呼び分けも無い）。
+// Commit・カーソル・待機・時刻検索などは Store() の LineStore をそのまま使う
+
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+
+#include "lineStore2.hpp"
+
+template <class PixelT, bool Circular, bool Pow2 = false>
+class BasicLineStore
+{
+    static_assert(std::is_same_v<PixelT, std::uint8_t> || std::is_same_v<PixelT, std::uint16_t>,
+                  "PixelT は uint8_t / uint16_t");
+    static_assert(Circular || !Pow2, "Pow2 はリングモード用");
+
+public:
+    using i64 = LineStore::i64;
+
+    static constexpr PixelType PIXEL = std::is_same_v<PixelT, std::uint8_t> ? PixelType::U8 : PixelType::U16;
+
+    // opt.Circular / PowerOfTwoCapacity はテンプレート引数で上書きする
+    BasicLineStore(int srcWidth, int roiX, int roiW,
+                   i64 capacityLines, int warmupMax,
+                   const LineStoreOptions& opt = {})
+        : store_(srcWidth, roiX, roiW, capacityLines, warmupMax, PIXEL, with_mode(opt))
+    {
+        if (Pow2 && store_.capMask_ < 0) throw std::logic_error("capacity is not a power of two");
+        if (store_.adopt_) throw std::invalid_argument("AdoptFrames is not supported by BasicLineStore");
+    }
+
+    BasicLineStore(const BasicLineStore&) = delete;
+    BasicLineStore& operator=(const BasicLineStore&) = delete;
+
+    LineStore&       Store() noexcept       { return store_; }
+    const LineStore& Store() const noexcept { return store_; }
+
+    void Commit() { store_.Commit(); }
+
+    // ---- 書き込み ----
+    bool PushBlock(const void* src, int rows, int srcStrideBytes, double acquiredUtcSec) {
+        LineStore::PushTimer timer{ store_ };
+        return store_.template PushRowsT<PixelT, Circular, Pow2>(src, rows, srcStrideBytes, acquiredUtcSec, /*newSeg=*/true);
+    }
+    bool PushBlock(const void* src, int rows, int srcStrideBytes) {
+        return PushBlock(src, rows, srcStrideBytes, store_.NowSec());
+    }
+
+    // ---- 読み出し（LineStore::TryGetWindowPtr と同じ。ptr は画素型）----
+    bool TryGetWindowPtr(i64 startRow, int winW, int winH, int x0,
+                         const PixelT*& ptr, int& strideBytes, double& timeSecAtTop) const noexcept
+    {
+        const void* p = nullptr;
+        const bool  ok = store_.template TryGetWindowPtrT<PixelT, Circular, Pow2>(startRow, winW, winH, x0, p, strideBytes, timeSecAtTop);
+        ptr = static_cast<const PixelT*>(p);
+        return ok;
+    }
+
+    bool TryGetLatestWindowPtr(int winW, int winH, int x0,
+                               const PixelT*& ptr, int& strideBytes, double& timeSecAtTop) const noexcept
+    {
+        ptr = nullptr;
+        const i64 avail = store_.StoredLines();
+        if (winH <= 0 || avail < winH) return false;
+        return TryGetWindowPtr(avail - winH, winW, winH, x0, ptr, strideBytes, timeSecAtTop);
+    }
+
+private:
+    static LineStoreOptions with_mode(LineStoreOptions opt) {
+        opt.Circular           = Circular;
+        opt.PowerOfTwoCapacity = Pow2;
+        return opt;
+    }
+
+    LineStore store_;
+};
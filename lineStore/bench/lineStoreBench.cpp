@@ -0,0 +1,386 @@
+// LineStoreBench.cpp
+// LineStore のマイクロベンチマーク。結果は 1 行 1 レコードの JSON（JSON Lines）で標準出力へ出す。
+//
+//   lineStore_bench    : 現行の lineStore2
+//   lineStore_bench_v1 : 旧 lineStore.cpp（同じソースを LINESTORE_BENCH_V1 でビルド）
+//
+// 両方の出力を "bench" と条件の欄で突き合わせれば、リリース間の退行を追える。
+// 引数: --quick（試行を短く） / --filter=<name>（bench 名に含む文字列で絞る）
+//
+// 計測項目
+//   push        : PushBlock のスループット（幅 × ROI 位置 × stride × ブロック行数）
+//   commit      : ウォームアップ → Commit の切り替え時間（とその直後の最初の Push）
+//   ring_wrap   : リングの末尾を跨ぐ Push（v2 のみ。容量が 2 のべき乗か・二重マップか）
+//   window      : TryGetWindowPtr の 1 回あたり（時間セグメント数ごと。時刻つき / 無し）
+//   contention  : writer 1 + reader N の同時実行（writer の行/秒、reader の窓取得/秒）
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(LINESTORE_BENCH_V1)
+  #include "lineStore/lineStore.hpp"
+  #define BENCH_IMPL "v1"
+#else
+  #include "lineStore/lineStore2.hpp"
+  #define BENCH_IMPL "v2"
+#endif
+
+namespace {
+
+using i64   = std::int64_t;
+using Clock = std::chrono::steady_clock;
+
+bool        g_quick = false;
+std::string g_filter;
+
+bool enabled(const char* bench) {
+    return g_filter.empty() || std::string(bench).find(g_filter) != std::string::npos;
+}
+
+double seconds_since(Clock::time_point t0) {
+    return std::chrono::duration<double>(Clock::now() - t0).count();
+}
+
+// ---- JSON Lines ----
+// 欄は追加順に出す。数値は %.6g、文字列はエスケープ不要なものだけ
+class Record
+{
+public:
+    explicit Record(const char* bench) {
+        line_ = std::string("{\"impl\":\"") + BENCH_IMPL + "\",\"bench\":\"" + bench + "\"";
+    }
+    Record& Str(const char* key, const char* v) {
+        line_ += std::string(",\"") + key + "\":\"" + v + "\"";
+        return *this;
+    }
+    Record& Int(const char* key, i64 v) {
+        line_ += std::string(",\"") + key + "\":" + std::to_string(v);
+        return *this;
+    }
+    Record& Num(const char* key, double v) {
+        char buf[64];
+        std::snprintf(buf, sizeof(buf), "%.6g", v);
+        line_ += std::string(",\"") + key + "\":" + buf;
+        return *this;
+    }
+    void Emit() {
+        std::printf("%s}\n", line_.c_str());
+        std::fflush(stdout);
+    }
+
+private:
+    std::string line_;
+};
+
+// ---- 実装の違いを吸収 ----
+std::unique_ptr<LineStore> make_store(int srcW, int roiX, int roiW, i64 cap, int warmup, PixelType pt, bool ring) {
+#if defined(LINESTORE_BENCH_V1)
+    (void)ring; // 旧実装は線形のみ
+    return std::make_unique<LineStore>(srcW, roiX, roiW, cap, warmup, pt);
+#else
+    return std::make_unique<LineStore>(srcW, roiX, roiW, cap, warmup, pt, ring);
+#endif
+}
+
+constexpr bool HAS_RING =
+#if defined(LINESTORE_BENCH_V1)
+    false;
+#else
+    true;
+#endif
+
+int elem_bytes(PixelType pt) { return pt == PixelType::U8 ? 1 : 2; }
+
+// 試行のうち中央値
+double median(std::vector<double> v) {
+    std::sort(v.begin(), v.end());
+    return v[v.size() / 2];
+}
+
+// ---- push ----
+// 1 試行 = 新しいストアを Commit して、容量いっぱいまでブロック単位で Push（生成・Commit は計らない）
+void bench_push() {
+    if (!enabled("push")) return;
+
+    const i64 budgetBytes = g_quick ? (16 << 20) : (128 << 20); // 1 試行で書く量
+    const int trials      = g_quick ? 3 : 7;
+
+    for (PixelType pt : { PixelType::U8, PixelType::U16 })
+    for (int width : { 1024, 4096, 16384 })
+    for (int roiX : { 0, 3 })              // 3: 取り込み元の先頭からずれた（揃っていない）ROI
+    for (int pad : { 0, 64 })              // 行末の余り（stride > 行バイト数）
+    for (int block : { 1, 16, 256 })
+    for (bool ring : { false, true }) {
+        if (ring && !HAS_RING) continue;
+
+        const int eb     = elem_bytes(pt);
+        const int srcW   = width + roiX;
+        const int roiW   = width;
+        const int stride = srcW * eb + pad;
+        const i64 rowB   = static_cast<i64>(roiW) * eb;
+        const i64 rows   = std::max<i64>(block, budgetBytes / rowB / block * block);
+        const i64 cap    = ring ? std::max<i64>(block, rows / 4) : rows; // リングは 4 周
+
+        std::vector<std::uint8_t> src(static_cast<size_t>(stride) * block, 0x5A);
+
+        std::vector<double> nsPerRow;
+        for (int t = 0; t < trials; ++t) {
+            auto store = make_store(srcW, roiX, roiW, cap, 1, pt, ring);
+            store->Commit();
+            const auto t0 = Clock::now();
+            for (i64 r = 0; r < rows; r += block)
+                store->PushBlock(src.data(), block, stride, 1000.0 + static_cast<double>(r) * 1e-5);
+            nsPerRow.push_back(seconds_since(t0) * 1e9 / static_cast<double>(rows));
+        }
+
+        const double ns = median(nsPerRow);
+        Record("push")
+            .Str("pixel", pt == PixelType::U8 ? "u8" : "u16")
+            .Int("width", width).Int("roi_x", roiX).Int("stride", stride).Int("block_rows", block)
+            .Str("mode", ring ? "ring" : "linear")
+            .Num("ns_per_row", ns)
+            .Num("gb_per_s", static_cast<double>(rowB) / ns)
+            .Emit();
+    }
+}
+
+// ---- commit ----
+void bench_commit() {
+    if (!enabled("commit")) return;
+
+    const int trials = g_quick ? 5 : 21;
+    const int width  = 4096;
+    const PixelType pt = PixelType::U16;
+    const int stride = width * 2;
+
+    for (int warmup : { 64, 1024, 8192 })
+    for (double fill : { 0.5, 2.5 }) { // 2.5: ウォームアップを一周半以上した状態（v2 はリングの回転が要る）
+        const int pushRows = static_cast<int>(warmup * fill);
+        std::vector<std::uint8_t> src(static_cast<size_t>(stride) * 16, 0x11);
+
+        std::vector<double> commitNs, firstPushNs;
+        for (int t = 0; t < trials; ++t) {
+            auto store = make_store(width, 0, width, static_cast<i64>(warmup) * 4, warmup, pt, false);
+            for (int r = 0; r < pushRows; r += 16)
+                store->PushBlock(src.data(), std::min(16, pushRows - r), stride, 1000.0 + r * 1e-5);
+
+            auto t0 = Clock::now();
+            store->Commit();
+            commitNs.push_back(seconds_since(t0) * 1e9);
+
+            t0 = Clock::now();
+            store->PushBlock(src.data(), 16, stride, 2000.0);
+            firstPushNs.push_back(seconds_since(t0) * 1e9);
+        }
+
+        Record("commit")
+            .Int("width", width).Int("warmup_rows", warmup).Int("pushed_rows", pushRows)
+            .Num("commit_ns", median(commitNs))
+            .Num("first_push_ns", median(firstPushNs))
+            .Emit();
+    }
+}
+
+// ---- ring_wrap（v2 のみ）----
+void bench_ring_wrap() {
+#if !defined(LINESTORE_BENCH_V1)
+    if (!enabled("ring_wrap")) return;
+
+    const int width  = 4096;
+    const int stride = width * 2;
+    const int block  = 64;
+    const i64 rows   = g_quick ? (1 << 14) : (1 << 17);
+    const int trials = g_quick ? 3 : 7;
+
+    struct Case { const char* name; i64 cap; bool pow2; bool mirrored; };
+    const Case cases[] = {
+        { "odd",      1000, false, false }, // 容量が 2 のべき乗でない（% で物理行）
+        { "pow2",     1024, true,  false }, // & で物理行
+        { "mirrored", 1024, false, true  }, // 二重マップ（末尾を跨いでも 1 回でコピー）
+    };
+
+    std::vector<std::uint8_t> src(static_cast<size_t>(stride) * block, 0x33);
+    for (const auto& c : cases) {
+        std::vector<double> nsPerRow;
+        for (int t = 0; t < trials; ++t) {
+            LineStoreOptions opt;
+            opt.Circular           = true;
+            opt.PowerOfTwoCapacity = c.pow2;
+            opt.Mirrored           = c.mirrored;
+            LineStore store(width, 0, width, c.cap, 1, PixelType::U16, opt);
+            store.Commit();
+            // 容量が block の倍数でないので、何回かに 1 回は末尾を跨ぐ
+            store.PushBlock(src.data(), 7, stride, 999.0);
+            const auto t0 = Clock::now();
+            for (i64 r = 0; r < rows; r += block)
+                store.PushBlock(src.data(), block, stride, 1000.0 + static_cast<double>(r) * 1e-5);
+            nsPerRow.push_back(seconds_since(t0) * 1e9 / static_cast<double>(rows));
+        }
+        const double ns = median(nsPerRow);
+        Record("ring_wrap")
+            .Str("case", c.name).Int("width", width).Int("capacity", c.cap).Int("block_rows", block)
+            .Num("ns_per_row", ns)
+            .Num("gb_per_s", static_cast<double>(width) * 2 / ns)
+            .Emit();
+    }
+#endif
+}
+
+// ---- window ----
+// 1 行ずつ時刻を変えて Push し、セグメント数 segments の状態で任意行の窓を取る
+void bench_window() {
+    if (!enabled("window")) return;
+
+    const int width  = 2048;
+    const int stride = width * 2;
+    const int calls  = g_quick ? 200000 : 2000000;
+
+    for (i64 segments : { i64(1), i64(1000), i64(100000) }) {
+        const i64 rows = std::max<i64>(segments, 4096);
+#if defined(LINESTORE_BENCH_V1)
+        auto store = make_store(width, 0, width, rows, 1, PixelType::U16, false);
+#else
+        LineStoreOptions opt;
+        opt.TimeSegCapacity = segments;
+        auto store = std::make_unique<LineStore>(width, 0, width, rows, 1, PixelType::U16, opt);
+#endif
+        store->Commit();
+
+        // Push 1 回 = 時間セグメント 1 つ（perSeg 行ずつ）
+        const i64 perSeg = rows / segments;
+        std::vector<std::uint8_t> src(static_cast<size_t>(stride) * static_cast<size_t>(perSeg), 0x77);
+        for (i64 r = 0; r + perSeg <= rows; r += perSeg)
+            store->PushBlock(src.data(), static_cast<int>(perSeg), stride, 1000.0 + static_cast<double>(r) * 1e-4);
+
+        std::mt19937_64 rng(1234);
+        std::vector<i64> starts(4096);
+        for (auto& s : starts) s = static_cast<i64>(rng() % static_cast<std::uint64_t>(rows - 16));
+
+        for (bool withTime : { true, false }) {
+            const void* ptr = nullptr;
+            int         sb  = 0;
+            double      ts  = 0.0;
+            double      sink = 0.0;
+
+            const auto t0 = Clock::now();
+            for (int i = 0; i < calls; ++i) {
+                const i64 s = starts[static_cast<size_t>(i) & (starts.size() - 1)];
+                if (withTime) { store->TryGetWindowPtr(s, 256, 16, 0, ptr, sb, ts); sink += ts; }
+                else          { store->TryGetWindowPtr(s, 256, 16, 0, ptr, sb); sink += sb; }
+            }
+            const double ns = seconds_since(t0) * 1e9 / calls;
+
+            Record("window")
+                .Int("segments", segments).Int("rows", rows)
+                .Str("time", withTime ? "yes" : "no")
+                .Num("ns_per_call", ns)
+                .Num("sink", sink > 0 ? 1 : 0) // 最適化で消されないように
+                .Emit();
+        }
+    }
+}
+
+// ---- contention ----
+void bench_contention() {
+    if (!enabled("contention")) return;
+
+    const int    width    = 4096;
+    const int    stride   = width * 2;
+    const int    block    = 16;
+    const double duration = g_quick ? 0.3 : 2.0;
+    const int    hw       = std::max(2u, std::thread::hardware_concurrency());
+
+    std::vector<int> readerCounts{ 1 };
+    for (int n = 2; n < hw; n *= 2) readerCounts.push_back(n);
+
+    for (int readers : readerCounts) {
+        // v1 は線形のみなので、計測時間中に埋まらない容量を取る
+        const i64 cap = HAS_RING ? 8192 : static_cast<i64>(2.0e6 * duration);
+        auto store = make_store(width, 0, width, cap, 1, PixelType::U16, HAS_RING);
+        store->Commit();
+
+        std::atomic<bool> start{false}, stop{false};
+        std::vector<i64>  reads(static_cast<size_t>(readers), 0);
+        std::vector<std::thread> th;
+        for (int k = 0; k < readers; ++k) {
+            th.emplace_back([&, k] {
+                while (!start.load(std::memory_order_acquire)) std::this_thread::yield();
+                i64 n = 0;
+                std::uint32_t sink = 0;
+                while (!stop.load(std::memory_order_relaxed)) {
+                    const void* p = nullptr;
+                    int sb = 0;
+                    double ts = 0.0;
+                    if (store->TryGetLatestWindowPtr(width, block, 0, p, sb, ts)) {
+                        sink += *static_cast<const std::uint16_t*>(p); // 窓の先頭だけ触る
+                        ++n;
+                    }
+                }
+                reads[static_cast<size_t>(k)] = n + (sink == 0xFFFFFFFFu ? 1 : 0);
+            });
+        }
+
+        std::vector<std::uint8_t> src(static_cast<size_t>(stride) * block, 0x42);
+        start.store(true, std::memory_order_release);
+        const auto t0 = Clock::now();
+        i64 written = 0;
+        double el = 0.0;
+        while ((el = seconds_since(t0)) < duration && (HAS_RING || written + block <= cap)) {
+            store->PushBlock(src.data(), block, stride, 1000.0 + el);
+            written += block;
+        }
+        stop.store(true, std::memory_order_relaxed);
+        for (auto& t : th) t.join();
+
+        i64 totalReads = 0;
+        for (i64 r : reads) totalReads += r;
+
+        Record("contention")
+            .Int("width", width).Int("block_rows", block).Int("readers", readers)
+            .Str("mode", HAS_RING ? "ring" : "linear")
+            .Num("writer_rows_per_s", static_cast<double>(written) / el)
+            .Num("reader_windows_per_s", static_cast<double>(totalReads) / el)
+            .Emit();
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string a = argv[i];
+        if (a == "--quick")                    g_quick = true;
+        else if (a.rfind("--filter=", 0) == 0) g_filter = a.substr(9);
+        else {
+            std::fprintf(stderr, "usage: %s [--quick] [--filter=<bench>]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    Record meta("meta");
+    meta.Int("hw_threads", static_cast<i64>(std::thread::hardware_concurrency()));
+#if !defined(LINESTORE_BENCH_V1)
+    meta.Str("ingest_isa", IngestIsaName());
+#endif
+#if defined(GIT_HASH)
+    meta.Str("git", GIT_HASH);
+#endif
+    meta.Str("quick", g_quick ? "yes" : "no");
+    meta.Emit();
+
+    bench_push();
+    bench_commit();
+    bench_ring_wrap();
+    bench_window();
+    bench_contention();
+    return 0;
+}
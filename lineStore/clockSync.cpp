@@ -0,0 +1,141 @@
+// ClockSync.cpp
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+#include "clockSync.hpp"
+
+ClockSync::ClockSync(const ClockSyncOptions& opt)
+    : opt_(opt)
+    , cam0_(0)
+    , host0_(0)
+    , w_(0.0)
+    , mx_(0.0)
+    , my_(0.0)
+    , cxx_(0.0)
+    , cxy_(0.0)
+    , lastCam_(0)
+    , rejectRun_(0)
+{
+    if (!(opt_.ForgetFactor > 0.0 && opt_.ForgetFactor <= 1.0)) throw std::out_of_range("ForgetFactor");
+    if (opt_.MinSamples < 2) throw std::out_of_range("MinSamples");
+    if (opt_.MaxResidualNs < 0 || opt_.MaxRoundTripNs < 0) throw std::out_of_range("MaxResidualNs / MaxRoundTripNs");
+}
+
+ClockSync::i64 ClockSync::HostNowNs() noexcept {
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+// ---- 標本 ----
+bool ClockSync::AddSample(i64 cameraNs, i64 hostBeforeNs, i64 hostAfterNs) {
+    if (hostAfterNs < hostBeforeNs) throw std::invalid_argument("hostAfterNs < hostBeforeNs");
+    if (opt_.MaxRoundTripNs > 0 && hostAfterNs - hostBeforeNs > opt_.MaxRoundTripNs) {
+        rejected_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    return AddSample(cameraNs, hostBeforeNs + (hostAfterNs - hostBeforeNs) / 2);
+}
+
+bool ClockSync::AddSample(i64 cameraNs, i64 hostNs) {
+    const i64 n = samples_.load(std::memory_order_relaxed);
+    if (n == 0 || cameraNs < lastCam_) { // 最初の標本 / カメラのカウンタが戻った
+        if (n != 0) restarts_.fetch_add(1, std::memory_order_relaxed);
+        Restart(cameraNs, hostNs);
+        return true;
+    }
+
+    // 当てはめ済みの直線から外れすぎた標本は捨てる（続くなら時刻が飛んだとみなしてやり直す）
+    if (opt_.MaxResidualNs > 0 && n >= opt_.MinSamples) {
+        const i64 resid = hostNs - ToHostNs(cameraNs);
+        if (resid > opt_.MaxResidualNs || resid < -opt_.MaxResidualNs) {
+            rejected_.fetch_add(1, std::memory_order_relaxed);
+            if (++rejectRun_ < opt_.MinSamples) return false;
+            restarts_.fetch_add(1, std::memory_order_relaxed);
+            Restart(cameraNs, hostNs);
+            return true;
+        }
+    }
+    rejectRun_ = 0;
+    lastCam_   = cameraNs;
+
+    // 忘却係数つきの重みつき平均・積和（平均まわりで更新するので桁落ちしない）
+    const double x  = static_cast<double>(cameraNs - cam0_);
+    const double y  = static_cast<double>(hostNs - host0_);
+    const double lf = opt_.ForgetFactor;
+    w_   = lf * w_ + 1.0;
+    const double dx = x - mx_;
+    const double dy = y - my_;
+    mx_ += dx / w_;
+    my_ += dy / w_;
+    cxx_ = lf * cxx_ + dx * (x - mx_);
+    cxy_ = lf * cxy_ + dx * (y - my_);
+    samples_.store(n + 1, std::memory_order_relaxed);
+
+    // 傾きは標本がそろって、カメラ時刻に広がりがあるときだけ。それまでは 1
+    const double slope = (n + 1 >= opt_.MinSamples && cxx_ > 0.0) ? cxy_ / cxx_ : 1.0;
+
+    // 重心（の整数に丸めたカメラ時刻）を基準点にして公開する
+    Model m;
+    m.CameraRef = cam0_ + static_cast<i64>(std::llround(mx_));
+    m.HostRef   = host0_ + static_cast<i64>(std::llround(my_ + slope * (static_cast<double>(m.CameraRef - cam0_) - mx_)));
+    m.Slope     = slope;
+    Publish(m);
+    return true;
+}
+
+void ClockSync::Restart(i64 cameraNs, i64 hostNs) {
+    cam0_  = cameraNs;
+    host0_ = hostNs;
+    w_   = 1.0;
+    mx_  = my_  = 0.0;
+    cxx_ = cxy_ = 0.0;
+    lastCam_   = cameraNs;
+    rejectRun_ = 0;
+    samples_.store(1, std::memory_order_relaxed);
+    Publish(Model{ cameraNs, hostNs, 1.0 });
+}
+
+void ClockSync::Reset() noexcept {
+    samples_.store(0, std::memory_order_relaxed);
+    rejectRun_ = 0;
+    Publish(Model{ 0, 0, 1.0 });
+}
+
+// ---- 公開（seqlock）----
+void ClockSync::Publish(const Model& m) noexcept {
+    const std::uint32_t s = seq_.load(std::memory_order_relaxed);
+    seq_.store(s + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    camRef_.store(m.CameraRef, std::memory_order_relaxed);
+    hostRef_.store(m.HostRef, std::memory_order_relaxed);
+    slope_.store(m.Slope, std::memory_order_relaxed);
+    seq_.store(s + 2, std::memory_order_release);
+}
+
+ClockSync::Model ClockSync::Load() const noexcept {
+    for (;;) {
+        const std::uint32_t s0 = seq_.load(std::memory_order_acquire);
+        if (s0 & 1u) continue;
+        Model m{ camRef_.load(std::memory_order_relaxed),
+                 hostRef_.load(std::memory_order_relaxed),
+                 slope_.load(std::memory_order_relaxed) };
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (seq_.load(std::memory_order_relaxed) == s0) return m;
+    }
+}
+
+// ---- 変換 ----
+bool ClockSync::Ready() const noexcept { return samples_.load(std::memory_order_acquire) > 0; }
+
+ClockSync::i64 ClockSync::ToHostNs(i64 cameraNs) const noexcept {
+    if (!Ready()) return cameraNs;
+    const Model m = Load();
+    // 差をとってから double にする（1 日ぶんの ns でも double の仮数に収まる）
+    return m.HostRef + static_cast<i64>(std::llround(static_cast<double>(cameraNs - m.CameraRef) * m.Slope));
+}
+
+double ClockSync::Slope() const noexcept { return Load().Slope; }
+
+ClockSync::i64 ClockSync::Samples()  const noexcept { return samples_.load(std::memory_order_relaxed); }
+ClockSync::i64 ClockSync::Rejected() const noexcept { return rejected_.load(std::memory_order_relaxed); }
+ClockSync::i64 ClockSync::Restarts() const noexcept { return restarts_.load(std::memory_order_relaxed); }
@@ -0,0 +1,89 @@
+#pragma once
+// ClockSync.hpp
+// カメラのハードウェア時刻（ns）→ ホストの steady_clock（ns）の対応づけ
+//
+// 対になった時刻（カメラのタイムスタンプをラッチした時のカメラ時刻とホスト時刻）から、
+// ドリフトする直線 host = HostRef + (camera - CameraRef) * Slope を逐次当てはめる（忘却係数つき最小二乗）。
+// 標本は 1 スレッド（AddSample）から入れ、変換（ToHostNs）は任意スレッドからロック無しで呼べる。
+// 直線は標本ごとにわずかに変わるので、変換結果を続けて使う側（LineStore::PushBlockNs）は単調になるよう詰める
+
+#include <atomic>
+#include <cstdint>
+
+struct ClockSyncOptions
+{
+    // 忘却係数（0 < ForgetFactor <= 1）。1 標本ごとに古い標本の重みをこの倍率で減らす。
+    // 実効的な窓は 1 / (1 - ForgetFactor) 標本（既定 0.99 なら約 100 標本）
+    double ForgetFactor = 0.99;
+
+    int MinSamples = 4; // これ未満の間は傾き 1（オフセットだけ）で変換する
+
+    // 当てはめ済みの直線から MaxResidualNs より離れた標本は捨てる（0 なら捨てない）。
+    // 続けて MinSamples 回捨てたら、カメラ側の時刻が飛んだとみなして当てはめをやり直す
+    std::int64_t MaxResidualNs = 0;
+
+    // AddSample(camera, hostBefore, hostAfter) で、ホスト側の往復がこれより長い標本は捨てる（0 なら捨てない）
+    std::int64_t MaxRoundTripNs = 0;
+};
+
+class ClockSync
+{
+public:
+    using i64 = std::int64_t;
+
+    explicit ClockSync(const ClockSyncOptions& opt = {});
+
+    ClockSync(const ClockSync&) = delete;
+    ClockSync& operator=(const ClockSync&) = delete;
+
+    // ---- 標本（1 スレッドから）----
+    // 採用すれば true。カメラ時刻が戻った（カウンタのリセット）ら当てはめをやり直す
+    bool AddSample(i64 cameraNs, i64 hostNs);
+    // カメラ時刻のラッチをホスト時刻 hostBeforeNs / hostAfterNs で挟んだ標本（中点を使う）
+    bool AddSample(i64 cameraNs, i64 hostBeforeNs, i64 hostAfterNs);
+    void Reset() noexcept;
+
+    // ---- 変換（任意スレッド）----
+    bool   Ready()    const noexcept; // 1 標本以上入っている
+    i64    ToHostNs(i64 cameraNs) const noexcept; // 標本が無ければ cameraNs をそのまま返す
+    double Slope()    const noexcept; // ホスト ns / カメラ ns
+    double DriftPpm() const noexcept { return (Slope() - 1.0) * 1e6; }
+
+    i64 Samples()  const noexcept; // 採用した標本数（Reset / やり直しで 0 に戻る）
+    i64 Rejected() const noexcept; // 捨てた標本数（通算）
+    i64 Restarts() const noexcept; // カメラ時刻の飛びでやり直した回数（通算）
+
+    static i64 HostNowNs() noexcept; // steady_clock の ns
+
+private:
+    struct Model
+    {
+        i64    CameraRef;
+        i64    HostRef;
+        double Slope;
+    };
+
+    void  Publish(const Model& m) noexcept; // seqlock で公開
+    Model Load() const noexcept;
+    void  Restart(i64 cameraNs, i64 hostNs);
+
+    ClockSyncOptions opt_;
+
+    // 当てはめ（AddSample のスレッド専用）。x, y は最初の標本からの差（大きな値の桁落ちを避ける）
+    i64    cam0_, host0_;
+    double w_;             // 重みの合計
+    double mx_, my_;       // 重みつき平均
+    double cxx_, cxy_;     // 平均まわりの重みつき積和
+    i64    lastCam_;
+    int    rejectRun_;     // 続けて捨てた数
+
+    // 公開中の直線（seqlock：seq_ が奇数の間は書き換え中）
+    std::atomic<std::uint32_t> seq_{0};
+    std::atomic<i64>           camRef_{0};
+    std::atomic<i64>           hostRef_{0};
+    std::atomic<double>        slope_{1.0};
+
+    std::atomic<i64> samples_{0};
+    std::atomic<i64> rejected_{0};
+    std::atomic<i64> restarts_{0};
+};
@@ -0,0 +1,95 @@
+// ColdCodec.cpp
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include "coldCodec.hpp"
+
+namespace {
+
+constexpr int BLOCK    = 32;
+constexpr int MAX_BITS = 17; // u16 の差分（-65535..65535）のジグザグ
+
+inline std::uint32_t zigzag(std::int32_t v) noexcept   { return (static_cast<std::uint32_t>(v) << 1) ^ static_cast<std::uint32_t>(v >> 31); }
+inline std::int32_t  unzigzag(std::uint32_t u) noexcept { return static_cast<std::int32_t>(u >> 1) ^ -static_cast<std::int32_t>(u & 1u); }
+
+template <class T>
+std::size_t encode_row(const T* p, int width, std::uint8_t* out) noexcept {
+    std::uint8_t* o = out;
+    const std::uint16_t first = p[0];
+    std::memcpy(o, &first, 2);
+    o += 2;
+
+    std::uint32_t z[BLOCK];
+    for (int x0 = 1; x0 < width; x0 += BLOCK) {
+        const int n = std::min(BLOCK, width - x0);
+
+        std::uint32_t any = 0;
+        for (int i = 0; i < n; ++i) {
+            const int x = x0 + i;
+            z[i] = zigzag(static_cast<std::int32_t>(p[x]) - static_cast<std::int32_t>(p[x - 1]));
+            any |= z[i];
+        }
+        const int bits = any ? 32 - std::countl_zero(any) : 0;
+        *o++ = static_cast<std::uint8_t>(bits);
+        if (bits == 0) continue;
+
+        // LSB から詰める（64 bit に貯めて 8 bit ずつ出す）
+        std::uint64_t acc = 0;
+        int           have = 0;
+        for (int i = 0; i < n; ++i) {
+            acc  |= static_cast<std::uint64_t>(z[i]) << have;
+            have += bits;
+            while (have >= 8) { *o++ = static_cast<std::uint8_t>(acc); acc >>= 8; have -= 8; }
+        }
+        if (have > 0) *o++ = static_cast<std::uint8_t>(acc);
+    }
+    return static_cast<std::size_t>(o - out);
+}
+
+template <class T>
+std::size_t decode_row(const std::uint8_t* in, int width, T* p) noexcept {
+    const std::uint8_t* s = in;
+    std::uint16_t first;
+    std::memcpy(&first, s, 2);
+    s += 2;
+    p[0] = static_cast<T>(first);
+
+    std::int32_t prev = first;
+    for (int x0 = 1; x0 < width; x0 += BLOCK) {
+        const int n    = std::min(BLOCK, width - x0);
+        const int bits = *s++;
+        if (bits == 0) {
+            for (int i = 0; i < n; ++i) p[x0 + i] = static_cast<T>(prev);
+            continue;
+        }
+
+        const std::uint64_t mask = (std::uint64_t{1} << bits) - 1;
+        std::uint64_t acc  = 0;
+        int           have = 0;
+        for (int i = 0; i < n; ++i) {
+            while (have < bits) { acc |= static_cast<std::uint64_t>(*s++) << have; have += 8; }
+            prev += unzigzag(static_cast<std::uint32_t>(acc & mask));
+            acc  >>= bits;
+            have -= bits;
+            p[x0 + i] = static_cast<T>(prev);
+        }
+    }
+    return static_cast<std::size_t>(s - in);
+}
+
+} // namespace
+
+std::size_t ColdMaxRowBytes(int width) noexcept {
+    const int blocks = (std::max(0, width - 1) + BLOCK - 1) / BLOCK;
+    return 2 + static_cast<std::size_t>(blocks) * (1 + (BLOCK * MAX_BITS + 7) / 8);
+}
+
+std::size_t ColdEncodeRow(const void* row, int width, int elemBytes, std::uint8_t* out) noexcept {
+    return (elemBytes == 1) ? encode_row(static_cast<const std::uint8_t*>(row), width, out)
+                            : encode_row(static_cast<const std::uint16_t*>(row), width, out);
+}
+
+std::size_t ColdDecodeRow(const std::uint8_t* in, int width, int elemBytes, void* row) noexcept {
+    return (elemBytes == 1) ? decode_row(in, width, static_cast<std::uint8_t*>(row))
+                            : decode_row(in, width, static_cast<std::uint16_t*>(row));
+}
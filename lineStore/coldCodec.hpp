@@ -0,0 +1,19 @@
+#pragma once
+// ColdCodec.hpp
+// コールド層（lineStoreCold.cpp）の行圧縮：横方向の差分 + ジグザグ + 32 画素ごとのビット詰め
+//
+// 1 行 = [先頭画素 u16][ブロック…]。ブロックは [ビット幅 b (1 バイト)][32 個 × b ビット（LSB から詰める）]、
+// 最後のブロックだけ画素数が 32 未満。行ごとに独立して復元できる（縦方向の予測は使わない）。
+// なめらかなライン画像なら差分が小さく、16 bit 画素で 3〜5 倍程度に縮む
+
+#include <cstddef>
+#include <cstdint>
+
+// width 画素の行を圧縮したときの最大バイト数（出力バッファの大きさ）
+std::size_t ColdMaxRowBytes(int width) noexcept;
+
+// row（elemBytes = 1 / 2）の width 画素を out に圧縮し、書いたバイト数を返す
+std::size_t ColdEncodeRow(const void* row, int width, int elemBytes, std::uint8_t* out) noexcept;
+
+// ColdEncodeRow の出力から 1 行を復元する。読んだバイト数を返す
+std::size_t ColdDecodeRow(const std::uint8_t* in, int width, int elemBytes, void* row) noexcept;
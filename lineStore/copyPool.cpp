@@ -0,0 +1,132 @@
+// CopyPool.cpp
+#include "copyPool.hpp"
+
+#include <stdexcept>
+#include <string>
+
+#include "waitWord.hpp"
+
+#if defined(_WIN32)
+  #ifndef NOMINMAX
+    #define NOMINMAX
+  #endif
+  #include <windows.h>
+#elif defined(__linux__)
+  #include <pthread.h>
+  #include <sched.h>
+#endif
+
+#if defined(_M_X64) || defined(__x86_64__)
+  #include <immintrin.h>
+  #define LS_PAUSE() _mm_pause()
+#else
+  #define LS_PAUSE() std::this_thread::yield()
+#endif
+
+namespace {
+
+constexpr int SPIN_BEFORE_WAIT = 4000; // 分担はほぼ同時に終わるので、眠る前に少しだけ回る
+
+void pin_thread(std::thread& th, int cpu) {
+#if defined(_WIN32)
+    if (cpu < 0 || cpu >= 64 ||
+        SetThreadAffinityMask(static_cast<HANDLE>(th.native_handle()), DWORD_PTR(1) << cpu) == 0)
+        throw std::runtime_error("cannot pin copy worker to cpu " + std::to_string(cpu));
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (cpu < 0 || cpu >= CPU_SETSIZE) throw std::out_of_range("CopyThreadCpus");
+    CPU_SET(cpu, &set);
+    if (pthread_setaffinity_np(th.native_handle(), sizeof(set), &set) != 0)
+        throw std::runtime_error("cannot pin copy worker to cpu " + std::to_string(cpu));
+#else
+    (void)th; (void)cpu; // 固定できない環境では OS 任せ
+#endif
+}
+
+} // namespace
+
+CopyPool::CopyPool(int threads, const std::vector<int>& cpus) {
+    if (threads <= 0) throw std::out_of_range("threads");
+
+    workers_.reserve(static_cast<size_t>(threads));
+    try {
+        for (int i = 0; i < threads; ++i) {
+            workers_.emplace_back([this] { WorkerLoop(); });
+            if (!cpus.empty()) pin_thread(workers_.back(), cpus[static_cast<size_t>(i) % cpus.size()]);
+        }
+    } catch (...) {
+        Stop(); // 起動済みのワーカーを止める
+        throw;
+    }
+}
+
+CopyPool::~CopyPool() {
+    Stop();
+}
+
+void CopyPool::Stop() noexcept {
+    stop_.store(true, std::memory_order_release);
+    wake_.fetch_add(1, std::memory_order_release);
+    WakeWordAll(wake_);
+    for (auto& th : workers_)
+        if (th.joinable()) th.join();
+    workers_.clear();
+}
+
+// ---- 呼び出しスレッド ----
+void CopyPool::Run(int parts, PartFn fn, void* ctx) noexcept {
+    if (parts <= 0) return;
+    if (parts == 1) { fn(ctx, 0); return; }
+
+    fn_.store(fn, std::memory_order_relaxed);
+    ctx_.store(ctx, std::memory_order_relaxed);
+    remaining_.store(parts, std::memory_order_relaxed);
+    ++gen_;
+    ticket_.store((std::uint64_t(gen_) << 32) | (std::uint64_t(parts) << 16), std::memory_order_release);
+
+    wake_.fetch_add(1, std::memory_order_release);
+    WakeWordAll(wake_);
+
+    Work(); // 自分も分担を取る
+
+    for (int spin = 0; remaining_.load(std::memory_order_acquire) > 0; ++spin) {
+        if (spin < SPIN_BEFORE_WAIT) { LS_PAUSE(); continue; }
+        const std::uint32_t seen = done_.load(std::memory_order_acquire);
+        if (remaining_.load(std::memory_order_acquire) == 0) break;
+        WaitWord(done_, seen, std::chrono::nanoseconds::max()); // 最後の分担が done_ を進めて起こす
+    }
+}
+
+// ---- 分担の取得と実行（ワーカー / 呼び出しスレッド共通）----
+void CopyPool::Work() noexcept {
+    std::uint64_t t = ticket_.load(std::memory_order_acquire);
+    const std::uint64_t gen = t >> 32;
+
+    for (;;) {
+        // 同じ世代で未着手の分担があれば 1 つ取る
+        do {
+            if ((t >> 32) != gen || (t & 0xFFFF) >= ((t >> 16) & 0xFFFF)) return;
+        } while (!ticket_.compare_exchange_weak(t, t + 1, std::memory_order_acq_rel, std::memory_order_acquire));
+
+        // 分担を持っている間はこの世代が終わらないので、fn_ / ctx_ は書き換わらない
+        fn_.load(std::memory_order_relaxed)(ctx_.load(std::memory_order_relaxed), static_cast<int>(t & 0xFFFF));
+
+        if (remaining_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            done_.fetch_add(1, std::memory_order_release);
+            WakeWordAll(done_);
+        }
+        t = ticket_.load(std::memory_order_acquire);
+    }
+}
+
+void CopyPool::WorkerLoop() {
+    std::uint32_t seen = 0;
+    for (;;) {
+        while (wake_.load(std::memory_order_acquire) == seen)
+            WaitWord(wake_, seen, std::chrono::nanoseconds::max());
+        seen = wake_.load(std::memory_order_acquire);
+        if (stop_.load(std::memory_order_acquire)) return;
+        Work();
+    }
+}
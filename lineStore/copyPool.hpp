@@ -0,0 +1,52 @@
+#pragma once
+// CopyPool.hpp
+// 大きなブロックの取り込みを分担する小さなワーカープール（PushBlockParallel 用）
+//
+// Run は 1 スレッド（writer）からだけ呼ぶ。呼び出しスレッドも 1 つ分の作業を受け持ち、
+// 全部の分担が終わるまで戻らない。待機/起床は WaitWord（futex / WaitOnAddress）
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+class CopyPool
+{
+public:
+    using PartFn = void (*)(void* ctx, int part);
+
+    // threads: ワーカー数（>= 1）。cpus が空でなければワーカー i を CPU cpus[i % cpus.size()] に固定する
+    CopyPool(int threads, const std::vector<int>& cpus);
+    ~CopyPool();
+
+    CopyPool(const CopyPool&) = delete;
+    CopyPool& operator=(const CopyPool&) = delete;
+
+    // 同時に進む分担の数（ワーカー + 呼び出しスレッド）
+    int Parallelism() const noexcept { return static_cast<int>(workers_.size()) + 1; }
+
+    // fn(ctx, part) を part = 0..parts-1 について 1 回ずつ呼び、全部終わってから戻る（parts <= MAX_PARTS）。
+    // fn の書き込みは戻った時点で呼び出しスレッドから見える
+    void Run(int parts, PartFn fn, void* ctx) noexcept;
+
+    static constexpr int MAX_PARTS = 0xFFFF;
+
+private:
+    void WorkerLoop();
+    void Work() noexcept;
+    void Stop() noexcept;
+
+    std::vector<std::thread> workers_;
+
+    // 受付：上位 32bit = 世代, 中 16bit = 分担数, 下 16bit = 次に取る分担。
+    // 1 語にまとめるので、前の世代の残りを取りに来たワーカーが新しい世代の分担を取ることはない
+    std::atomic<std::uint64_t> ticket_{0};
+    std::atomic<PartFn>        fn_{nullptr};
+    std::atomic<void*>         ctx_{nullptr};
+    std::atomic<int>           remaining_{0}; // 終わっていない分担数
+    std::uint32_t              gen_ = 0;      // Run の呼び出しスレッド専用
+
+    std::atomic<std::uint32_t> wake_{0};      // ワーカーが眠る語（Run と停止で進める）
+    std::atomic<std::uint32_t> done_{0};      // 呼び出しスレッドが眠る語（最後の分担が進める）
+    std::atomic<bool>          stop_{false};
+};
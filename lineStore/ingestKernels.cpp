@@ -0,0 +1,661 @@
+// IngestKernels.cpp
+#include "ingestKernels.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+  #define LS_X86 1
+  #include <immintrin.h>
+  #if defined(_MSC_VER) && !defined(__clang__)
+    #include <intrin.h>
+    #define LS_TARGET(isa)
+  #else
+    #define LS_TARGET(isa) __attribute__((target(isa)))
+  #endif
+#else
+  #define LS_X86 0
+#endif
+
+namespace {
+
+using u8  = std::uint8_t;
+using u16 = std::uint16_t;
+
+// ---- 形式ごとの定数 ----
+// PPG: 1 グループの画素数, BPG: 1 グループのバイト数
+template<SourceFormat F> struct Fmt;
+template<> struct Fmt<SourceFormat::Mono8>   { static constexpr int PPG = 1; static constexpr int BPG = 1; };
+template<> struct Fmt<SourceFormat::Mono16>  { static constexpr int PPG = 1; static constexpr int BPG = 2; };
+template<> struct Fmt<SourceFormat::Mono10p> { static constexpr int PPG = 4; static constexpr int BPG = 5; };
+template<> struct Fmt<SourceFormat::Mono12p> { static constexpr int PPG = 2; static constexpr int BPG = 3; };
+
+template<SourceFormat F>
+inline const u8* group_ptr(const u8* row, int x) noexcept {
+    return row + static_cast<std::int64_t>(x / Fmt<F>::PPG) * Fmt<F>::BPG;
+}
+
+// ---- スカラー ----
+template<SourceFormat F>
+inline unsigned load_px(const u8* row, int x) noexcept {
+    if constexpr (F == SourceFormat::Mono8) {
+        return row[x];
+    } else if constexpr (F == SourceFormat::Mono16) {
+        u16 v; std::memcpy(&v, row + static_cast<std::int64_t>(x) * 2, 2);
+        return v;
+    } else if constexpr (F == SourceFormat::Mono10p) {
+        const u8* g = group_ptr<F>(row, x);
+        const int k = x & 3;                      // 画素 k は bit 10k から
+        const unsigned w = g[k] | (unsigned(g[k + 1]) << 8);
+        return (w >> (2 * k)) & 0x3FFu;
+    } else {
+        const u8* g = group_ptr<F>(row, x);
+        return (x & 1) ? ((g[1] >> 4) | (unsigned(g[2]) << 4))
+                       : (g[0] | ((unsigned(g[1]) & 0x0Fu) << 8));
+    }
+}
+
+template<SourceFormat F, class DstT>
+inline void convert_span_scalar(const u8* row, int x0, int n, DstT* dst, int shift) noexcept {
+    for (int i = 0; i < n; ++i) {
+        const unsigned v = load_px<F>(row, x0 + i) >> shift;
+        if constexpr (sizeof(DstT) == 1) dst[i] = static_cast<DstT>(v > 255u ? 255u : v);
+        else                             dst[i] = static_cast<DstT>(v);
+    }
+}
+
+// グループ境界まで（および SIMD が読み過ぎない末尾）はスカラーで処理する
+template<SourceFormat F>
+inline int head_pixels(int x0, int n) noexcept {
+    const int phase = x0 % Fmt<F>::PPG;
+    return std::min(n, phase ? Fmt<F>::PPG - phase : 0);
+}
+
+template<SourceFormat F, class DstT>
+void convert_scalar(const u8* row, int x0, int n, void* dst, int shift) {
+    convert_span_scalar<F>(row, x0, n, static_cast<DstT*>(dst), shift);
+}
+
+#if LS_X86
+
+// ---- SSE4.1（pshufb でアンパック、mullo で画素ごとのシフトを揃える）----
+// 8 画素を 16bit レーンへ。SAFE: 読み込みが ROI 内に収まるのに必要な残り画素数
+template<SourceFormat F> struct Sse;
+
+template<> struct Sse<SourceFormat::Mono8> {
+    static constexpr int SAFE = 8, BYTES = 8;
+    LS_TARGET("sse4.1") static __m128i load(const u8* p) {
+        return _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)));
+    }
+};
+template<> struct Sse<SourceFormat::Mono16> {
+    static constexpr int SAFE = 8, BYTES = 16;
+    LS_TARGET("sse4.1") static __m128i load(const u8* p) {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    }
+};
+template<> struct Sse<SourceFormat::Mono10p> {
+    static constexpr int SAFE = 13, BYTES = 10;  // 16 byte 読む = 12.8 画素
+    LS_TARGET("sse4.1") static __m128i load(const u8* p) {
+        const __m128i shuf = _mm_setr_epi8(0, 1, 1, 2, 2, 3, 3, 4, 5, 6, 6, 7, 7, 8, 8, 9);
+        const __m128i mul  = _mm_setr_epi16(64, 16, 4, 1, 64, 16, 4, 1);
+        const __m128i v    = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), shuf);
+        return _mm_srli_epi16(_mm_mullo_epi16(v, mul), 6); // (w << (6-s)) >> 6 = bit s..s+9
+    }
+};
+template<> struct Sse<SourceFormat::Mono12p> {
+    static constexpr int SAFE = 11, BYTES = 12;  // 16 byte 読む = 10.7 画素
+    LS_TARGET("sse4.1") static __m128i load(const u8* p) {
+        const __m128i shuf = _mm_setr_epi8(0, 1, 1, 2, 3, 4, 4, 5, 6, 7, 7, 8, 9, 10, 10, 11);
+        const __m128i mul  = _mm_setr_epi16(16, 1, 16, 1, 16, 1, 16, 1);
+        const __m128i v    = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), shuf);
+        return _mm_srli_epi16(_mm_mullo_epi16(v, mul), 4);
+    }
+};
+
+template<SourceFormat F, class DstT>
+LS_TARGET("sse4.1") void convert_sse41(const u8* row, int x0, int n, void* dstv, int shift) {
+    auto* dst = static_cast<DstT*>(dstv);
+    int i = head_pixels<F>(x0, n);
+    convert_span_scalar<F>(row, x0, i, dst, shift);
+
+    const u8*     s   = group_ptr<F>(row, x0 + i);
+    const __m128i cnt = _mm_cvtsi32_si128(shift);
+    const __m128i lim = _mm_set1_epi16(255);
+
+    for (; i + Sse<F>::SAFE <= n; i += 8, s += Sse<F>::BYTES) {
+        const __m128i v = _mm_srl_epi16(Sse<F>::load(s), cnt);
+        if constexpr (sizeof(DstT) == 1) {
+            const __m128i p = _mm_packus_epi16(_mm_min_epu16(v, lim), _mm_setzero_si128());
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + i), p);
+        } else {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), v);
+        }
+    }
+    convert_span_scalar<F>(row, x0 + i, n - i, dst + i, shift);
+}
+
+// ---- AVX2（16 画素。128bit 2 本を上下レーンに載せて同じシャッフル）----
+template<SourceFormat F> struct Avx;
+
+template<> struct Avx<SourceFormat::Mono8> {
+    static constexpr int SAFE = 16, BYTES = 16;
+    LS_TARGET("avx2") static __m256i load(const u8* p) {
+        return _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+    }
+};
+template<> struct Avx<SourceFormat::Mono16> {
+    static constexpr int SAFE = 16, BYTES = 32;
+    LS_TARGET("avx2") static __m256i load(const u8* p) {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    }
+};
+template<> struct Avx<SourceFormat::Mono10p> {
+    static constexpr int SAFE = 21, BYTES = 20;  // 最後の読み込みは +10 から 16 byte
+    LS_TARGET("avx2") static __m256i load(const u8* p) {
+        const __m256i shuf = _mm256_setr_epi8(0, 1, 1, 2, 2, 3, 3, 4, 5, 6, 6, 7, 7, 8, 8, 9,
+                                              0, 1, 1, 2, 2, 3, 3, 4, 5, 6, 6, 7, 7, 8, 8, 9);
+        const __m256i mul  = _mm256_setr_epi16(64, 16, 4, 1, 64, 16, 4, 1, 64, 16, 4, 1, 64, 16, 4, 1);
+        const __m128i lo   = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        const __m128i hi   = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 10));
+        const __m256i v    = _mm256_shuffle_epi8(_mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1), shuf);
+        return _mm256_srli_epi16(_mm256_mullo_epi16(v, mul), 6);
+    }
+};
+template<> struct Avx<SourceFormat::Mono12p> {
+    static constexpr int SAFE = 19, BYTES = 24;  // 最後の読み込みは +12 から 16 byte
+    LS_TARGET("avx2") static __m256i load(const u8* p) {
+        const __m256i shuf = _mm256_setr_epi8(0, 1, 1, 2, 3, 4, 4, 5, 6, 7, 7, 8, 9, 10, 10, 11,
+                                              0, 1, 1, 2, 3, 4, 4, 5, 6, 7, 7, 8, 9, 10, 10, 11);
+        const __m256i mul  = _mm256_setr_epi16(16, 1, 16, 1, 16, 1, 16, 1, 16, 1, 16, 1, 16, 1, 16, 1);
+        const __m128i lo   = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        const __m128i hi   = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 12));
+        const __m256i v    = _mm256_shuffle_epi8(_mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1), shuf);
+        return _mm256_srli_epi16(_mm256_mullo_epi16(v, mul), 4);
+    }
+};
+
+template<SourceFormat F, class DstT>
+LS_TARGET("avx2") void convert_avx2(const u8* row, int x0, int n, void* dstv, int shift) {
+    auto* dst = static_cast<DstT*>(dstv);
+    int i = head_pixels<F>(x0, n);
+    convert_span_scalar<F>(row, x0, i, dst, shift);
+
+    const u8*     s   = group_ptr<F>(row, x0 + i);
+    const __m128i cnt = _mm_cvtsi32_si128(shift);
+    const __m256i lim = _mm256_set1_epi16(255);
+
+    for (; i + Avx<F>::SAFE <= n; i += 16, s += Avx<F>::BYTES) {
+        const __m256i v = _mm256_srl_epi16(Avx<F>::load(s), cnt);
+        if constexpr (sizeof(DstT) == 1) {
+            // packus はレーン内なので 64bit 単位で並べ直す
+            const __m256i p = _mm256_packus_epi16(_mm256_min_epu16(v, lim), _mm256_setzero_si256());
+            const __m256i q = _mm256_permute4x64_epi64(p, 0xD8);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm256_castsi256_si128(q));
+        } else {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), v);
+        }
+    }
+    convert_span_scalar<F>(row, x0 + i, n - i, dst + i, shift);
+}
+
+// ---- CPU 判定 ----
+enum class Isa { Scalar, Sse41, Avx2 };
+
+Isa detect_isa() noexcept {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int r[4];
+    __cpuid(r, 0);
+    const int maxLeaf = r[0];
+    __cpuid(r, 1);
+    const bool sse41   = (r[2] & (1 << 19)) != 0;
+    const bool osxsave = (r[2] & (1 << 27)) != 0;
+    const bool avx     = (r[2] & (1 << 28)) != 0;
+    bool avx2 = false;
+    if (maxLeaf >= 7 && osxsave && avx && (_xgetbv(0) & 0x6) == 0x6) {
+        __cpuidex(r, 7, 0);
+        avx2 = (r[1] & (1 << 5)) != 0;
+    }
+    if (avx2)  return Isa::Avx2;
+    if (sse41) return Isa::Sse41;
+    return Isa::Scalar;
+#else
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))   return Isa::Avx2;
+    if (__builtin_cpu_supports("sse4.1")) return Isa::Sse41;
+    return Isa::Scalar;
+#endif
+}
+
+#else
+
+enum class Isa { Scalar };
+Isa detect_isa() noexcept { return Isa::Scalar; }
+
+#endif // LS_X86
+
+Isa selected_isa() noexcept {
+    static const Isa isa = detect_isa();
+    return isa;
+}
+
+template<SourceFormat F, class DstT>
+RowConvertFn pick() {
+#if LS_X86
+    switch (selected_isa()) {
+    case Isa::Avx2:  return &convert_avx2<F, DstT>;
+    case Isa::Sse41: return &convert_sse41<F, DstT>;
+    default:         break;
+    }
+#endif
+    return &convert_scalar<F, DstT>;
+}
+
+template<SourceFormat F>
+RowConvertFn pick_dst(PixelType dst) {
+    return dst == PixelType::U8 ? pick<F, u8>() : pick<F, u16>();
+}
+
+
+// ---- ビニング：横 2 画素の和を u32 の累積へ / 累積を保存形式へ ----
+using u32 = std::uint32_t;
+
+template<class SrcT>
+void pair_sum_scalar(const void* srcv, int count, u32* acc) {
+    const auto* s = static_cast<const SrcT*>(srcv);
+    for (int i = 0; i < count; ++i)
+        acc[i] += static_cast<u32>(s[2 * i]) + s[2 * i + 1];
+}
+
+template<class DstT>
+void bin_store_scalar(const u32* acc, int count, int shift, void* dstv) {
+    constexpr u32 MAX  = (sizeof(DstT) == 1) ? 0xFFu : 0xFFFFu;
+    const u32     bias = (1u << shift) >> 1;
+    auto*         d    = static_cast<DstT*>(dstv);
+    for (int i = 0; i < count; ++i) {
+        const u32 v = (acc[i] + bias) >> shift;
+        d[i] = static_cast<DstT>(v > MAX ? MAX : v);
+    }
+}
+
+#if LS_X86
+
+LS_TARGET("sse4.1") void pair_sum_u8_sse41(const void* srcv, int count, u32* acc) {
+    const auto*   s    = static_cast<const u8*>(srcv);
+    const __m128i ones = _mm_set1_epi8(1);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128i p = _mm_maddubs_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 2 * i)), ones);
+        auto* a = reinterpret_cast<__m128i*>(acc + i);
+        _mm_storeu_si128(a,     _mm_add_epi32(_mm_loadu_si128(a),     _mm_cvtepu16_epi32(p)));
+        _mm_storeu_si128(a + 1, _mm_add_epi32(_mm_loadu_si128(a + 1), _mm_cvtepu16_epi32(_mm_srli_si128(p, 8))));
+    }
+    pair_sum_scalar<u8>(s + 2 * i, count - i, acc + i);
+}
+
+LS_TARGET("sse4.1") void pair_sum_u16_sse41(const void* srcv, int count, u32* acc) {
+    const auto*   s    = static_cast<const u16*>(srcv);
+    const __m128i lo16 = _mm_set1_epi32(0xFFFF);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 2 * i)); // 32bit 単位で見れば (偶数, 奇数) の組
+        auto* a = reinterpret_cast<__m128i*>(acc + i);
+        _mm_storeu_si128(a, _mm_add_epi32(_mm_loadu_si128(a),
+                                          _mm_add_epi32(_mm_and_si128(v, lo16), _mm_srli_epi32(v, 16))));
+    }
+    pair_sum_scalar<u16>(s + 2 * i, count - i, acc + i);
+}
+
+LS_TARGET("sse4.1") void pair_sum_u32_sse41(const void* srcv, int count, u32* acc) {
+    const auto* s = static_cast<const u32*>(srcv);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 2 * i));
+        const __m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 2 * i + 4));
+        auto* a = reinterpret_cast<__m128i*>(acc + i);
+        _mm_storeu_si128(a, _mm_add_epi32(_mm_loadu_si128(a), _mm_hadd_epi32(v0, v1)));
+    }
+    pair_sum_scalar<u32>(s + 2 * i, count - i, acc + i);
+}
+
+template<class DstT>
+LS_TARGET("sse4.1") void bin_store_sse41(const u32* acc, int count, int shift, void* dstv) {
+    auto*         d    = static_cast<DstT*>(dstv);
+    const __m128i bias = _mm_set1_epi32(static_cast<int>((1u << shift) >> 1));
+    const __m128i sh   = _mm_cvtsi32_si128(shift);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        // 和は 64 * 65535 以下なので符号付きの飽和パックで足りる
+        const __m128i a = _mm_srl_epi32(_mm_add_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(acc + i)),     bias), sh);
+        const __m128i b = _mm_srl_epi32(_mm_add_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(acc + i + 4)), bias), sh);
+        if constexpr (sizeof(DstT) == 1) {
+            const __m128i p = _mm_packs_epi32(a, b); // u8 へは i16 を経由（65535 が -1 にならないように符号付きで）
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(d + i), _mm_packus_epi16(p, p));
+        } else {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(d + i), _mm_packus_epi32(a, b));
+        }
+    }
+    bin_store_scalar<DstT>(acc + i, count - i, shift, d + i);
+}
+
+LS_TARGET("avx2") void pair_sum_u8_avx2(const void* srcv, int count, u32* acc) {
+    const auto*   s    = static_cast<const u8*>(srcv);
+    const __m256i ones = _mm256_set1_epi8(1);
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        // レーン 0 が組 0..7、レーン 1 が組 8..15
+        const __m256i p = _mm256_maddubs_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + 2 * i)), ones);
+        auto* a = reinterpret_cast<__m256i*>(acc + i);
+        _mm256_storeu_si256(a,     _mm256_add_epi32(_mm256_loadu_si256(a),     _mm256_cvtepu16_epi32(_mm256_castsi256_si128(p))));
+        _mm256_storeu_si256(a + 1, _mm256_add_epi32(_mm256_loadu_si256(a + 1), _mm256_cvtepu16_epi32(_mm256_extracti128_si256(p, 1))));
+    }
+    pair_sum_scalar<u8>(s + 2 * i, count - i, acc + i);
+}
+
+LS_TARGET("avx2") void pair_sum_u16_avx2(const void* srcv, int count, u32* acc) {
+    const auto*   s    = static_cast<const u16*>(srcv);
+    const __m256i lo16 = _mm256_set1_epi32(0xFFFF);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + 2 * i));
+        auto* a = reinterpret_cast<__m256i*>(acc + i);
+        _mm256_storeu_si256(a, _mm256_add_epi32(_mm256_loadu_si256(a),
+                                                _mm256_add_epi32(_mm256_and_si256(v, lo16), _mm256_srli_epi32(v, 16))));
+    }
+    pair_sum_scalar<u16>(s + 2 * i, count - i, acc + i);
+}
+
+LS_TARGET("avx2") void pair_sum_u32_avx2(const void* srcv, int count, u32* acc) {
+    const auto* s = static_cast<const u32*>(srcv);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256i v0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + 2 * i));
+        const __m256i v1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + 2 * i + 8));
+        // hadd はレーンごとなので (v0 前半, v1 前半, v0 後半, v1 後半) を並べ直す
+        const __m256i h = _mm256_permute4x64_epi64(_mm256_hadd_epi32(v0, v1), _MM_SHUFFLE(3, 1, 2, 0));
+        auto* a = reinterpret_cast<__m256i*>(acc + i);
+        _mm256_storeu_si256(a, _mm256_add_epi32(_mm256_loadu_si256(a), h));
+    }
+    pair_sum_scalar<u32>(s + 2 * i, count - i, acc + i);
+}
+
+template<class DstT>
+LS_TARGET("avx2") void bin_store_avx2(const u32* acc, int count, int shift, void* dstv) {
+    auto*         d    = static_cast<DstT*>(dstv);
+    const __m256i bias = _mm256_set1_epi32(static_cast<int>((1u << shift) >> 1));
+    const __m128i sh   = _mm_cvtsi32_si128(shift);
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m256i a = _mm256_srl_epi32(_mm256_add_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc + i)),     bias), sh);
+        const __m256i b = _mm256_srl_epi32(_mm256_add_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc + i + 8)), bias), sh);
+        if constexpr (sizeof(DstT) == 1) {
+            const __m256i p = _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), _MM_SHUFFLE(3, 1, 2, 0));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(d + i),
+                             _mm_packus_epi16(_mm256_castsi256_si128(p), _mm256_extracti128_si256(p, 1)));
+        } else {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(d + i),
+                                _mm256_permute4x64_epi64(_mm256_packus_epi32(a, b), _MM_SHUFFLE(3, 1, 2, 0)));
+        }
+    }
+    bin_store_scalar<DstT>(acc + i, count - i, shift, d + i);
+}
+
+#endif // LS_X86
+
+// ---- 列ごとの統計 / フラットフィールド ----
+using u64 = std::uint64_t;
+
+template<class T>
+void column_sum_scalar(const void* rowv, int count, u64* sum, u64* sumSq) {
+    const auto* p = static_cast<const T*>(rowv);
+    for (int i = 0; i < count; ++i) {
+        const u64 v = p[i];
+        sum[i]   += v;
+        sumSq[i] += v * v;
+    }
+}
+
+template<class T>
+void column_ema_scalar(const void* rowv, int count, float alpha, float* mean, float* var) {
+    const auto* p    = static_cast<const T*>(rowv);
+    const float keep = 1.0f - alpha;
+    for (int i = 0; i < count; ++i) {
+        const float d = static_cast<float>(p[i]) - mean[i];
+        const float t = alpha * d;
+        mean[i] = mean[i] + t;
+        var[i]  = keep * (var[i] + t * d);
+    }
+}
+
+template<class T>
+void flat_field_scalar(void* rowv, int count, const float* dark, const float* gain) {
+    constexpr float MAX = (sizeof(T) == 1) ? 255.0f : 65535.0f;
+    auto* p = static_cast<T*>(rowv);
+    for (int i = 0; i < count; ++i) {
+        float r = (static_cast<float>(p[i]) - dark[i]) * gain[i];
+        r = (r > 0.0f) ? r : 0.0f; // NaN も 0（SIMD の max と同じ）
+        r = (r < MAX)  ? r : MAX;
+        p[i] = static_cast<T>(std::lrintf(r)); // 最近接偶数丸め（cvtps_epi32 と同じ）
+    }
+}
+
+#if LS_X86
+
+// 画素を 32bit 整数へ（SSE4.1: 4 画素 / AVX2: 8 画素）
+template<class T>
+LS_TARGET("sse4.1") inline __m128i load4_epi32(const T* p) {
+    if constexpr (sizeof(T) == 1) {
+        std::uint32_t w; std::memcpy(&w, p, 4);
+        return _mm_cvtepu8_epi32(_mm_cvtsi32_si128(static_cast<int>(w)));
+    } else {
+        return _mm_cvtepu16_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)));
+    }
+}
+
+template<class T>
+LS_TARGET("avx2") inline __m256i load8_epi32(const T* p) {
+    if constexpr (sizeof(T) == 1) return _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)));
+    else                          return _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+}
+
+template<class T>
+LS_TARGET("sse4.1") void column_sum_sse41(const void* rowv, int count, u64* sum, u64* sumSq) {
+    const auto* p = static_cast<const T*>(rowv);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128i v  = load4_epi32(p + i);
+        const __m128i sq = _mm_mullo_epi32(v, v); // 65535^2 < 2^32
+        auto* s = reinterpret_cast<__m128i*>(sum + i);
+        auto* q = reinterpret_cast<__m128i*>(sumSq + i);
+        _mm_storeu_si128(s,     _mm_add_epi64(_mm_loadu_si128(s),     _mm_cvtepu32_epi64(v)));
+        _mm_storeu_si128(s + 1, _mm_add_epi64(_mm_loadu_si128(s + 1), _mm_cvtepu32_epi64(_mm_srli_si128(v, 8))));
+        _mm_storeu_si128(q,     _mm_add_epi64(_mm_loadu_si128(q),     _mm_cvtepu32_epi64(sq)));
+        _mm_storeu_si128(q + 1, _mm_add_epi64(_mm_loadu_si128(q + 1), _mm_cvtepu32_epi64(_mm_srli_si128(sq, 8))));
+    }
+    column_sum_scalar<T>(p + i, count - i, sum + i, sumSq + i);
+}
+
+template<class T>
+LS_TARGET("sse4.1") void column_ema_sse41(const void* rowv, int count, float alpha, float* mean, float* var) {
+    const auto*  p    = static_cast<const T*>(rowv);
+    const __m128 a    = _mm_set1_ps(alpha);
+    const __m128 keep = _mm_set1_ps(1.0f - alpha);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128 m = _mm_loadu_ps(mean + i);
+        const __m128 d = _mm_sub_ps(_mm_cvtepi32_ps(load4_epi32(p + i)), m);
+        const __m128 t = _mm_mul_ps(a, d);
+        _mm_storeu_ps(mean + i, _mm_add_ps(m, t));
+        _mm_storeu_ps(var + i,  _mm_mul_ps(keep, _mm_add_ps(_mm_loadu_ps(var + i), _mm_mul_ps(t, d))));
+    }
+    column_ema_scalar<T>(p + i, count - i, alpha, mean + i, var + i);
+}
+
+// 4 画素を補正して 32bit 整数で（0..max に飽和済み）
+template<class T>
+LS_TARGET("sse4.1") inline __m128i flat4_epi32(const T* p, const float* dark, const float* gain, __m128 max) {
+    const __m128 r = _mm_mul_ps(_mm_sub_ps(_mm_cvtepi32_ps(load4_epi32(p)), _mm_loadu_ps(dark)), _mm_loadu_ps(gain));
+    return _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(r, _mm_setzero_ps()), max));
+}
+
+template<class T>
+LS_TARGET("sse4.1") void flat_field_sse41(void* rowv, int count, const float* dark, const float* gain) {
+    auto*        p   = static_cast<T*>(rowv);
+    const __m128 max = _mm_set1_ps((sizeof(T) == 1) ? 255.0f : 65535.0f);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128i w = _mm_packus_epi32(flat4_epi32(p + i,     dark + i,     gain + i,     max),
+                                           flat4_epi32(p + i + 4, dark + i + 4, gain + i + 4, max));
+        if constexpr (sizeof(T) == 1) _mm_storel_epi64(reinterpret_cast<__m128i*>(p + i), _mm_packus_epi16(w, w));
+        else                          _mm_storeu_si128(reinterpret_cast<__m128i*>(p + i), w);
+    }
+    flat_field_scalar<T>(p + i, count - i, dark + i, gain + i);
+}
+
+template<class T>
+LS_TARGET("avx2") void column_sum_avx2(const void* rowv, int count, u64* sum, u64* sumSq) {
+    const auto* p = static_cast<const T*>(rowv);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256i v  = load8_epi32(p + i);
+        const __m256i sq = _mm256_mullo_epi32(v, v);
+        auto* s = reinterpret_cast<__m256i*>(sum + i);
+        auto* q = reinterpret_cast<__m256i*>(sumSq + i);
+        _mm256_storeu_si256(s,     _mm256_add_epi64(_mm256_loadu_si256(s),     _mm256_cvtepu32_epi64(_mm256_castsi256_si128(v))));
+        _mm256_storeu_si256(s + 1, _mm256_add_epi64(_mm256_loadu_si256(s + 1), _mm256_cvtepu32_epi64(_mm256_extracti128_si256(v, 1))));
+        _mm256_storeu_si256(q,     _mm256_add_epi64(_mm256_loadu_si256(q),     _mm256_cvtepu32_epi64(_mm256_castsi256_si128(sq))));
+        _mm256_storeu_si256(q + 1, _mm256_add_epi64(_mm256_loadu_si256(q + 1), _mm256_cvtepu32_epi64(_mm256_extracti128_si256(sq, 1))));
+    }
+    column_sum_scalar<T>(p + i, count - i, sum + i, sumSq + i);
+}
+
+template<class T>
+LS_TARGET("avx2") void column_ema_avx2(const void* rowv, int count, float alpha, float* mean, float* var) {
+    const auto*  p    = static_cast<const T*>(rowv);
+    const __m256 a    = _mm256_set1_ps(alpha);
+    const __m256 keep = _mm256_set1_ps(1.0f - alpha);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256 m = _mm256_loadu_ps(mean + i);
+        const __m256 d = _mm256_sub_ps(_mm256_cvtepi32_ps(load8_epi32(p + i)), m);
+        const __m256 t = _mm256_mul_ps(a, d);
+        _mm256_storeu_ps(mean + i, _mm256_add_ps(m, t));
+        _mm256_storeu_ps(var + i,  _mm256_mul_ps(keep, _mm256_add_ps(_mm256_loadu_ps(var + i), _mm256_mul_ps(t, d))));
+    }
+    column_ema_scalar<T>(p + i, count - i, alpha, mean + i, var + i);
+}
+
+template<class T>
+LS_TARGET("avx2") inline __m256i flat8_epi32(const T* p, const float* dark, const float* gain, __m256 max) {
+    const __m256 r = _mm256_mul_ps(_mm256_sub_ps(_mm256_cvtepi32_ps(load8_epi32(p)), _mm256_loadu_ps(dark)),
+                                   _mm256_loadu_ps(gain));
+    return _mm256_cvtps_epi32(_mm256_min_ps(_mm256_max_ps(r, _mm256_setzero_ps()), max));
+}
+
+template<class T>
+LS_TARGET("avx2") void flat_field_avx2(void* rowv, int count, const float* dark, const float* gain) {
+    auto*        p   = static_cast<T*>(rowv);
+    const __m256 max = _mm256_set1_ps((sizeof(T) == 1) ? 255.0f : 65535.0f);
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        // packus はレーンごとなので並べ直す（bin_store_avx2 と同じ）
+        const __m256i w = _mm256_permute4x64_epi64(
+            _mm256_packus_epi32(flat8_epi32(p + i, dark + i, gain + i, max), flat8_epi32(p + i + 8, dark + i + 8, gain + i + 8, max)),
+            _MM_SHUFFLE(3, 1, 2, 0));
+        if constexpr (sizeof(T) == 1) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(p + i),
+                             _mm_packus_epi16(_mm256_castsi256_si128(w), _mm256_extracti128_si256(w, 1)));
+        } else {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(p + i), w);
+        }
+    }
+    flat_field_scalar<T>(p + i, count - i, dark + i, gain + i);
+}
+
+#endif // LS_X86
+
+} // namespace
+
+RowConvertFn SelectRowConverter(SourceFormat src, PixelType dst) {
+    switch (src) {
+    case SourceFormat::Mono8:   return pick_dst<SourceFormat::Mono8>(dst);
+    case SourceFormat::Mono16:  return pick_dst<SourceFormat::Mono16>(dst);
+    case SourceFormat::Mono10p: return pick_dst<SourceFormat::Mono10p>(dst);
+    case SourceFormat::Mono12p: return pick_dst<SourceFormat::Mono12p>(dst);
+    default:                    return nullptr;
+    }
+}
+
+const char* IngestIsaName() noexcept {
+#if LS_X86
+    switch (selected_isa()) {
+    case Isa::Avx2:  return "avx2";
+    case Isa::Sse41: return "sse4.1";
+    default:         break;
+    }
+#endif
+    return "scalar";
+}
+
+BinPairSumFn SelectBinPairSum(int elemBytes) {
+#if LS_X86
+    switch (selected_isa()) {
+    case Isa::Avx2:
+        return elemBytes == 1 ? &pair_sum_u8_avx2 : elemBytes == 2 ? &pair_sum_u16_avx2 : &pair_sum_u32_avx2;
+    case Isa::Sse41:
+        return elemBytes == 1 ? &pair_sum_u8_sse41 : elemBytes == 2 ? &pair_sum_u16_sse41 : &pair_sum_u32_sse41;
+    default:
+        break;
+    }
+#endif
+    return elemBytes == 1 ? &pair_sum_scalar<u8> : elemBytes == 2 ? &pair_sum_scalar<u16> : &pair_sum_scalar<u32>;
+}
+
+BinStoreFn SelectBinStore(PixelType dst) {
+    const bool b8 = (dst == PixelType::U8);
+#if LS_X86
+    switch (selected_isa()) {
+    case Isa::Avx2:  return b8 ? &bin_store_avx2<u8>  : &bin_store_avx2<u16>;
+    case Isa::Sse41: return b8 ? &bin_store_sse41<u8> : &bin_store_sse41<u16>;
+    default:         break;
+    }
+#endif
+    return b8 ? &bin_store_scalar<u8> : &bin_store_scalar<u16>;
+}
+
+ColumnSumFn SelectColumnSum(PixelType px) {
+    const bool b8 = (px == PixelType::U8);
+#if LS_X86
+    switch (selected_isa()) {
+    case Isa::Avx2:  return b8 ? &column_sum_avx2<u8>  : &column_sum_avx2<u16>;
+    case Isa::Sse41: return b8 ? &column_sum_sse41<u8> : &column_sum_sse41<u16>;
+    default:         break;
+    }
+#endif
+    return b8 ? &column_sum_scalar<u8> : &column_sum_scalar<u16>;
+}
+
+ColumnEmaFn SelectColumnEma(PixelType px) {
+    const bool b8 = (px == PixelType::U8);
+#if LS_X86
+    switch (selected_isa()) {
+    case Isa::Avx2:  return b8 ? &column_ema_avx2<u8>  : &column_ema_avx2<u16>;
+    case Isa::Sse41: return b8 ? &column_ema_sse41<u8> : &column_ema_sse41<u16>;
+    default:         break;
+    }
+#endif
+    return b8 ? &column_ema_scalar<u8> : &column_ema_scalar<u16>;
+}
+
+FlatFieldFn SelectFlatField(PixelType px) {
+    const bool b8 = (px == PixelType::U8);
+#if LS_X86
+    switch (selected_isa()) {
+    case Isa::Avx2:  return b8 ? &flat_field_avx2<u8>  : &flat_field_avx2<u16>;
+    case Isa::Sse41: return b8 ? &flat_field_sse41<u8> : &flat_field_sse41<u16>;
+    default:         break;
+    }
+#endif
+    return b8 ? &flat_field_scalar<u8> : &flat_field_scalar<u16>;
+}
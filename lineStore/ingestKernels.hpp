@@ -0,0 +1,45 @@
+#pragma once
+// IngestKernels.hpp
+// 取り込み時の 1 行変換（ROI 切り出し + アンパック + シフト/縮退）
+// AVX2 / SSE4.1 / スカラーを実行時に選択する
+
+#include <cstdint>
+
+#include "pixelFormat.hpp"
+
+// srcRow: 取り込み元 1 行の先頭（ROI 前）
+// x0    : ROI 先頭画素（取り込み元座標）
+// count : 変換する画素数
+// dst   : 保存形式の出力先（count 画素ぶん）
+// shift : 取り込み元の値に掛ける右シフト（U8 出力は 255 で飽和）
+using RowConvertFn = void (*)(const std::uint8_t* srcRow, int x0, int count, void* dst, int shift);
+
+// 形式の組み合わせに対する変換関数（CPU に合わせた実装）
+RowConvertFn SelectRowConverter(SourceFormat src, PixelType dst);
+
+// 選択された命令セット名（"avx2" / "sse4.1" / "scalar"）
+const char* IngestIsaName() noexcept;
+
+// ---- ビニング（縮小レベルの作成）----
+// acc[i] += src[2i] + src[2i+1]（i < count）。src の要素は u8 / u16 / u32（elemBytes = 1 / 2 / 4）
+using BinPairSumFn = void (*)(const void* src, int count, std::uint32_t* acc);
+
+// dst[i] = (acc[i] + 丸め) >> shift を保存形式で（範囲外は飽和）。shift = 0 なら和のまま
+using BinStoreFn = void (*)(const std::uint32_t* acc, int count, int shift, void* dst);
+
+BinPairSumFn SelectBinPairSum(int elemBytes);
+BinStoreFn   SelectBinStore(PixelType dst);
+
+// ---- 列ごとの統計 / フラットフィールド（lineStoreColumns.cpp）----
+// 1 行の各画素を列ごとの累積へ：sum[i] += v, sumSq[i] += v * v（u64 で正確）
+using ColumnSumFn = void (*)(const void* row, int count, std::uint64_t* sum, std::uint64_t* sumSq);
+
+// 指数移動平均：d = v - mean[i]; mean[i] += alpha * d; var[i] = (1 - alpha) * (var[i] + alpha * d * d)
+using ColumnEmaFn = void (*)(const void* row, int count, float alpha, float* mean, float* var);
+
+// その場で補正：row[i] = (row[i] - dark[i]) * gain[i] を最近接丸めし、保存形式の範囲に飽和
+using FlatFieldFn = void (*)(void* row, int count, const float* dark, const float* gain);
+
+ColumnSumFn SelectColumnSum(PixelType px);
+ColumnEmaFn SelectColumnEma(PixelType px);
+FlatFieldFn SelectFlatField(PixelType px);
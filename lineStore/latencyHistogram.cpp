@@ -0,0 +1,51 @@
+// LatencyHistogram.cpp
+#include <algorithm>
+#include <cmath>
+#include "latencyHistogram.hpp"
+
+// ---- ビンの範囲 ----
+std::uint64_t LatencySnapshot::BucketLowNs(int i) noexcept {
+    if (i < SUB_BUCKETS) return static_cast<std::uint64_t>(i);
+    const int msb = i / SUB_BUCKETS + SUB_BITS - 1;
+    const int sub = i % SUB_BUCKETS;
+    return static_cast<std::uint64_t>(SUB_BUCKETS + sub) << (msb - SUB_BITS);
+}
+
+std::uint64_t LatencySnapshot::BucketHighNs(int i) noexcept {
+    if (i < SUB_BUCKETS) return static_cast<std::uint64_t>(i);
+    if (i == BUCKETS - 1) return UINT64_MAX;
+    const int msb = i / SUB_BUCKETS + SUB_BITS - 1;
+    return BucketLowNs(i) + (std::uint64_t{1} << (msb - SUB_BITS)) - 1;
+}
+
+// ---- 分位点 ----
+std::uint64_t LatencySnapshot::PercentileNs(double q) const noexcept {
+    if (Count == 0) return 0;
+    q = std::clamp(q, 0.0, 1.0);
+    const std::uint64_t rank = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(std::ceil(q * static_cast<double>(Count))));
+
+    std::uint64_t seen = 0;
+    for (int i = 0; i < BUCKETS; ++i) {
+        seen += Counts[static_cast<std::size_t>(i)];
+        if (seen >= rank) return std::min(BucketHighNs(i), MaxNs);
+    }
+    return MaxNs;
+}
+
+// ---- 写し ----
+LatencySnapshot LatencyHistogram::Snapshot() const noexcept {
+    LatencySnapshot s;
+    // count_ を先に acquire で読み、その時点までの記録は必ず含める（以降の記録が混じるのは許す）
+    (void)count_.load(std::memory_order_acquire);
+    s.MinNs = min_.load(std::memory_order_relaxed);
+    s.MaxNs = max_.load(std::memory_order_relaxed);
+    s.SumNs = sum_.load(std::memory_order_relaxed);
+
+    std::uint64_t total = 0;
+    for (std::size_t i = 0; i < counts_.size(); ++i) {
+        s.Counts[i] = counts_[i].load(std::memory_order_relaxed);
+        total += s.Counts[i];
+    }
+    s.Count = total;
+    return s;
+}
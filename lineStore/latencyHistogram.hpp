@@ -0,0 +1,77 @@
+#pragma once
+// LatencyHistogram.hpp
+// 所要時間（ns）の対数-線形ヒストグラム（HDR 形式：2 のべき乗ごとに SUB_BUCKETS 等分）
+//
+// 記録（Record）は 1 スレッド（writer）だけ。読み出し（Snapshot）は任意スレッドからロック無しで読む。
+// 各桁は relaxed の atomic なので、Snapshot は記録中の 1 件ぶん桁ごとにずれることがある（合計は Count から数え直す）
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+
+// ある時点の写し（値で持ち回る。ロック無しで取れる）
+struct LatencySnapshot
+{
+    static constexpr int SUB_BITS    = 4;              // 2 のべき乗ごとの分割数 = 16（相対誤差 1/16 以下）
+    static constexpr int SUB_BUCKETS = 1 << SUB_BITS;
+    static constexpr int MAX_BITS    = 40;             // これ以上（約 18 分）は最後のビンに入れる
+    static constexpr int BUCKETS     = (MAX_BITS - SUB_BITS + 1) * SUB_BUCKETS;
+
+    std::array<std::uint64_t, BUCKETS> Counts{};
+    std::uint64_t Count = 0;  // 件数（Counts の合計）
+    std::uint64_t MinNs = 0;  // 件数 0 なら 0
+    std::uint64_t MaxNs = 0;
+    std::uint64_t SumNs = 0;
+
+    double MeanNs() const noexcept { return Count ? static_cast<double>(SumNs) / static_cast<double>(Count) : 0.0; }
+
+    // q（0..1）分位点の上限（そのビンの上端。MaxNs を超えない）。件数 0 なら 0
+    std::uint64_t PercentileNs(double q) const noexcept;
+
+    // ビン i の範囲 [BucketLowNs(i), BucketHighNs(i)]
+    static std::uint64_t BucketLowNs(int i) noexcept;
+    static std::uint64_t BucketHighNs(int i) noexcept;
+
+    // ns が入るビン
+    static int BucketOf(std::uint64_t ns) noexcept {
+        if (ns < SUB_BUCKETS) return static_cast<int>(ns);
+        const int msb = 63 - std::countl_zero(ns);
+        if (msb >= MAX_BITS) return BUCKETS - 1;
+        const int sub = static_cast<int>(ns >> (msb - SUB_BITS)) & (SUB_BUCKETS - 1);
+        return (msb - SUB_BITS + 1) * SUB_BUCKETS + sub;
+    }
+};
+
+class LatencyHistogram
+{
+public:
+    LatencyHistogram() = default;
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    // ---- writer ----
+    // 書くのは 1 スレッドだけなので read-modify-write でなく load + store（lock 命令を使わない）
+    void Record(std::uint64_t ns) noexcept {
+        bump(counts_[static_cast<std::size_t>(LatencySnapshot::BucketOf(ns))], 1);
+        bump(sum_, ns);
+        const std::uint64_t n = count_.load(std::memory_order_relaxed);
+        if (n == 0 || ns < min_.load(std::memory_order_relaxed)) min_.store(ns, std::memory_order_relaxed);
+        if (ns > max_.load(std::memory_order_relaxed))           max_.store(ns, std::memory_order_relaxed);
+        count_.store(n + 1, std::memory_order_release);
+    }
+
+    // ---- reader ----
+    LatencySnapshot Snapshot() const noexcept;
+
+private:
+    static void bump(std::atomic<std::uint64_t>& a, std::uint64_t v) noexcept {
+        a.store(a.load(std::memory_order_relaxed) + v, std::memory_order_relaxed);
+    }
+
+    std::array<std::atomic<std::uint64_t>, LatencySnapshot::BUCKETS> counts_{};
+    std::atomic<std::uint64_t> count_{0};
+    std::atomic<std::uint64_t> min_{0};
+    std::atomic<std::uint64_t> max_{0};
+    std::atomic<std::uint64_t> sum_{0};
+};
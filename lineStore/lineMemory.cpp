@@ -0,0 +1,585 @@
+// LineMemory.cpp
+#include "lineMemory.hpp"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <algorithm>
+#include <utility>
+
+#if defined(_WIN32)
+  #ifndef NOMINMAX
+    #define NOMINMAX
+  #endif
+  #include <windows.h>
+  #include <memoryapi.h>
+  #include <malloc.h>
+  #include <filesystem>
+#else
+  #include <sys/mman.h>
+  #include <fcntl.h>
+  #include <unistd.h>
+  #if defined(__linux__)
+    #include <sys/syscall.h>
+  #endif
+#endif
+
+namespace {
+
+constexpr std::size_t HUGE_PAGE_BYTES = std::size_t(2) << 20; // x64 の 2MiB ページ
+
+std::size_t round_up(std::size_t v, std::size_t a) {
+    return (v + a - 1) / a * a;
+}
+
+std::size_t page_bytes() {
+#if defined(_WIN32)
+    SYSTEM_INFO si{};
+    GetSystemInfo(&si);
+    return static_cast<std::size_t>(si.dwPageSize);
+#else
+    return static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+} // namespace
+
+// ---- 生成/破棄 ----
+LineMemory::LineMemory(std::size_t bytes, const LineMemoryOptions& opt) {
+    if (bytes == 0) throw std::invalid_argument("bytes");
+    if (opt.Mirrored && opt.Huge != HugePages::None) throw std::invalid_argument("Mirrored with HugePages");
+    if (!opt.FilePath.empty() && (opt.Mirrored || opt.Huge != HugePages::None))
+        throw std::invalid_argument("FilePath with Mirrored/HugePages");
+
+    // NUMA_CURRENT は書き込むスレッドで決める（生成したスレッドが writer と同じノードとは限らない）。
+    // Windows は確保時にしか指定できないのでここで決める
+    int node = opt.NumaNode;
+    if (node == LineMemoryOptions::NUMA_CURRENT) {
+#if defined(_WIN32)
+        node = CurrentNumaNode();
+#else
+        numaPending_.store(opt.FilePath.empty(), std::memory_order_relaxed); // ファイルバックは NUMA 指定を無視
+#endif
+    }
+
+    try {
+        if (!opt.FilePath.empty()) {
+            MapFile(bytes, opt);
+            if (opt.FileReadOnly) return; // 書き込まないのでプリフォールト/ロック不要
+        } else if (opt.Mirrored) {
+            AllocateMirrored(bytes);
+            if (node >= 0) BindNuma(node, false); // ページに触る前に配置ポリシーを決める
+        } else if (opt.Huge == HugePages::None && opt.NumaNode == LineMemoryOptions::NUMA_ANY && !opt.Lock && !opt.Prefault) {
+            AllocateHeap(bytes, opt.Alignment);
+        } else {
+            AllocateMapped(bytes, opt, node);
+        }
+
+        // mlock は全ページを確定させるのでプリフォールトを兼ねる（NUMA_CURRENT なら BindToCurrentNode で移す）
+        if (opt.Lock) LockPages();
+        else if (opt.Prefault) {
+            if (numaPending_.load(std::memory_order_relaxed)) {
+                prefault_        = std::make_shared<PrefaultState>(); // 始めるまで PrefaultDone は false
+                prefaultPending_ = true;
+                prefaultAsync_   = opt.PrefaultAsync;
+            } else {
+                StartPrefault(opt.PrefaultAsync);
+            }
+        }
+    } catch (...) {
+        Release();
+        throw;
+    }
+}
+
+LineMemory::~LineMemory() {
+    Release();
+}
+
+LineMemory::LineMemory(LineMemory&& other) noexcept {
+    *this = std::move(other);
+}
+
+LineMemory& LineMemory::operator=(LineMemory&& other) noexcept {
+    if (this != &other) {
+        Release();
+        kind_           = std::exchange(other.kind_, Kind::None);
+        data_           = std::exchange(other.data_, nullptr);
+        bytes_          = std::exchange(other.bytes_, 0);
+        mapBase_        = std::exchange(other.mapBase_, nullptr);
+        mapBytes_       = std::exchange(other.mapBytes_, 0);
+        section_        = std::exchange(other.section_, nullptr);
+        file_           = std::exchange(other.file_, nullptr);
+        fd_             = std::exchange(other.fd_, -1);
+        huge_           = std::exchange(other.huge_, false);
+        locked_         = std::exchange(other.locked_, false);
+        numaNode_.store(other.numaNode_.exchange(-1), std::memory_order_relaxed);
+        numaError_.store(other.numaError_.exchange(0), std::memory_order_relaxed);
+        numaPending_.store(other.numaPending_.exchange(false), std::memory_order_relaxed);
+        prefaultPending_ = std::exchange(other.prefaultPending_, false);
+        prefaultAsync_   = other.prefaultAsync_;
+        prefaultThread_ = std::move(other.prefaultThread_); // スレッドは data_ を直接持つので移動しても有効
+        prefault_       = std::move(other.prefault_);
+    }
+    return *this;
+}
+
+void LineMemory::AllocateHeap(std::size_t bytes, std::size_t alignment) {
+    const std::size_t align = std::max<std::size_t>(alignment, alignof(std::max_align_t));
+    if ((align & (align - 1)) != 0) throw std::invalid_argument("Alignment");
+#if defined(_WIN32)
+    data_ = static_cast<std::uint8_t*>(_aligned_malloc(bytes, align));
+#else
+    data_ = static_cast<std::uint8_t*>(std::aligned_alloc(align, round_up(bytes, align)));
+#endif
+    if (!data_) throw std::bad_alloc();
+    bytes_ = bytes;
+    kind_  = Kind::Malloc;
+}
+
+void LineMemory::Release() noexcept {
+    if (prefaultThread_.joinable()) {
+        prefault_->Cancel.store(true, std::memory_order_relaxed);
+        prefaultThread_.join();
+    }
+    prefault_.reset();
+
+    switch (kind_) {
+    case Kind::Malloc:
+#if defined(_WIN32)
+        _aligned_free(data_);
+#else
+        std::free(data_);
+#endif
+        break;
+    case Kind::Map:
+#if defined(_WIN32)
+        VirtualFree(mapBase_, 0, MEM_RELEASE);
+#else
+        munmap(mapBase_, mapBytes_);
+#endif
+        break;
+    case Kind::Mirror:
+#if defined(_WIN32)
+        // placeholder を保持せずに unmap すると予約ごと解放される
+        UnmapViewOfFileEx(data_, 0);
+        UnmapViewOfFileEx(data_ + bytes_, 0);
+        CloseHandle(static_cast<HANDLE>(section_));
+#else
+        munmap(data_, bytes_ * 2);
+#endif
+        break;
+    case Kind::File:
+#if defined(_WIN32)
+        UnmapViewOfFile(mapBase_);
+        CloseHandle(static_cast<HANDLE>(section_));
+        CloseHandle(static_cast<HANDLE>(file_));
+#else
+        munmap(mapBase_, mapBytes_);
+        close(fd_);
+#endif
+        break;
+    default:
+        break;
+    }
+
+    kind_     = Kind::None;
+    data_     = nullptr;
+    bytes_    = 0;
+    mapBase_  = nullptr;
+    mapBytes_ = 0;
+    section_  = nullptr;
+    file_     = nullptr;
+    fd_       = -1;
+    huge_     = false;
+    locked_   = false;
+    numaNode_.store(-1, std::memory_order_relaxed);
+    numaPending_.store(false, std::memory_order_relaxed);
+    prefaultPending_ = false;
+}
+
+// ---- ヒュージページ / NUMA ----
+#if defined(_WIN32)
+
+void LineMemory::AllocateMapped(std::size_t bytes, const LineMemoryOptions& opt, int node) {
+    const DWORD nodeArg = (node >= 0) ? static_cast<DWORD>(node) : NUMA_NO_PREFERRED_NODE;
+    void* p = nullptr;
+
+    // Windows に THP 相当は無いので Transparent も large page を試す（要 SeLockMemoryPrivilege）
+    const SIZE_T large = GetLargePageMinimum();
+    if (opt.Huge != HugePages::None && large != 0) {
+        mapBytes_ = round_up(bytes, large);
+        p = VirtualAllocExNuma(GetCurrentProcess(), nullptr, mapBytes_,
+                               MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE, nodeArg);
+        huge_ = (p != nullptr);
+    }
+    if (!p) {
+        mapBytes_ = bytes;
+        p = VirtualAllocExNuma(GetCurrentProcess(), nullptr, mapBytes_,
+                               MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE, nodeArg);
+    }
+    if (!p) throw std::bad_alloc();
+    if (node >= 0) numaNode_.store(node, std::memory_order_release);
+
+    kind_    = Kind::Map;
+    mapBase_ = p;
+    data_    = static_cast<std::uint8_t*>(p);
+    bytes_   = bytes;
+}
+
+void LineMemory::BindNuma(int /*node*/, bool /*moveTouched*/) {
+    // Windows は VirtualAllocExNuma で確保時に指定する（二重マップは未対応）
+}
+
+void LineMemory::LockPages() {
+    if (huge_) { locked_ = true; return; } // large page は常に常駐
+
+    SIZE_T mn = 0, mx = 0;
+    GetProcessWorkingSetSize(GetCurrentProcess(), &mn, &mx);
+    SetProcessWorkingSetSize(GetCurrentProcess(), mn + bytes_, mx + bytes_);
+    if (!VirtualLock(data_, bytes_))
+        throw std::runtime_error("VirtualLock failed: " + std::to_string(GetLastError()));
+    locked_ = true;
+}
+
+int LineMemory::CurrentNumaNode() noexcept {
+    PROCESSOR_NUMBER pn{};
+    GetCurrentProcessorNumberEx(&pn);
+    USHORT node = 0;
+    return GetNumaProcessorNodeEx(&pn, &node) ? static_cast<int>(node) : 0;
+}
+
+#else
+
+void LineMemory::AllocateMapped(std::size_t bytes, const LineMemoryOptions& opt, int node) {
+    void* p = MAP_FAILED;
+
+#if defined(MAP_HUGETLB)
+    if (opt.Huge == HugePages::Explicit) {
+        // hugetlbfs のプール（vm.nr_hugepages）から取る。足りなければ通常ページへ
+        mapBytes_ = round_up(bytes, HUGE_PAGE_BYTES);
+        p = mmap(nullptr, mapBytes_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        huge_ = (p != MAP_FAILED);
+        if (huge_) data_ = static_cast<std::uint8_t*>(p);
+    }
+#endif
+
+    if (p == MAP_FAILED) {
+        // THP は 2MiB 境界に揃った範囲にしか効かないので余白を取って境界合わせする
+        const bool thp = (opt.Huge != HugePages::None);
+        mapBytes_ = thp ? round_up(bytes, HUGE_PAGE_BYTES) + HUGE_PAGE_BYTES : bytes;
+        p = mmap(nullptr, mapBytes_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) throw std::bad_alloc();
+
+        const auto addr = reinterpret_cast<std::uintptr_t>(p);
+        data_ = reinterpret_cast<std::uint8_t*>(thp ? round_up(addr, HUGE_PAGE_BYTES) : addr);
+#if defined(MADV_HUGEPAGE)
+        if (thp) huge_ = (madvise(data_, round_up(bytes, HUGE_PAGE_BYTES), MADV_HUGEPAGE) == 0);
+#endif
+    }
+
+    kind_    = Kind::Map;
+    mapBase_ = p;
+    bytes_   = bytes;
+
+    if (node >= 0) BindNuma(node, false);
+}
+
+// 置けなければ（カーネルに無い・権限・無いノード）通常の配置のまま続け、errno を残す（ヒュージページと同じく確保は失敗させない）
+void LineMemory::BindNuma(int node, bool moveTouched) {
+#if defined(__linux__)
+    // libnuma に依存しないよう mbind を直接呼ぶ
+    constexpr int           MPOL_BIND_    = 2;
+    constexpr unsigned      MPOL_MF_MOVE_ = 1u << 1; // 既に触れたページも移す
+    constexpr unsigned long MAX_NODES     = 1024;
+    if (node >= static_cast<int>(MAX_NODES)) throw std::out_of_range("NumaNode");
+
+    unsigned long mask[MAX_NODES / (8 * sizeof(unsigned long))] = {};
+    mask[node / (8 * sizeof(unsigned long))] |= 1ul << (node % (8 * sizeof(unsigned long)));
+
+    const std::size_t len = round_up(bytes_, page_bytes());
+    if (syscall(SYS_mbind, data_, len, MPOL_BIND_, mask, MAX_NODES + 1, moveTouched ? MPOL_MF_MOVE_ : 0u) == 0)
+        numaNode_.store(node, std::memory_order_release);
+    else
+        numaError_.store(errno, std::memory_order_release);
+#else
+    (void)node; (void)moveTouched;
+#endif
+}
+
+void LineMemory::LockPages() {
+    if (mlock(data_, bytes_) != 0)
+        throw std::runtime_error(std::string("mlock failed: ") + std::strerror(errno));
+    locked_ = true;
+}
+
+int LineMemory::CurrentNumaNode() noexcept {
+#if defined(__linux__)
+    unsigned cpu = 0, node = 0;
+    if (syscall(SYS_getcpu, &cpu, &node, nullptr) == 0) return static_cast<int>(node);
+#endif
+    return 0;
+}
+
+#endif
+
+// ---- ファイルバック ----
+#if defined(_WIN32)
+
+void LineMemory::MapFile(std::size_t bytes, const LineMemoryOptions& opt) {
+    const std::size_t total = opt.FileHeaderBytes + bytes;
+    const bool        ro    = opt.FileReadOnly;
+    const bool        exist = ro || opt.FileOpenExisting;
+
+    const std::filesystem::path path(opt.FilePath);
+    HANDLE file = CreateFileW(path.c_str(),
+                              ro ? GENERIC_READ : (GENERIC_READ | GENERIC_WRITE),
+                              FILE_SHARE_READ, nullptr,
+                              exist ? OPEN_EXISTING : CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        throw std::runtime_error("CreateFile failed: " + opt.FilePath + " (" + std::to_string(GetLastError()) + ")");
+
+    LARGE_INTEGER size{};
+    GetFileSizeEx(file, &size);
+    if (exist && static_cast<std::size_t>(size.QuadPart) < total) {
+        CloseHandle(file);
+        throw std::runtime_error("file too small: " + opt.FilePath);
+    }
+
+    const auto size64 = static_cast<ULONGLONG>(total);
+    HANDLE section = CreateFileMappingW(file, nullptr, ro ? PAGE_READONLY : PAGE_READWRITE,
+                                        static_cast<DWORD>(size64 >> 32), static_cast<DWORD>(size64), nullptr);
+    void*  view    = section ? MapViewOfFile(section, ro ? FILE_MAP_READ : FILE_MAP_WRITE, 0, 0, total) : nullptr;
+    if (!view) {
+        const DWORD err = GetLastError();
+        if (section) CloseHandle(section);
+        CloseHandle(file);
+        throw std::runtime_error("MapViewOfFile failed: " + std::to_string(err));
+    }
+
+    kind_     = Kind::File;
+    mapBase_  = view;
+    mapBytes_ = total;
+    data_     = static_cast<std::uint8_t*>(view) + opt.FileHeaderBytes;
+    bytes_    = bytes;
+    section_  = section;
+    file_     = file;
+}
+
+void LineMemory::FlushFile(std::size_t offset, std::size_t len, bool wait) noexcept {
+    if (kind_ != Kind::File || offset >= mapBytes_) return;
+    len = std::min(len, mapBytes_ - offset);
+    FlushViewOfFile(static_cast<std::uint8_t*>(mapBase_) + offset, len);
+    if (wait) FlushFileBuffers(static_cast<HANDLE>(file_));
+}
+
+#else
+
+void LineMemory::MapFile(std::size_t bytes, const LineMemoryOptions& opt) {
+    const std::size_t total = opt.FileHeaderBytes + bytes;
+    const bool        ro    = opt.FileReadOnly;
+    const bool        exist = ro || opt.FileOpenExisting;
+
+    const int fd = ro    ? open(opt.FilePath.c_str(), O_RDONLY | O_CLOEXEC)
+                 : exist ? open(opt.FilePath.c_str(), O_RDWR | O_CLOEXEC)
+                         : open(opt.FilePath.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) throw std::runtime_error("open failed: " + opt.FilePath + " (" + std::strerror(errno) + ")");
+
+    if (exist) {
+        const off_t size = lseek(fd, 0, SEEK_END);
+        if (size < 0 || static_cast<std::size_t>(size) < total) {
+            close(fd);
+            throw std::runtime_error("file too small: " + opt.FilePath);
+        }
+    } else if (ftruncate(fd, static_cast<off_t>(total)) != 0) { // 疎ファイルとして伸ばす
+        close(fd);
+        throw std::runtime_error("ftruncate failed: " + opt.FilePath);
+    }
+
+    void* p = mmap(nullptr, total, ro ? PROT_READ : (PROT_READ | PROT_WRITE), MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) {
+        close(fd);
+        throw std::runtime_error("mmap failed: " + opt.FilePath);
+    }
+
+    kind_     = Kind::File;
+    mapBase_  = p;
+    mapBytes_ = total;
+    data_     = static_cast<std::uint8_t*>(p) + opt.FileHeaderBytes;
+    bytes_    = bytes;
+    fd_       = fd;
+}
+
+void LineMemory::FlushFile(std::size_t offset, std::size_t len, bool wait) noexcept {
+    if (kind_ != Kind::File || offset >= mapBytes_) return;
+    len = std::min(len, mapBytes_ - offset);
+#if defined(__linux__)
+    // 範囲を指定して書き出しを開始（wait なら完了まで待つ）。ページキャッシュの汚れを溜めない
+    const unsigned flags = wait
+        ? (SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER)
+        : SYNC_FILE_RANGE_WRITE;
+    sync_file_range(fd_, static_cast<off_t>(offset), static_cast<off_t>(len), flags);
+    if (wait) fdatasync(fd_);
+#else
+    const std::size_t page  = page_bytes();
+    const std::size_t begin = offset / page * page;
+    msync(static_cast<std::uint8_t*>(mapBase_) + begin, len + (offset - begin), wait ? MS_SYNC : MS_ASYNC);
+#endif
+}
+
+#endif
+
+// ---- NUMA_CURRENT ----
+void LineMemory::BindToCurrentNode() {
+    if (!numaPending_.load(std::memory_order_relaxed) || !numaPending_.exchange(false, std::memory_order_acq_rel)) return;
+    BindNuma(CurrentNumaNode(), /*moveTouched=*/locked_);
+    if (prefaultPending_) {
+        prefaultPending_ = false;
+        StartPrefault(prefaultAsync_);
+    }
+}
+
+// ---- プリフォールト ----
+void LineMemory::StartPrefault(bool async) {
+    if (!prefault_) prefault_ = std::make_shared<PrefaultState>();
+    const std::size_t step = huge_ ? HUGE_PAGE_BYTES : page_bytes();
+
+    if (!async) {
+        TouchPages(data_, bytes_, step, prefault_.get());
+        prefault_->Done.store(true, std::memory_order_release);
+        return;
+    }
+
+    prefaultThread_ = std::thread([p = data_, n = bytes_, step, st = prefault_] {
+        TouchPages(p, n, step, st.get());
+        st->Done.store(true, std::memory_order_release);
+    });
+}
+
+// writer が並行して書いていても壊さないよう「値を変えない書き込み」でフォールトさせる
+void LineMemory::TouchPages(std::uint8_t* p, std::size_t bytes, std::size_t step, const PrefaultState* st) noexcept {
+    constexpr std::size_t CHUNK = std::size_t(64) << 20; // キャンセル確認の間隔
+
+    for (std::size_t off = 0; off < bytes; off += CHUNK) {
+        if (st && st->Cancel.load(std::memory_order_relaxed)) return;
+        const std::size_t n = std::min(CHUNK, bytes - off);
+
+#if defined(MADV_POPULATE_WRITE)
+        if (madvise(p + off, round_up(n, page_bytes()), MADV_POPULATE_WRITE) == 0) continue;
+#endif
+        for (std::size_t i = 0; i < n; i += step)
+            std::atomic_ref<std::uint8_t>(p[off + i]).fetch_add(0, std::memory_order_relaxed);
+    }
+}
+
+void LineMemory::WaitPrefault() noexcept {
+    if (prefaultThread_.joinable()) prefaultThread_.join();
+}
+
+bool LineMemory::PrefaultDone() const noexcept {
+    return !prefault_ || prefault_->Done.load(std::memory_order_acquire);
+}
+
+// ---- 二重マップ ----
+std::size_t LineMemory::MirrorGranularity() {
+#if defined(_WIN32)
+    SYSTEM_INFO si{};
+    GetSystemInfo(&si);
+    return static_cast<std::size_t>(si.dwAllocationGranularity);
+#else
+    return static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+#if defined(_WIN32)
+
+// placeholder（Win10 1803 以降）で 2 面ぶんの連続領域を予約し、同じセクションを並べてマップする
+void LineMemory::AllocateMirrored(std::size_t bytes) {
+    if (bytes % MirrorGranularity() != 0) throw std::invalid_argument("bytes (mirror granularity)");
+
+    const auto size64 = static_cast<ULONGLONG>(bytes);
+    HANDLE section = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                        static_cast<DWORD>(size64 >> 32), static_cast<DWORD>(size64), nullptr);
+    if (!section) throw std::runtime_error("CreateFileMapping failed: " + std::to_string(GetLastError()));
+
+    auto* base = static_cast<std::uint8_t*>(
+        VirtualAlloc2(nullptr, nullptr, bytes * 2, MEM_RESERVE | MEM_RESERVE_PLACEHOLDER, PAGE_NOACCESS, nullptr, 0));
+    if (!base) {
+        CloseHandle(section);
+        throw std::runtime_error("VirtualAlloc2 failed: " + std::to_string(GetLastError()));
+    }
+
+    // placeholder を前半/後半に分割
+    VirtualFree(base, bytes, MEM_RELEASE | MEM_PRESERVE_PLACEHOLDER);
+
+    void* v0 = MapViewOfFile3(section, nullptr, base, 0, bytes,
+                              MEM_REPLACE_PLACEHOLDER, PAGE_READWRITE, nullptr, 0);
+    void* v1 = v0 ? MapViewOfFile3(section, nullptr, base + bytes, 0, bytes,
+                                   MEM_REPLACE_PLACEHOLDER, PAGE_READWRITE, nullptr, 0)
+                  : nullptr;
+    if (!v0 || !v1) {
+        const DWORD err = GetLastError();
+        if (v0) UnmapViewOfFileEx(v0, 0);
+        VirtualFree(base, 0, MEM_RELEASE);
+        VirtualFree(base + bytes, 0, MEM_RELEASE);
+        CloseHandle(section);
+        throw std::runtime_error("MapViewOfFile3 failed: " + std::to_string(err));
+    }
+
+    kind_    = Kind::Mirror;
+    data_    = base;
+    bytes_   = bytes;
+    section_ = section;
+}
+
+#else
+
+// 無名の共有メモリ fd を作る（Linux: memfd, その他 POSIX: shm_open → 即 unlink）
+static int create_anon_shm(std::size_t bytes) {
+#if defined(__linux__)
+    int fd = memfd_create("lineStore", MFD_CLOEXEC);
+#else
+    static std::atomic<unsigned> seq{0};
+    const std::string name = "/lineStore." + std::to_string(getpid()) + "." + std::to_string(seq++);
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd >= 0) shm_unlink(name.c_str());
+#endif
+    if (fd < 0) throw std::runtime_error("shared memory fd failed");
+    if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+        close(fd);
+        throw std::runtime_error("ftruncate failed");
+    }
+    return fd;
+}
+
+void LineMemory::AllocateMirrored(std::size_t bytes) {
+    if (bytes % MirrorGranularity() != 0) throw std::invalid_argument("bytes (mirror granularity)");
+
+    const int fd = create_anon_shm(bytes);
+
+    // 2 面ぶんの仮想領域を予約してから、同じ fd を前半/後半に MAP_FIXED で重ねる
+    void* base = mmap(nullptr, bytes * 2, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) {
+        close(fd);
+        throw std::runtime_error("mmap reserve failed");
+    }
+
+    auto* b  = static_cast<std::uint8_t*>(base);
+    void* v0 = mmap(b,         bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0);
+    void* v1 = mmap(b + bytes, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0);
+    close(fd); // マップが参照を保持する
+
+    if (v0 == MAP_FAILED || v1 == MAP_FAILED) {
+        munmap(base, bytes * 2);
+        throw std::runtime_error("mmap mirror failed");
+    }
+
+    kind_  = Kind::Mirror;
+    data_  = b;
+    bytes_ = bytes;
+}
+
+#endif
@@ -0,0 +1,131 @@
+#pragma once
+// LineMemory.hpp
+// LineStore の画素バッファ確保（通常ヒープ / 二重マップのリング / ヒュージページ・NUMA・常駐化 / ファイル）
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+
+enum class HugePages
+{
+    None,
+    Transparent, // Linux: THP を madvise で要求（2MiB 境界に揃える）
+    Explicit,    // Linux: MAP_HUGETLB / Windows: MEM_LARGE_PAGES（確保できなければ通常ページ）
+};
+
+struct LineMemoryOptions
+{
+    // 同じ物理メモリを仮想アドレス上で 2 回連続にマップする。
+    // Data()[i] と Data()[Bytes() + i] が同じ実体になるので、リングの末尾を跨ぐ窓も連続して見える。
+    // bytes は MirrorGranularity() の倍数であること
+    bool Mirrored = false;
+
+    HugePages Huge = HugePages::None; // Mirrored とは併用不可
+
+    bool Lock          = false; // mlock / VirtualLock（失敗したら例外）
+    bool Prefault      = false; // 全ページを書き込み可能な状態で確定させる（ページフォールトを先に済ませる）
+    bool PrefaultAsync = false; // Prefault をバックグラウンドスレッドで行う（WaitPrefault で待つ）
+
+    // 物理ページを置く NUMA ノード。NUMA_ANY: 指定なし, NUMA_CURRENT: 最初に書き込むスレッドのノード
+    // （Linux：BindToCurrentNode まで配置とプリフォールトを遅らせる。Windows は確保したスレッドのノード）。
+    // 置けなければ（mbind の EPERM / EINVAL など）通常の配置のまま続ける（NumaNode() / NumaBindError() で分かる）
+    int NumaNode = NUMA_ANY;
+
+    // ファイルバック：ファイル全体を共有マップし、先頭 FileHeaderBytes の後ろを Data() にする。
+    // Mirrored / Huge とは併用不可。NUMA 指定は無視（ページキャッシュの配置は OS 任せ）
+    std::string FilePath;
+    std::size_t FileHeaderBytes  = 0;     // ページ境界の倍数にしておくと Data() が揃う
+    bool        FileReadOnly     = false; // 既存ファイルを読み取り専用で開く（サイズが足りなければ例外）
+    bool        FileOpenExisting = false; // 既存ファイルを切り詰めずに読み書きで開く（サイズが足りなければ例外）
+
+    // 通常ヒープで確保する場合の Data() の境界（0 なら malloc のまま）。マップ系は常にページ境界
+    std::size_t Alignment = 0;
+
+    static constexpr int NUMA_ANY     = -1;
+    static constexpr int NUMA_CURRENT = -2;
+};
+
+class LineMemory
+{
+public:
+    LineMemory() noexcept = default;
+    LineMemory(std::size_t bytes, const LineMemoryOptions& opt);
+    ~LineMemory();
+
+    LineMemory(const LineMemory&) = delete;
+    LineMemory& operator=(const LineMemory&) = delete;
+    LineMemory(LineMemory&& other) noexcept;
+    LineMemory& operator=(LineMemory&& other) noexcept;
+
+    std::uint8_t* Data()     const noexcept { return data_; }
+    std::size_t   Bytes()    const noexcept { return bytes_; }  // 実体のバイト数（二重マップでも 1 面分）
+    bool          Mirrored() const noexcept { return kind_ == Kind::Mirror; }
+    bool          HugePagesActive() const noexcept { return huge_; } // ヒュージページで確保できたか
+    bool          Locked()   const noexcept { return locked_; }
+    int           NumaNode() const noexcept { return numaNode_.load(std::memory_order_acquire); } // 置いたノード（-1: 指定なし・未決定・置けなかった）
+    int           NumaBindError() const noexcept { return numaError_.load(std::memory_order_acquire); } // mbind の errno（0 なら失敗していない）
+    bool          NumaPending() const noexcept { return numaPending_.load(std::memory_order_relaxed); }
+    bool          FileBacked() const noexcept { return kind_ == Kind::File; }
+    std::uint8_t* FileHeader() const noexcept { return kind_ == Kind::File ? static_cast<std::uint8_t*>(mapBase_) : nullptr; }
+
+    // ファイルへの書き戻し（offset はファイル先頭から）。wait=false なら書き出しを開始するだけ
+    void FlushFile(std::size_t offset, std::size_t len, bool wait) noexcept;
+
+    // NUMA_CURRENT：呼んだスレッドのノードにページを置き（触れ済みのページは移す）、遅らせていたプリフォールトを始める。
+    // writer が最初の書き込みの前に呼ぶ。2 回目以降は何もしない
+    void BindToCurrentNode();
+
+    // 非同期プリフォールトの完了待ち（同期/指定なしなら即 return）
+    void WaitPrefault() noexcept;
+    bool PrefaultDone() const noexcept;
+
+    void Release() noexcept;
+
+    // 二重マップの単位（Linux/mac: ページサイズ, Windows: 割り当て粒度 64KiB）
+    static std::size_t MirrorGranularity();
+
+    // 呼び出しスレッドが現在いる NUMA ノード（不明なら 0）
+    static int CurrentNumaNode() noexcept;
+
+private:
+    enum class Kind { None, Malloc, Map, Mirror, File };
+
+    struct PrefaultState
+    {
+        std::atomic<bool> Done{false};
+        std::atomic<bool> Cancel{false};
+    };
+
+    void AllocateHeap(std::size_t bytes, std::size_t alignment);
+    void AllocateMapped(std::size_t bytes, const LineMemoryOptions& opt, int node);
+    void AllocateMirrored(std::size_t bytes);
+    void MapFile(std::size_t bytes, const LineMemoryOptions& opt);
+    void BindNuma(int node, bool moveTouched);
+    void LockPages();
+    void StartPrefault(bool async);
+
+    static void TouchPages(std::uint8_t* p, std::size_t bytes, std::size_t step, const PrefaultState* st) noexcept;
+
+    Kind          kind_     = Kind::None;
+    std::uint8_t* data_     = nullptr;
+    std::size_t   bytes_    = 0;
+    void*         mapBase_  = nullptr; // Map/File: 実際にマップした先頭（境界合わせ前 / ファイル先頭）
+    std::size_t   mapBytes_ = 0;       // Map/File: 実際にマップしたバイト数
+    void*         section_  = nullptr; // Windows: 共有セクションのハンドル
+    void*         file_     = nullptr; // Windows: ファイルハンドル
+    int           fd_       = -1;      // POSIX: ファイル
+    bool          huge_     = false;
+    bool          locked_   = false;
+
+    std::atomic<int>  numaNode_{-1};
+    std::atomic<int>  numaError_{0};
+    std::atomic<bool> numaPending_{false}; // NUMA_CURRENT で、まだ BindToCurrentNode が呼ばれていない
+    bool              prefaultPending_ = false; // BindToCurrentNode で始める
+    bool              prefaultAsync_   = false;
+
+    std::thread                    prefaultThread_;
+    std::shared_ptr<PrefaultState> prefault_;
+};
@@ -5,6 +5,7 @@
 #include <stdexcept>
 #include <limits>
 #include <algorithm>
+#include <cmath>
 
 // ---- 構成情報（インライン化しない版）----
 int  LineStore::SourceWidth()    const noexcept { return sourceWidth_; }
@@ -1,9 +1,12 @@
+#include <cmath>
 #include <cstdlib>
 #include <cstring>
 #include <stdexcept>
 #include <limits>
 #include <algorithm>
+#include <numeric>
 #include "lineStore2.hpp"
+#include "waitWord.hpp"
 
 // ---- 構成情報（インライン化しない版）----
 int  LineStore::SourceWidth()    const noexcept { return sourceWidth_; }
@@ -14,48 +17,273 @@ int  LineStore::WarmupMax()      const noexcept { return warmupMax_; }
 PixelType LineStore::PixelT()    const noexcept { return pixelType_; }
 int  LineStore::ElemSizeBytes()  const noexcept { return elemSizeBytes_; }
 int  LineStore::RowBytes()       const noexcept { return width_ * elemSizeBytes_; }
-int  LineStore::SourceRowBytes() const noexcept { return sourceWidth_ * elemSizeBytes_; }
+int  LineStore::RowPitchBytes()  const noexcept { return rowPitch_; }
+int  LineStore::SourceRowBytes() const noexcept {
+    return static_cast<int>((static_cast<i64>(sourceWidth_) * SourceBitsPerPixel(sourceFormat_) + 7) / 8);
+}
+SourceFormat LineStore::SourceT() const noexcept { return sourceFormat_; }
+bool LineStore::Mirrored()       const noexcept { return memory_.Mirrored(); }
+const LineMemory& LineStore::Memory() const noexcept { return memory_; }
 
-LineStore::i64 LineStore::HeadTotal()   const noexcept { return headTotal_.load(std::memory_order_relaxed); }
+LineStore::i64 LineStore::HeadTotal()   const noexcept { return headTotal_.load(std::memory_order_acquire); }
 LineStore::i64 LineStore::StoredLines() const noexcept { return storedLines_.load(std::memory_order_acquire); }
 
+LineStore::i64 LineStore::EndRowAbs() const noexcept { return publishIndex_.load(std::memory_order_acquire); }
+LineStore::i64 LineStore::OldestRowAbs() const noexcept {
+    // 採用モードはブロック単位で解放するので、最古の保持中ブロックの先頭（claimIndex_ - capacityLines_）
+    if (adopt_) return std::max<i64>(0, claimIndex_.load(std::memory_order_acquire) - capacityLines_);
+    const i64 end = EndRowAbs();
+    return (circular_ && end > capacityLines_) ? end - capacityLines_ : 0;
+}
+
+bool         LineStore::SteadyTime()   const noexcept { return steadyTime_; }
+std::int64_t LineStore::TimeOriginNs() const noexcept { return binParent_ ? binParent_->timeOriginNs_ : timeOriginNs_; }
+
+bool LineStore::RowTimeNs(i64 rowAbs, std::int64_t& timeNs) const noexcept {
+    timeNs = 0;
+    if (!committed_.load(std::memory_order_acquire)) return false;
+    if (rowAbs >= EndRowAbs()) return false;
+    if (rowAbs < OldestRowAbs() && rowAbs < ColdOldestRowAbs()) return false;
+    timeNs = binParent_ ? binParent_->SecToNs(RowTimeSec(rowAbs)) : SecToNs(RowTimeSec(rowAbs));
+    return true;
+}
+
+bool LineStore::RowTimeSec(i64 rowAbs, double& timeSec) const noexcept {
+    timeSec = 0.0;
+    if (!committed_.load(std::memory_order_acquire)) return false;
+    if (rowAbs >= EndRowAbs()) return false;
+    if (rowAbs < OldestRowAbs() && rowAbs < ColdOldestRowAbs()) return false;
+    timeSec = RowTimeSec(rowAbs);
+    return true;
+}
+
+LineStore::i64 LineStore::DroppedRows()         const noexcept { return droppedRows_.load(std::memory_order_relaxed); }
+LineStore::i64 LineStore::TimeSegments()        const noexcept { return segs_->Count(); }
+LineStore::i64 LineStore::DroppedTimeSegments() const noexcept { return segs_->Dropped(); }
+
+// ---- 統計 ----
+LineStoreStats LineStore::Stats() const noexcept {
+    LineStoreStats st;
+    st.PushCalls           = pushCalls_.load(std::memory_order_relaxed);
+    st.PushedRows          = headTotal_.load(std::memory_order_acquire);
+    st.DroppedRows         = droppedRows_.load(std::memory_order_relaxed);
+    st.OverwrittenReads    = overwrittenReads_.load(std::memory_order_relaxed);
+    st.DroppedTimeSegments = segs_->Dropped();
+    st.ColdRows            = coldRows_.load(std::memory_order_relaxed);
+    st.ColdBytes           = coldBytes_.load(std::memory_order_relaxed);
+    st.ColdLostRows        = coldLostRows_.load(std::memory_order_relaxed);
+    st.NumaNode            = memory_.NumaNode();
+    st.NumaBindError       = memory_.NumaBindError();
+
+    // 気づいた分（CursorAcquire で飛ばした行）に、開いているカーソルがまだ気づいていない分を足す
+    i64 lost = lostRows_.load(std::memory_order_relaxed);
+    if (circular_ && committed_.load(std::memory_order_acquire)) {
+        const i64 oldest = claimIndex_.load(std::memory_order_acquire) - capacityLines_;
+        for (const auto& c : cursors_) {
+            if (c.State.load(std::memory_order_acquire) != CursorSlot::Active) continue;
+            lost += std::max<i64>(0, oldest - c.Pos.load(std::memory_order_acquire));
+        }
+    }
+    st.OverwrittenRows = lost;
+
+    st.PushLatency = pushLatency_.Snapshot();
+    return st;
+}
+
+void LineStore::RecordPush(std::chrono::steady_clock::time_point t0) noexcept {
+    const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0).count();
+    RecordPushNs(static_cast<std::uint64_t>(std::max<std::int64_t>(0, ns)));
+}
+
+void LineStore::RecordPushNs(std::uint64_t ns) noexcept {
+    pushCalls_.store(pushCalls_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    pushLatency_.Record(ns);
+}
+
+ReadResult LineStore::CountOverwritten() const noexcept {
+    overwrittenReads_.fetch_add(1, std::memory_order_relaxed);
+    return ReadResult::Overwritten;
+}
+
 // ---- 生成/破棄 ----
+namespace {
+LineStoreOptions circular_options(bool circular) {
+    LineStoreOptions o;
+    o.Circular = circular;
+    return o;
+}
+} // namespace
+
 LineStore::LineStore(int srcWidth, int roiX, int roiW,
                      i64 capacityLines, int warmupMax, PixelType pt,
                      bool circular)
+    : LineStore(srcWidth, roiX, roiW, capacityLines, warmupMax, pt, circular_options(circular))
+{
+}
+
+LineStore::LineStore(int srcWidth, int roiX, int roiW,
+                     i64 capacityLines, int warmupMax, PixelType pt,
+                     const LineStoreOptions& opt)
     : sourceWidth_(srcWidth)
     , roiX_(roiX)
     , width_(roiW)
     , capacityLines_(capacityLines)
+    , capMask_(-1)
+    , rowAlign_(opt.RowAlignBytes)
+    , rowPitch_(roiW * PixelTypeBytes(pt))
     , warmupMax_(warmupMax)
     , pixelType_(pt)
-    , elemSizeBytes_(pt == PixelType::U8 ? 1 : 2)
+    , elemSizeBytes_(PixelTypeBytes(pt))
+    , sourceFormat_(ResolveSourceFormat(opt.Source, pt))
+    , sourceShift_(opt.SourceShift)
+    , convert_(nullptr)
+    , pushFn_(nullptr)
+    , windowFn_(nullptr)
+    , adopt_(opt.AdoptFrames)
+    , adoptMask_(0)
+    , adoptHead_(0)
+    , adoptTail_(0)
+    , parallelMinBytes_(opt.ParallelMinBytes)
+    , parallelPush_(false)
     , committed_(false)
     , warmupCount_(0)
+    , warmupHead_(0)
     , buf_(nullptr)
     , writeIndex_(0)
     , headTotal_(0)
     , storedLines_(0)
     , disposed_(false)
-    , segs_()
-    , segCount_(0)
+    , claimIndex_(0)
+    , publishIndex_(0)
+    , wakeSeq_(0)
+    , waiters_(0)
+    , backpressureCursors_(0)
+    , droppedRows_(0)
+    , lostRows_(0)
+    , pushCalls_(0)
+    , overwrittenReads_(0)
+    , segs_(std::make_shared<TimeIndex>(opt.TimeSegCapacity))
+    , ownsSegs_(true)
     , warmupLastTimeSec_(std::numeric_limits<double>::quiet_NaN())
+    , steadyTime_(opt.SteadyTime)
+    , timeOriginNs_(opt.SteadyTime ? NowSteadyNs() : 0)
+    , lastPushNs_(std::numeric_limits<std::int64_t>::min())
     , commitBase_(0)
-    , circular_(circular)
+    , circular_(opt.Circular)
+    , meta_(opt.LineMeta)
+    , pushMeta_(nullptr)
+    , colStats_(opt.ColumnStats)
+    , colAlpha_(static_cast<float>(opt.ColumnStatsAlpha))
+    , colSumFn_(nullptr)
+    , colEmaFn_(nullptr)
+    , colSeq_(0)
+    , colWanted_(false)
+    , colSnapSeq_(0)
+    , colResetPending_(false)
+    , flatFn_(nullptr)
+    , flatPending_(false)
+    , tapCount_(0)
+    , tapsSealed_(false)
+    , tapSegEnd_(0)
+    , coldChunkRows_(opt.ColdChunkRows)
+    , coldStop_(false)
+    , coldLostRows_(0)
+    , coldBytes_(0)
+    , coldRows_(0)
+    , coldSegRow_(0)
+    , binParent_(nullptr)
+    , binFactor_(1)
+    , fileHeader_(nullptr)
+    , fileSegs_(nullptr)
+    , fileWarmupTimes_(nullptr)
+    , fileSegCount_(0)
+    , readOnly_(false)
+    , flushIntervalMs_(opt.FileFlushIntervalMs)
+    , flushedIndex_(0)
+    , flushStop_(false)
 {
     static_assert(sizeof(void*) == 8, "x64 専用です。");
     if (srcWidth <= 0) throw std::out_of_range("srcWidth");
     if (roiX < 0 || roiX >= srcWidth) throw std::out_of_range("roiX");
     if (roiW <= 0 || roiX + roiW > srcWidth) throw std::out_of_range("roiW");
     if (capacityLines < warmupMax || warmupMax <= 0) throw std::out_of_range("warmupMax");
+    if (opt.Mirrored && !opt.Circular) throw std::invalid_argument("Mirrored requires Circular");
+    if (sourceShift_ < 0 || sourceShift_ > 15) throw std::out_of_range("SourceShift");
+    if (rowAlign_ < 0 || (rowAlign_ & (rowAlign_ - 1)) != 0) throw std::invalid_argument("RowAlignBytes");
+    if (opt.PowerOfTwoCapacity && !opt.Circular) throw std::invalid_argument("PowerOfTwoCapacity requires Circular");
+    if (opt.BinLevels < 0 || opt.BinLevels > 3) throw std::out_of_range("BinLevels");
+    if (opt.CopyThreads < 0) throw std::out_of_range("CopyThreads");
+    if (opt.ColdCapacityLines < 0) throw std::out_of_range("ColdCapacityLines");
+    if (opt.ColdCapacityLines > 0 && (!opt.Circular || adopt_))
+        throw std::invalid_argument("ColdCapacityLines requires Circular without AdoptFrames");
+    if (meta_ && adopt_) throw std::invalid_argument("LineMeta is not supported with AdoptFrames");
+    if (opt.ColumnStats != ColumnStatsMode::Off && adopt_)
+        throw std::invalid_argument("ColumnStats is not supported with AdoptFrames");
+    if (adopt_ && (!opt.Circular || opt.Mirrored || !opt.FilePath.empty() || opt.BinLevels != 0))
+        throw std::invalid_argument("AdoptFrames requires Circular without Mirrored/FilePath/BinLevels");
+
+    if (rowAlign_ > 0)
+        rowPitch_ = (RowBytes() + rowAlign_ - 1) / rowAlign_ * rowAlign_;
+
+    // 保存形式と同じでシフト無しなら memcpy、それ以外は変換カーネル
+    const bool same = (sourceFormat_ == SourceFormat::Mono8  && pt == PixelType::U8)
+                   || (sourceFormat_ == SourceFormat::Mono16 && pt == PixelType::U16);
+    if (!same || sourceShift_ != 0) {
+        convert_ = SelectRowConverter(sourceFormat_, pt);
+        if (!convert_) throw std::invalid_argument("Source");
+    }
+
+    if (opt.PowerOfTwoCapacity) {
+        i64 p = 1;
+        while (p < capacityLines_) p <<= 1;
+        capacityLines_ = p;
+    }
+
+    if (opt.Mirrored) {
+        // 全体バイト数がマップ粒度の倍数になる行数単位へ切り上げ
+        // （単位も 2 のべき乗なので、2 のべき乗の容量はそのまま保たれる）
+        const i64 gran = static_cast<i64>(LineMemory::MirrorGranularity());
+        const i64 unit = gran / std::gcd(gran, static_cast<i64>(rowPitch_));
+        capacityLines_ = (capacityLines_ + unit - 1) / unit * unit;
+    }
 
-    const i64 totalBytes = capacityLines_ * static_cast<i64>(RowBytes());
+    const i64 totalBytes = capacityLines_ * static_cast<i64>(rowPitch_);
     if (totalBytes <= 0) throw std::overflow_error("totalBytes");
-    buf_ = static_cast<std::uint8_t*>(std::malloc(static_cast<size_t>(totalBytes)));
-    if (!buf_) throw std::bad_alloc();
+
+    // 2 のべき乗の容量なら物理行は & で求める
+    capMask_ = ((capacityLines_ & (capacityLines_ - 1)) == 0) ? capacityLines_ - 1 : -1;
+    SelectSpecialized();
 
     warmupTimes_.assign(static_cast<size_t>(warmupMax_), std::numeric_limits<double>::quiet_NaN());
-    segs_.reserve(64);
+    if (meta_) {
+        metaEncoder_.assign(static_cast<size_t>(capacityLines_), 0);
+        metaTrigger_.assign(static_cast<size_t>(capacityLines_), 0u);
+        metaFrame_.assign(static_cast<size_t>(capacityLines_), 0u);
+    }
+    if (opt.ColdCapacityLines > 0) {
+        if (coldChunkRows_ <= 0 || coldChunkRows_ > capacityLines_ / 2) throw std::out_of_range("ColdChunkRows");
+        coldSlots_.resize(static_cast<size_t>((opt.ColdCapacityLines + coldChunkRows_ - 1) / coldChunkRows_));
+    }
+    CreateColumns(opt);
+    CreateLevels(opt);
+    if (opt.CopyThreads > 0)
+        copyPool_ = std::make_unique<CopyPool>(opt.CopyThreads, opt.CopyThreadCpus);
+
+    if (adopt_) {
+        InitAdopt(opt); // 画素バッファは持たない
+        return;
+    }
+
+    if (!opt.FilePath.empty()) {
+        OpenFile(opt); // ヘッダ + 時刻領域つきでマップ（読み取り専用なら状態も復元）
+        return;
+    }
+
+    LineMemoryOptions mopt = opt.Memory;
+    mopt.Mirrored  = opt.Mirrored;
+    mopt.Alignment = std::max<size_t>(mopt.Alignment, static_cast<size_t>(rowAlign_));
+    memory_ = LineMemory(static_cast<size_t>(totalBytes), mopt);
+    buf_    = memory_.Data();
 }
 
 LineStore::~LineStore() {
@@ -65,37 +293,65 @@ LineStore::~LineStore() {
 void LineStore::Dispose() noexcept {
     bool expected = false;
     if (disposed_.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
-        std::free(buf_);
+        NotifyWaiters(); // 待っている reader を帰す
+        for (auto& lv : levels_) lv.Rows->Dispose();
+        copyPool_.reset();
+        StopCold();
+        ReleaseAllAdopted();
+        CloseFile();
+        memory_.Release();
         buf_ = nullptr;
     }
 }
 
+bool LineStore::IsDisposed() const noexcept { return disposed_.load(std::memory_order_acquire); }
+
 // ---- Commit ----
 void LineStore::Commit() {
     check_not_disposed();
+    if (readOnly_) throw std::logic_error("LineStore is read-only");
     if (committed_.load(std::memory_order_acquire)) return;
 
+    // 非同期プリフォールトをここで待つ（以降の追記でページフォールトを起こさない）
+    memory_.WaitPrefault();
+
     if (std::isnan(warmupLastTimeSec_))
-        warmupLastTimeSec_ = NowUnixSec();
+        warmupLastTimeSec_ = NowSec();
 
     AddSeg(/*start(logical)=*/0, warmupLastTimeSec_);
 
+    // ウォームアップのリングを 1 度だけ回して、最古の行を物理 0 行目にそろえる
+    RotateWarmup();
+
     // ウォームアップ領域の末尾から通常運用開始
     writeIndex_ = warmupCount_;  // 絶対行インデックス
     commitBase_ = warmupCount_;  // 絶対行→論理行の基準
 
+    claimIndex_.store(writeIndex_, std::memory_order_relaxed);
+    publishIndex_.store(writeIndex_, std::memory_order_release);
     storedLines_.store(warmupCount_, std::memory_order_release);
     committed_.store(true, std::memory_order_release);
+
+    // ビニングレベルはウォームアップ行から作り始める
+    CommitLevels();
+    StartCold();
+
+    if (fileHeader_) {
+        // 回した並びを書き戻してから状態欄（WarmupHead = 0）を更新する
+        std::memcpy(fileWarmupTimes_, warmupTimes_.data(), warmupTimes_.size() * sizeof(double));
+        SyncFileState();
+    }
 }
 
 // ---- PushBlock ----
 bool LineStore::PushBlock(const void* src, int rows, int srcStrideBytes) {
-    return PushBlock(src, rows, srcStrideBytes, NowUnixSec());
+    return PushBlock(src, rows, srcStrideBytes, NowSec());
 }
 
 bool LineStore::PushBlock(const void* src, int rows, int srcStrideBytes,
                           std::chrono::system_clock::time_point acquiredUtc)
 {
+    if (steadyTime_) throw std::logic_error("SteadyTime store takes steady_clock times (PushBlockNs)");
     const double t = ToUnixSec(acquiredUtc);
     return PushBlock(src, rows, srcStrideBytes, t);
 }
@@ -103,26 +359,85 @@ bool LineStore::PushBlock(const void* src, int rows, int srcStrideBytes,
 bool LineStore::PushBlock(const void* src, int rows, int srcStrideBytes,
                           double acquiredUtcSec)
 {
-    check_not_disposed();
-    if (!src) throw std::invalid_argument("src");
-    if (rows <= 0) return true;
-    if (srcStrideBytes < SourceRowBytes())
-        throw std::invalid_argument("srcStrideBytes too small (for source width)");
+    if (binParent_) throw std::logic_error("LineStore bin level is written by its parent");
+    PushTimer timer{ *this };
+    return PushRows(src, rows, srcStrideBytes, acquiredUtcSec, /*newSeg=*/true);
+}
 
-    if (!committed_.load(std::memory_order_acquire)) {
-        PushWarmup(src, rows, srcStrideBytes, acquiredUtcSec);
-        headTotal_.fetch_add(rows, std::memory_order_relaxed);
-        return true;
-    } else {
-        return PushLinear(src, rows, srcStrideBytes, acquiredUtcSec);
+bool LineStore::PushBlockParallel(const void* src, int rows, int srcStrideBytes) {
+    return PushBlockParallel(src, rows, srcStrideBytes, NowSec());
+}
+
+bool LineStore::PushBlockParallel(const void* src, int rows, int srcStrideBytes, double acquiredUtcSec) {
+    if (binParent_) throw std::logic_error("LineStore bin level is written by its parent");
+
+    // 経路は PushBlock と同じ。CopyRowsT だけが分担する（例外でも戻す）
+    PushTimer timer{ *this };
+    struct Reset { bool& Flag; ~Reset() { Flag = false; } } reset{ parallelPush_ };
+    parallelPush_ = true;
+    return PushRows(src, rows, srcStrideBytes, acquiredUtcSec, /*newSeg=*/true);
+}
+
+bool LineStore::PushBlockNs(const void* src, int rows, int srcStrideBytes, std::int64_t timeNs) {
+    if (timeNs < lastPushNs_) timeNs = lastPushNs_;
+    lastPushNs_ = timeNs;
+    return PushBlock(src, rows, srcStrideBytes, NsToSec(timeNs));
+}
+
+// 形式・モード別に特殊化した実装（lineStoreSpecialized.cpp）へ。選択は生成時の 1 回だけ
+bool LineStore::PushRows(const void* src, int rows, int srcStrideBytes, double timeSec, bool newSeg) {
+    return (this->*pushFn_)(src, rows, srcStrideBytes, timeSec, newSeg);
+}
+
+// ---- 待機 ----
+void LineStore::NotifyWaiters() noexcept {
+    // WaitForLines と対：seq_cst で「waiters_ を増やした reader は新しい wakeSeq_ を見る」か
+    // 「writer が waiters_ > 0 を見て起こす」のどちらかが必ず成り立つ
+    wakeSeq_.fetch_add(1, std::memory_order_seq_cst);
+    if (waiters_.load(std::memory_order_seq_cst) > 0)
+        WakeWordAll(wakeSeq_);
+}
+
+bool LineStore::WaitForLines(i64 minHeadTotal, std::chrono::nanoseconds timeout) const noexcept {
+    return WaitForLines(minHeadTotal, timeout, nullptr);
+}
+
+bool LineStore::WaitForLines(i64 minHeadTotal, std::chrono::nanoseconds timeout,
+                             const std::atomic<bool>* stop) const noexcept {
+    using namespace std::chrono;
+    if (headTotal_.load(std::memory_order_acquire) >= minHeadTotal) return true;
+
+    const bool infinite = (timeout == nanoseconds::max());
+    const auto deadline = infinite ? steady_clock::time_point::max() : steady_clock::now() + timeout;
+
+    waiters_.fetch_add(1, std::memory_order_seq_cst);
+    bool ok = false;
+    for (;;) {
+        const std::uint32_t seq = wakeSeq_.load(std::memory_order_seq_cst);
+        if (headTotal_.load(std::memory_order_acquire) >= minHeadTotal) { ok = true; break; }
+        if (disposed_.load(std::memory_order_acquire)) break;
+        if (stop && stop->load(std::memory_order_seq_cst)) break; // waiters_ を増やした後に見るので起こし損ねは無い
+
+        nanoseconds left = nanoseconds::max();
+        if (!infinite) {
+            left = duration_cast<nanoseconds>(deadline - steady_clock::now());
+            if (left <= nanoseconds::zero()) break;
+        }
+        WaitWord(wakeSeq_, seq, left); // seq が進んでいればすぐ戻る
     }
+    waiters_.fetch_sub(1, std::memory_order_relaxed);
+    return ok;
+}
+
+bool LineStore::WaitForNextRows(i64 n, std::chrono::nanoseconds timeout) const noexcept {
+    return WaitForLines(headTotal_.load(std::memory_order_acquire) + n, timeout);
 }
 
 // ---- 窓取得（時刻つき）----
 bool LineStore::TryGetLatestWindowPtr(int winW, int winH, int x0,
                                       const void*& ptr, int& strideBytes, double& timeSecAtTop) const noexcept
 {
-    ptr = nullptr; strideBytes = RowBytes(); timeSecAtTop = std::numeric_limits<double>::quiet_NaN();
+    ptr = nullptr; strideBytes = rowPitch_; timeSecAtTop = std::numeric_limits<double>::quiet_NaN();
     if (winW <= 0 || winH <= 0 || winW > width_) return false;
 
     const i64 avail = storedLines_.load(std::memory_order_acquire);
@@ -135,52 +450,42 @@ bool LineStore::TryGetLatestWindowPtr(int winW, int winH, int x0,
 bool LineStore::TryGetWindowPtr(i64 startRow, int winW, int winH, int x0,
                                 const void*& ptr, int& strideBytes, double& timeSecAtTop) const noexcept
 {
-    ptr = nullptr; strideBytes = RowBytes(); timeSecAtTop = std::numeric_limits<double>::quiet_NaN();
-    if (startRow < 0 || winW <= 0 || winH <= 0 || winW > width_) return false;
-
-    const i64 avail = storedLines_.load(std::memory_order_acquire);
-    if (startRow + winH > avail) return false;
-
-    const int x0c = clamp(x0, 0, std::max(0, width_ - winW));
-
-    // ---- 非コミット（ウォームアップ中）は線形固定 ----
-    if (!committed_.load(std::memory_order_acquire)) {
-        const i64 physRow = startRow; // 0..warmupCount_
-        const i64 byteOffset = physRow * static_cast<i64>(RowBytes())
-                             + static_cast<i64>(x0c) * elemSizeBytes_;
-        ptr = static_cast<const void*>(buf_ + byteOffset);
+    return (this->*windowFn_)(startRow, winW, winH, x0, ptr, strideBytes, timeSecAtTop);
+}
 
-        timeSecAtTop = RowTimeSec(startRow);
-        return true;
+// ウォームアップ中（未 Commit）の窓：ウォームアップ領域のリング
+bool LineStore::WarmupWindowPtr(i64 startRow, int winH, int x0c,
+                                const void*& ptr, double& timeSecAtTop) const noexcept
+{
+    const int head    = warmupHead_.load(std::memory_order_acquire);
+    const i64 physRow = (head + startRow) % warmupMax_;
+
+    // リング末尾を跨ぐ窓：ウォームアップ領域がリング全体なら二重マップでそのまま続いている。
+    // それ以外は作業領域に並べて写す（Commit 後は回してあるので跨がない）
+    const std::uint8_t* base = buf_ + physRow * rowPitch_;
+    if (physRow + winH > warmupMax_ && !(memory_.Mirrored() && warmupMax_ == capacityLines_)) {
+        base = CopySeamWindow(physRow, warmupMax_, winH);
+        if (!base) return false;
     }
+    ptr = static_cast<const void*>(base + static_cast<i64>(x0c) * elemSizeBytes_);
 
-    // ---- コミット後：線形モード ----
-    if (!circular_) {
-        const i64 physRow = startRow; // 0..capacityLines_-1
-        const i64 byteOffset = physRow * static_cast<i64>(RowBytes())
-                             + static_cast<i64>(x0c) * elemSizeBytes_;
-        ptr = static_cast<const void*>(buf_ + byteOffset);
+    timeSecAtTop = RowTimeSec(startRow);
+    return true;
+}
 
-        timeSecAtTop = RowTimeSec(startRow);
-        return true;
+// 物理行 physRow から winH 行（ringRows 行で折り返す）を、呼び出したスレッドの作業領域に行間隔 rowPitch_ で並べる。
+// 次に同じスレッドが写すまで有効。確保できなければ nullptr
+const std::uint8_t* LineStore::CopySeamWindow(i64 physRow, i64 ringRows, int winH) const noexcept {
+    thread_local std::vector<std::uint8_t> seam;
+    try {
+        seam.resize(static_cast<size_t>(winH) * static_cast<size_t>(rowPitch_));
+    } catch (...) {
+        return nullptr;
     }
-
-    // ---- コミット後：リングモード ----
-    const i64 cap = capacityLines_;
-    if (cap <= 0) return false;
-
-    const i64 total = headTotal_.load(std::memory_order_acquire);
-    // 「バッファ内の論理行0」が表している絶対行インデックス
-    const i64 firstAbs = total - avail;         // ここから avail 行ぶんが生きている
-    const i64 rowAbs   = firstAbs + startRow;   // 求めたい行の絶対インデックス
-    const i64 physRow  = rowAbs % cap;          // 物理バッファ内の行
-
-    const i64 byteOffset = physRow * static_cast<i64>(RowBytes())
-                         + static_cast<i64>(x0c) * elemSizeBytes_;
-    ptr = static_cast<const void*>(buf_ + byteOffset);
-
-    timeSecAtTop = RowTimeSec(rowAbs);
-    return true;
+    const i64 first = std::min<i64>(winH, ringRows - physRow); // 末尾までの行数
+    std::memcpy(seam.data(), buf_ + physRow * rowPitch_, static_cast<size_t>(first * rowPitch_));
+    std::memcpy(seam.data() + first * rowPitch_, buf_, static_cast<size_t>((winH - first) * rowPitch_));
+    return seam.data();
 }
 
 // ---- 互換（時刻不要）----
@@ -198,11 +503,126 @@ bool LineStore::TryGetWindowPtr(i64 startRow, int winW, int winH, int x0,
     return TryGetWindowPtr(startRow, winW, winH, x0, ptr, strideBytes, dummy);
 }
 
+// ---- 読み出し（上書き検出つき）----
+LineStore::i64 LineStore::PhysRow(i64 rowAbs) const noexcept {
+    if (!circular_) return rowAbs;
+    return (capMask_ >= 0) ? (rowAbs & capMask_) : (rowAbs % capacityLines_);
+}
+
+// rowAbs 以降の行がまだ writer に取られていなければ true
+// 読み出し（コピー/使用）の「後」に呼ぶこと。acquire fence により、
+// 読んだデータに writer の書き込みが混ざっていれば claimIndex_ の更新も必ず見える
+bool LineStore::RowsIntact(i64 rowAbs) const noexcept {
+    if (!circular_) return true; // 線形モードは Commit 後に上書きしない
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const i64 claimed = claimIndex_.load(std::memory_order_relaxed);
+    return rowAbs >= claimed - capacityLines_;
+}
+
+ReadResult LineStore::TryCopyWindow(i64 rowAbs, int winW, int winH, int x0,
+                                    void* dst, int dstStrideBytes, double& timeSecAtTop) const noexcept
+{
+    timeSecAtTop = std::numeric_limits<double>::quiet_NaN();
+    if (!dst || rowAbs < 0 || winW <= 0 || winH <= 0 || winW > width_) return ReadResult::InvalidArg;
+    if (winH > capacityLines_ || dstStrideBytes < winW * elemSizeBytes_) return ReadResult::InvalidArg;
+    if (!committed_.load(std::memory_order_acquire)) return ReadResult::NotReady;
+
+    const i64 end = publishIndex_.load(std::memory_order_acquire);
+    if (rowAbs + winH > end) return ReadResult::NotReady;
+
+    const int x0c = clamp(x0, 0, std::max(0, width_ - winW));
+    const i64 xOff = static_cast<i64>(x0c) * elemSizeBytes_;
+    const size_t lineBytes = static_cast<size_t>(winW) * elemSizeBytes_;
+
+    auto* d    = static_cast<std::uint8_t*>(dst);
+    if (!RowsIntact(rowAbs)) // リングから押し出された行（コールド層があればそこから）
+        return CopyWindowCold(rowAbs, winH, xOff, lineBytes, d, dstStrideBytes, timeSecAtTop);
+    if (adopt_) { // ブロックを跨ぐ窓もつなげてコピー
+        if (!CopyRowsAdopted(rowAbs, winH, xOff, lineBytes, d, dstStrideBytes) || !RowsIntact(rowAbs))
+            return CountOverwritten();
+        timeSecAtTop = RowTimeSec(rowAbs);
+        return ReadResult::Ok;
+    }
+
+    i64   phys = PhysRow(rowAbs); // 1 行ずつ進めて末尾で折り返す（行ごとの除算をしない）
+    for (int y = 0; y < winH; ++y) {
+        const auto* s = buf_ + phys * rowPitch_ + xOff;
+        std::memcpy(d + static_cast<i64>(y) * dstStrideBytes, s, lineBytes);
+        if (++phys == capacityLines_) phys = 0;
+    }
+
+    // コピー中に一周されていたら破棄（コールド層があればそこから読み直す）
+    if (!RowsIntact(rowAbs))
+        return CopyWindowCold(rowAbs, winH, xOff, lineBytes, d, dstStrideBytes, timeSecAtTop);
+
+    timeSecAtTop = RowTimeSec(rowAbs);
+    return ReadResult::Ok;
+}
+
+ReadResult LineStore::TryBeginWindow(i64 rowAbs, int winW, int winH, int x0,
+                                     const void*& ptr, int& strideBytes, double& timeSecAtTop,
+                                     WindowTicket& ticket) const noexcept
+{
+    ptr = nullptr; strideBytes = rowPitch_; timeSecAtTop = std::numeric_limits<double>::quiet_NaN();
+    ticket = WindowTicket{};
+    if (rowAbs < 0 || winW <= 0 || winH <= 0 || winW > width_) return ReadResult::InvalidArg;
+    if (winH > capacityLines_) return ReadResult::InvalidArg;
+    if (!committed_.load(std::memory_order_acquire)) return ReadResult::NotReady;
+
+    const i64 end = publishIndex_.load(std::memory_order_acquire);
+    if (rowAbs + winH > end) return ReadResult::NotReady;
+    if (!RowsIntact(rowAbs)) return CountOverwritten();
+
+    const int x0c = clamp(x0, 0, std::max(0, width_ - winW));
+    if (adopt_) {
+        AdoptedBlock blk;
+        if (!FindAdopted(rowAbs, blk)) return CountOverwritten();
+        if (rowAbs + winH > blk.Start + blk.Rows) return ReadResult::Wrapped; // ブロックを跨ぐ窓は連続でない
+        ptr = static_cast<const void*>(blk.Data + (rowAbs - blk.Start) * blk.Stride
+                                       + static_cast<i64>(roiX_ + x0c) * elemSizeBytes_);
+        strideBytes = blk.Stride;
+    } else {
+        const i64 physRow = PhysRow(rowAbs);
+        if (!memory_.Mirrored() && physRow + winH > capacityLines_) return ReadResult::Wrapped;
+        ptr = static_cast<const void*>(buf_ + physRow * rowPitch_ + static_cast<i64>(x0c) * elemSizeBytes_);
+    }
+    timeSecAtTop = RowTimeSec(rowAbs);
+
+    ticket.RowAbs = rowAbs;
+    ticket.Rows   = winH;
+    return ReadResult::Ok;
+}
+
+bool LineStore::ValidateWindow(const WindowTicket& ticket) const noexcept {
+    if (ticket.RowAbs < 0 || ticket.Rows <= 0) return false;
+    if (RowsIntact(ticket.RowAbs)) return true;
+    CountOverwritten();
+    return false;
+}
+
 // ---- util ----
 double LineStore::NowUnixSec() {
     return ToUnixSec(std::chrono::system_clock::now());
 }
 
+std::int64_t LineStore::NowSteadyNs() noexcept {
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+double LineStore::NowSec() const noexcept {
+    return steadyTime_ ? NsToSec(NowSteadyNs()) : NowUnixSec();
+}
+
+// 基準からの差をとってから double にする（steady_clock なら 1 日ぶんでも ns 以下で表せる）
+double LineStore::NsToSec(std::int64_t ns) const noexcept {
+    return static_cast<double>(ns - timeOriginNs_) * 1e-9;
+}
+
+std::int64_t LineStore::SecToNs(double t) const noexcept {
+    return timeOriginNs_ + static_cast<std::int64_t>(std::llround(t * 1e9));
+}
+
 double LineStore::ToUnixSec(std::chrono::system_clock::time_point tp) {
     using namespace std::chrono;
     const auto epoch = time_point<system_clock>();
@@ -222,23 +642,35 @@ void LineStore::check_not_disposed() const {
 
 // ---- セグメント管理 ----
 void LineStore::AddSeg(i64 startLogical, double t) {
-    // writer 専用スレッドのみが push する前提なので vector 伸長は非同期アクセス無し
-    if (segs_.size() == segs_.capacity()) {
-        segs_.reserve(segs_.capacity() ? segs_.capacity() * 2 : 64);
+    // ファイルにも残す（SegCapacity 個のリング）。共有表でもファイルはストアごと
+    if (fileSegs_) {
+        fileSegs_[fileSegCount_ % fileHeader_->SegCapacity] = TimeSeg{ startLogical, t };
+        ++fileSegCount_;
     }
-    segs_.push_back(TimeSeg{ startLogical, t });
-    segCount_.store(static_cast<int>(segs_.size()), std::memory_order_release);
+    coldSegRow_.store(startLogical + commitBase_, std::memory_order_release);
+
+    if (!ownsSegs_) return; // 共有表は owner が追記する
+    segs_->Append(startLogical, t);
+}
+
+void LineStore::ShareTimeIndex(const LineStore& owner) {
+    segs_         = owner.segs_;
+    ownsSegs_     = false;
+    timeOriginNs_ = owner.timeOriginNs_; // 共有表の秒は owner の基準
 }
 
 // ---- 行の時刻 ----
 double LineStore::RowTimeSec(i64 rowAbs) const noexcept {
+    if (binParent_) return binParent_->RowTimeSec(rowAbs * binFactor_); // レベル：元の先頭行の時刻
+
     if (!committed_.load(std::memory_order_acquire)) {
         const int idx = static_cast<int>(rowAbs);
         if (0 <= idx && idx < warmupCount_) {
-            const double v = warmupTimes_[static_cast<size_t>(idx)];
+            const int    head = warmupHead_.load(std::memory_order_acquire);
+            const double v    = warmupTimes_[static_cast<size_t>((head + idx) % warmupMax_)];
             if (!std::isnan(v)) return v;
         }
-        return std::isnan(warmupLastTimeSec_) ? NowUnixSec() : warmupLastTimeSec_;
+        return std::isnan(warmupLastTimeSec_) ? NowSec() : warmupLastTimeSec_;
     }
 
     if (rowAbs < commitBase_) { // コミット前（ウォームアップ領域）
@@ -250,49 +682,104 @@ double LineStore::RowTimeSec(i64 rowAbs) const noexcept {
         return warmupLastTimeSec_;
     }
 
-    int n = segCount_.load(std::memory_order_acquire);
-    if (n == 0)
-        return std::isnan(warmupLastTimeSec_) ? NowUnixSec() : warmupLastTimeSec_;
+    // リングから押し出された行：時間セグメントはもう捨てているので、コールド層に残した行ごとの時刻を使う
+    if (!coldSlots_.empty() && rowAbs < OldestRowAbs()) {
+        if (const auto c = FindColdChunk(rowAbs)) return c->Times[static_cast<size_t>(rowAbs - c->Start)];
+    }
 
-    const i64 row = rowAbs - commitBase_; // 論理行
-    const auto* arr = segs_.data();
+    double v;
+    if (!segs_->TimeAt(rowAbs - commitBase_, v)) // 論理行で引く
+        return std::isnan(warmupLastTimeSec_) ? NowSec() : warmupLastTimeSec_;
+    return v;
+}
 
-    // max(Start <= row) を二分探索
-    int lo = 0, hi = n - 1, k = -1;
-    while (lo <= hi) {
-        const int mid = (lo + hi) >> 1;
-        const i64 s = arr[mid].Start;
-        if (s <= row) { k = mid; lo = mid + 1; }
-        else          { hi = mid - 1; }
+// ---- 時刻 → 行 ----
+LineStore::i64 LineStore::RowBoundForTime(double t, bool after) const noexcept {
+    if (binParent_) {
+        // レベルの行 r の時刻は元の行 r*f の時刻なので、元の境界 B に対して r*f < B の行が前
+        const i64 bound = binParent_->RowBoundForTime(t, after);
+        return std::clamp((bound + binFactor_ - 1) / binFactor_, OldestRowAbs(), EndRowAbs());
     }
 
-    if (k < 0) return arr[0].T;
-    if (k == n - 1) {
-        if (n >= 2) {
-            const auto& p1 = arr[n - 2]; const auto& p2 = arr[n - 1];
-            const i64   dx = p2.Start - p1.Start;
-            const double dt = p2.T - p1.T;
-            const double a = (dx > 0) ? (dt / static_cast<double>(dx)) : 0.0; // 秒/行
-            return p2.T + (row - p2.Start) * a; // 勾配外挿
+    i64 a = ColdOldestRowAbs(); // コールド層の行も探す（時刻は RowTimeSec がチャンクから引く）
+    i64 b = EndRowAbs();
+    if (a >= b) return b;
+
+    // 時刻が境界より前の行なら true（行方向に単調）
+    auto before = [&](i64 r) { const double v = RowTimeSec(r); return after ? v <= t : v < t; };
+
+    // セグメントの逆写像で見当をつけ、そこから指数探索 + 二分探索で詰める。
+    // 見当は補間の丸め程度しかずれないので、通常は数回の RowTimeSec で決まる
+    i64 guess = a;
+    if (segs_->RowAt(t, guess)) guess += commitBase_;
+    guess = std::clamp(guess, a, b);
+
+    if (guess < b && before(guess)) { // 境界は guess より後
+        a = guess + 1;
+        for (i64 step = 1; a < b; step <<= 1) {
+            const i64 p = std::min(b, guess + step);
+            if (p < b && before(p)) { a = p + 1; }
+            else                    { b = p; break; }
+        }
+    } else {                          // 境界は guess 以前
+        b = guess;
+        for (i64 step = 1; a < b; step <<= 1) {
+            const i64 p = std::max(a, guess - step);
+            if (before(p)) { a = p + 1; break; }
+            b = p;
         }
-        return arr[n - 1].T;
     }
+    while (a < b) {
+        const i64 m = a + (b - a) / 2;
+        if (before(m)) a = m + 1;
+        else           b = m;
+    }
+    return a;
+}
 
-    const auto& prev = arr[k];
-    const auto& next = arr[k + 1];
-    const i64 drow = next.Start - prev.Start;
-    if (drow <= 0) return prev.T;
-    const double slope = (next.T - prev.T) / static_cast<double>(drow);
-    return prev.T + (row - prev.Start) * slope;
+LineStore::i64 LineStore::FindRowAtTime(double t) const noexcept {
+    if (std::isnan(t) || !committed_.load(std::memory_order_acquire)) return -1;
+    const i64 r = RowBoundForTime(t, /*after=*/true) - 1;
+    return (r >= ColdOldestRowAbs()) ? r : -1;
+}
+
+LineStore::i64 LineStore::FindRowAtTimeNs(std::int64_t timeNs) const noexcept {
+    return FindRowAtTime(NsToSec(timeNs));
+}
+
+bool LineStore::GetRowRangeForTimesNs(std::int64_t t0Ns, std::int64_t t1Ns, i64& rowBegin, i64& rowEnd) const noexcept {
+    return GetRowRangeForTimes(NsToSec(t0Ns), NsToSec(t1Ns), rowBegin, rowEnd);
+}
+
+bool LineStore::GetRowRangeForTimes(double t0, double t1, i64& rowBegin, i64& rowEnd) const noexcept {
+    rowBegin = rowEnd = -1;
+    if (std::isnan(t0) || std::isnan(t1) || t0 > t1) return false;
+    if (!committed_.load(std::memory_order_acquire)) return false;
+
+    const i64 b = RowBoundForTime(t0, /*after=*/false);
+    const i64 e = RowBoundForTime(t1, /*after=*/true);
+    if (b >= e) return false;
+    rowBegin = b;
+    rowEnd   = e;
+    return true;
+}
+
+// ---- 1 行取り込み（ROI 切り出し + 形式変換）----
+void LineStore::CopyRow(const std::uint8_t* srcLine, std::uint8_t* dstLine) const noexcept {
+    if (!convert_) {
+        std::memcpy(dstLine, srcLine + static_cast<i64>(roiX_) * elemSizeBytes_, static_cast<size_t>(RowBytes()));
+        return;
+    }
+    convert_(srcLine, roiX_, width_, dstLine, sourceShift_);
 }
 
 // ---- ウォームアップ取り込み ----
 void LineStore::PushWarmup(const void* src, int rows, int srcStrideBytes, double timeSec) {
     const auto* sBase = static_cast<const std::uint8_t*>(src);
     auto*       dBase = buf_;
-    const int   roiByteOffset = roiX_ * elemSizeBytes_;
 
     int filled = warmupCount_; // 0..warmupMax_
+    int rowOff = 0;            // メタデータの何行目か（src と一緒に進める）
 
     // 1) 未充填ぶんを埋める
     if (filled < warmupMax_) {
@@ -300,18 +787,21 @@ void LineStore::PushWarmup(const void* src, int rows, int srcStrideBytes, double
         const int take = (rows < need) ? rows : need;
 
         for (int i = 0; i < take; ++i) {
-            const auto* srcLine = sBase + static_cast<i64>(i) * srcStrideBytes + roiByteOffset;
-            auto*       dstLine = dBase + static_cast<i64>(filled + i) * RowBytes();
-            std::memcpy(dstLine, srcLine, static_cast<size_t>(RowBytes()));
-            warmupTimes_[static_cast<size_t>(filled + i)] = timeSec; // per-line 時刻
+            const auto* srcLine = sBase + static_cast<i64>(i) * srcStrideBytes;
+            auto*       dstLine = dBase + static_cast<i64>(filled + i) * rowPitch_;
+            CopyRow(srcLine, dstLine);
+            if (IngestStageActive()) IngestStage(dstLine, 1);
+            SetWarmupTime(filled + i, timeSec); // per-line 時刻
+            if (meta_) PutWarmupMeta(filled + i, rowOff + i);
         }
 
         filled += take;
         warmupCount_ = filled;
         storedLines_.store(filled, std::memory_order_release);
 
-        rows  -= take;
-        sBase += static_cast<i64>(take) * srcStrideBytes;
+        rows   -= take;
+        sBase  += static_cast<i64>(take) * srcStrideBytes;
+        rowOff += take;
 
         if (rows <= 0) {
             warmupLastTimeSec_ = timeSec;
@@ -319,130 +809,61 @@ void LineStore::PushWarmup(const void* src, int rows, int srcStrideBytes, double
         }
     }
 
-    // 2) 既に満杯：末尾 rows を反映
+    // 2) 既に満杯：最古の行から上書きして先頭を進める（リング。保持行の移動は Commit 時の 1 回だけ）
     if (rows >= warmupMax_) {
         const auto* tail = sBase + static_cast<i64>(rows - warmupMax_) * srcStrideBytes;
         for (int i = 0; i < warmupMax_; ++i) {
-            const auto* srcLine = tail + static_cast<i64>(i) * srcStrideBytes + roiByteOffset;
-            auto*       dstLine = dBase + static_cast<i64>(i) * RowBytes();
-            std::memcpy(dstLine, srcLine, static_cast<size_t>(RowBytes()));
-            warmupTimes_[static_cast<size_t>(i)] = timeSec;
+            const auto* srcLine = tail + static_cast<i64>(i) * srcStrideBytes;
+            auto*       dstLine = dBase + static_cast<i64>(i) * rowPitch_;
+            CopyRow(srcLine, dstLine);
+            if (IngestStageActive()) IngestStage(dstLine, 1);
+            SetWarmupTime(i, timeSec);
+            if (meta_) PutWarmupMeta(i, rowOff + (rows - warmupMax_) + i);
         }
-        storedLines_.store(warmupMax_, std::memory_order_release);
+        warmupHead_.store(0, std::memory_order_release);
     }
     else { // 0 < rows < warmupMax_
-        const int shift = rows;
-        const int keep  = warmupMax_ - shift;
-
-        // 前詰め（画像・時刻）
-        for (int y = 0; y < keep; ++y) {
-            auto*       srcRow = dBase + static_cast<i64>(y + shift) * RowBytes();
-            auto*       dstRow = dBase + static_cast<i64>(y)        * RowBytes();
-            std::memcpy(dstRow, srcRow, static_cast<size_t>(RowBytes()));
-            warmupTimes_[static_cast<size_t>(y)] = warmupTimes_[static_cast<size_t>(y + shift)];
-        }
-        // 末尾 rows 行を追加（画像・時刻）
+        const int head = warmupHead_.load(std::memory_order_relaxed);
         for (int i = 0; i < rows; ++i) {
-            const auto* srcLine = sBase + static_cast<i64>(i) * srcStrideBytes + roiByteOffset;
-            auto*       dstLine = dBase + static_cast<i64>(keep + i) * RowBytes();
-            std::memcpy(dstLine, srcLine, static_cast<size_t>(RowBytes()));
-            warmupTimes_[static_cast<size_t>(keep + i)] = timeSec;
+            const int   phys    = (head + i) % warmupMax_;
+            const auto* srcLine = sBase + static_cast<i64>(i) * srcStrideBytes;
+            auto*       dstLine = dBase + static_cast<i64>(phys) * rowPitch_;
+            CopyRow(srcLine, dstLine);
+            if (IngestStageActive()) IngestStage(dstLine, 1);
+            SetWarmupTime(phys, timeSec);
+            if (meta_) PutWarmupMeta(phys, rowOff + i);
         }
-        storedLines_.store(warmupMax_, std::memory_order_release);
+        warmupHead_.store((head + rows) % warmupMax_, std::memory_order_release);
     }
+    storedLines_.store(warmupMax_, std::memory_order_release);
 
     warmupLastTimeSec_ = timeSec;
 }
 
-// ---- Commit 後：線形 / リング追記 ----
-bool LineStore::PushLinear(const void* src, int rows, int srcStrideBytes, double timeSec) {
-    const auto* sBase = static_cast<const std::uint8_t*>(src);
-    const int   roiByteOffset = roiX_ * elemSizeBytes_;
-
-    // ---- 線形モード（従来どおり）----
-    if (!circular_) {
-        const i64 remain = capacityLines_ - writeIndex_;
-        if (remain <= 0) return false;
-
-        const int can = static_cast<int>(std::min<i64>(remain, rows));
-
-        // セグメント登録（論理行で）
-        const i64 startAbs = writeIndex_;
-        const i64 startLog = startAbs - commitBase_;
-        AddSeg(startLog, timeSec);
-
-        auto* dBase = buf_ + writeIndex_ * RowBytes();
-
-        if (roiX_ == 0 && srcStrideBytes == RowBytes()) {
-            const i64 bytes = static_cast<i64>(can) * RowBytes();
-            std::memcpy(dBase, sBase, static_cast<size_t>(bytes));
-        } else {
-            for (int i = 0; i < can; ++i) {
-                const auto* srcLine = sBase + static_cast<i64>(i) * srcStrideBytes + roiByteOffset;
-                auto*       dstLine = dBase + static_cast<i64>(i) * RowBytes();
-                std::memcpy(dstLine, srcLine, static_cast<size_t>(RowBytes()));
-            }
-        }
-
-        headTotal_.fetch_add(can, std::memory_order_relaxed);
-        writeIndex_ += can;
-
-        const i64 newStored = writeIndex_;
-        if (newStored > storedLines_.load(std::memory_order_relaxed))
-            storedLines_.store(newStored, std::memory_order_release);
-
-        return can == rows;
-    }
-
-    // ---- リングモード ----
-    const i64 cap = capacityLines_;
-    if (cap <= 0) return false;
-    if (rows <= 0) return true;
-
-    // セグメント登録：この Push の先頭行の「絶対行」から timeSec を割り当てる
-    {
-        const i64 startAbs = writeIndex_;
-        const i64 startLog = startAbs - commitBase_;
-        AddSeg(startLog, timeSec);
-    }
-
-    int remaining = rows;
-    int rowOffset = 0;
-
-    while (remaining > 0) {
-        const i64 absIndex  = writeIndex_;
-        const i64 physIndex = absIndex % cap;
-        const int physIdx   = static_cast<int>(physIndex);
-
-        const i64 tillEnd   = cap - physIndex; // この位置からバッファ末尾まで
-        const int contiguous = static_cast<int>(std::min<i64>(tillEnd, remaining));
-
-        auto* dBase = buf_ + static_cast<i64>(physIdx) * RowBytes();
-        const auto* sChunk = sBase + static_cast<i64>(rowOffset) * srcStrideBytes;
-
-        if (roiX_ == 0 && srcStrideBytes == RowBytes()) {
-            const i64 bytes = static_cast<i64>(contiguous) * RowBytes();
-            std::memcpy(dBase, sChunk, static_cast<size_t>(bytes));
-        } else {
-            for (int i = 0; i < contiguous; ++i) {
-                const auto* srcLine = sChunk + static_cast<i64>(i) * srcStrideBytes + roiByteOffset;
-                auto*       dstLine = dBase + static_cast<i64>(i) * RowBytes();
-                std::memcpy(dstLine, srcLine, static_cast<size_t>(RowBytes()));
-            }
-        }
+// 時刻はデータと同じくマップしたファイルへ直接書く（状態欄の WarmupCount / WarmupHead は Push の最後に更新）
+void LineStore::SetWarmupTime(int phys, double timeSec) noexcept {
+    warmupTimes_[static_cast<size_t>(phys)] = timeSec;
+    if (fileWarmupTimes_) fileWarmupTimes_[phys] = timeSec;
+}
 
-        writeIndex_ += contiguous;   // 絶対行インデックス
-        remaining   -= contiguous;
-        rowOffset   += contiguous;
+// ---- Commit：ウォームアップのリングを先頭から並ぶように回す ----
+void LineStore::RotateWarmup() {
+    const int head = warmupHead_.load(std::memory_order_relaxed);
+    if (head == 0) return;
+
+    // 少ない側を退避して、残りを 1 回の memmove で詰める（std::rotate と同じ並び）
+    const i64 rb    = rowPitch_;
+    const int right = warmupMax_ - head; // 物理 [head, warmupMax_) = 新しい先頭
+    if (head <= right) {
+        std::vector<std::uint8_t> tmp(buf_, buf_ + head * rb);
+        std::memmove(buf_, buf_ + head * rb, static_cast<size_t>(right * rb));
+        std::memcpy(buf_ + right * rb, tmp.data(), tmp.size());
+    } else {
+        std::vector<std::uint8_t> tmp(buf_ + head * rb, buf_ + warmupMax_ * rb);
+        std::memmove(buf_ + right * rb, buf_, static_cast<size_t>(head * rb));
+        std::memcpy(buf_, tmp.data(), tmp.size());
     }
-
-    headTotal_.fetch_add(rows, std::memory_order_relaxed);
-
-    // 保持できる最大行数は cap 行まで
-    i64 prevStored = storedLines_.load(std::memory_order_relaxed);
-    i64 newStored  = prevStored + rows;
-    if (newStored > cap) newStored = cap;
-    storedLines_.store(newStored, std::memory_order_release);
-
-    return true; // リングなので常に全行受け入れ
-}
\ No newline at end of file
+    std::rotate(warmupTimes_.begin(), warmupTimes_.begin() + head, warmupTimes_.end());
+    if (meta_) RotateWarmupMeta(head);
+    warmupHead_.store(0, std::memory_order_release);
+}
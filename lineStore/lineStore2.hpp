@@ -1,14 +1,184 @@
 #pragma once
 
+#include <array>
 #include <cstdint>
 #include <vector>
 #include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
 
-enum class PixelType
+#include "app/utils/buffer.h"
+#include "copyPool.hpp"
+#include "lineMemory.hpp"
+#include "pixelFormat.hpp"
+#include "ingestKernels.hpp"
+#include "latencyHistogram.hpp"
+#include "lineStoreFile.hpp"
+#include "timeIndex.hpp"
+
+// 検証付き読み出しの結果
+enum class ReadResult
+{
+    Ok,
+    NotReady,     // 要求した行がまだ書き込まれていない（またはウォームアップ中）
+    Overwritten,  // 読み出し前/読み出し中に writer がリングを一周して上書きした
+    Wrapped,      // 窓がリング物理末尾を跨ぐ（ポインタ版のみ。TryCopyWindow を使う）
+    InvalidArg,
+};
+
+// 「使ってから検証」用のチケット（絶対行で保持）
+struct WindowTicket
+{
+    std::int64_t RowAbs = -1; // 窓先頭の絶対行
+    int          Rows   = 0;  // 窓の行数
+};
+
+// 読み出しカーソルが writer に追い越されたときの扱い
+enum class CursorPolicy
+{
+    SkipToLatest, // 最新の窓まで飛ばして続ける（失った行は LostRows に数える）
+    ReportGap,    // 生き残っている最古の行へ移し、1 度だけ Overwritten と欠落行数を返す
+    Backpressure, // writer に未読行を上書きさせない（リングでも入り切らない行は線形モードと同様に捨てて false）
+};
+
+// カーソルの状態（GetCursorInfo）
+struct CursorInfo
+{
+    std::int64_t Position = -1; // 次に読む絶対行
+    std::int64_t Lag      = 0;  // 書き込み済み末尾までの行数
+    std::int64_t Overruns = 0;  // 追い越された回数
+    std::int64_t LostRows = 0;  // 追い越しで読めずに飛ばした行数
+    CursorPolicy Policy   = CursorPolicy::SkipToLatest;
+};
+
+// 取り込みの健全性（Stats()）。ロック無しで取った写しで、欄ごとに読んだ時点が少しずれることがある
+struct LineStoreStats
+{
+    std::int64_t PushCalls           = 0; // PushBlock / PushBlockParallel / AdoptBlock の呼び出し数（ウォームアップ中も）
+    std::int64_t PushedRows          = 0; // 受け入れた行数（HeadTotal）
+    std::int64_t DroppedRows         = 0; // 受け入れずに捨てた行数（線形の容量切れ / Backpressure）
+    std::int64_t OverwrittenRows     = 0; // カーソルが読む前に上書きされた行数（閉じたカーソルの分、まだ気づいていない分も含む）
+    std::int64_t OverwrittenReads    = 0; // TryCopyWindow / TryBeginWindow / ValidateWindow が上書きで失敗した回数
+    std::int64_t DroppedTimeSegments = 0;
+    std::int64_t ColdRows            = 0; // コールド層に保持している行数（ColdCapacityLines。ホットと重なる分も含む）
+    std::int64_t ColdBytes           = 0; // その圧縮後のバイト数
+    std::int64_t ColdLostRows        = 0; // 圧縮が追いつかずにコールド層へ入れられなかった行数
+    int          NumaNode            = -1; // 画素バッファを置いた NUMA ノード（-1: 指定なし・最初の Push 前・置けなかった）
+    int          NumaBindError       = 0;  // ノードに置けなかったときの mbind の errno（EPERM / EINVAL など。通常の配置で続けている）
+    LatencySnapshot PushLatency;          // 1 回の Push にかかった時間（ns）
+};
+
+// PushBlock に添える行ごとのメタデータ（各 rows 個の配列。nullptr の欄は 0 を入れる）
+struct LineMetaBlock
+{
+    const std::int64_t*  Encoder      = nullptr; // エンコーダ値（ラップを展開した通し値。行方向に単調非減少の前提）
+    const std::uint32_t* TriggerId    = nullptr;
+    const std::uint32_t* FrameCounter = nullptr;
+};
+
+// ビニングレベルの画素値
+enum class BinMode
+{
+    Mean, // f×f 画素の平均（四捨五入）。保存形式は元と同じ
+    Sum,  // f×f 画素の和。保存形式は U16（元が U16 なら 65535 で飽和）
+};
+
+// 取り込み時の列ごとの統計
+enum class ColumnStatsMode
 {
-    U8,
-    U16,
+    Off,
+    Cumulative,  // ResetColumnStats からの全行の平均・分散（列ごとの u64 の和で正確）
+    Exponential, // 指数移動平均（重み ColumnStatsAlpha）。照明・温度のゆっくりした変化を追う
+                 // （平均は最初の行で初期化。分散は 1 行では分からないので 0 から立ち上がる）
+};
+
+// 列ごとの統計の写し（LineStore::ColumnStats）
+struct ColumnStatsSnapshot
+{
+    std::int64_t        Rows = 0; // 統計に入った行数（ResetColumnStats から）
+    std::vector<double> Mean;     // 列ごと（ROI の Width 個）
+    std::vector<double> Variance; // 母分散（Exponential は指数重みつき）
+};
+
+// 生成オプション（項目が増えたらここに足す）
+struct LineStoreOptions
+{
+    bool Circular = false; // true ならリングバッファ動作
+    bool Mirrored = false; // リング用：バッファを仮想メモリ上で二重マップし、リング末尾を跨ぐ窓も連続にする
+                           // （capacityLines はマップ粒度に合うよう切り上げられる）
+
+    // 行レイアウト：RowAlignBytes > 0 なら各行の先頭をこの境界（2 のべき乗。64 = キャッシュライン, 4096 = ページ）に
+    // そろえ、行の間隔（RowPitchBytes / 読み出しの strideBytes）を切り上げる。バッファ先頭も同じ境界になる
+    int  RowAlignBytes      = 0;
+    bool PowerOfTwoCapacity = false; // リング用：capacityLines を 2 のべき乗に切り上げ、物理行を & で求める
+
+    // 取り込み元の形式。Auto 以外なら PushBlock の src はこの形式で、
+    // ROI 切り出しと同時に保存形式（PixelType）へ変換する（Mono12p → U16 など）
+    SourceFormat Source      = SourceFormat::Auto;
+    int          SourceShift = 0; // 変換時の右シフト（例: Mono12p → U8 なら 4）
+
+    // ビニングレベル：BinLevels = 1..3 なら 2x / 4x / 8x を縦横とも f×f 画素にまとめたストアを Push のたびに作る。
+    // レベルの行 r は元の絶対行 [r*f, r*f+f)、列 c は ROI 内の列 [c*f, c*f+f)（割り切れない端は捨てる）。
+    // Commit 時にウォームアップ行から作り始める。容量は capacityLines / f、ファイルバックでもメモリ上に置く
+    int     BinLevels = 0;
+    BinMode Bin       = BinMode::Mean;
+
+    // 取り込みブロックの採用（ゼロコピー）：画素リングを持たず、AdoptBlock で受け取った CameraFrame を
+    // そのまま保持して読み出す（ブロックの記述子のリング）。capacityLines 行より古くなったブロックから解放する。
+    // Circular 必須。保存形式と同じ取り込み形式（変換・シフト無し）のみ。ウォームアップは無く生成時から Commit 済み。
+    // Mirrored / FilePath / BinLevels とは併用不可
+    bool AdoptFrames    = false;
+    int  AdoptMaxFrames = 1024; // 同時に保持するブロック数の上限（2 のべき乗に切り上げ。超えたら古いものから解放）
+
+    // PushBlockParallel のコピー・ワーカー数（0 ならワーカーを作らず、PushBlockParallel も PushBlock と同じ）。
+    // CopyThreadCpus が空でなければワーカー i を CPU CopyThreadCpus[i % size] に固定する
+    int              CopyThreads      = 0;
+    std::vector<int> CopyThreadCpus;
+    int              ParallelMinBytes = 256 * 1024; // 取り込む画素がこれ未満のブロックは分けない
+
+    // バッファの確保方法（ヒュージページ / mlock / プリフォールト / NUMA）。Mirrored は上の設定が優先。
+    // プリフォールトを非同期にした場合も Commit() が完了を待つので、Commit 後の PushBlock はページフォールトしない。
+    // NumaNode = NUMA_CURRENT なら最初の PushBlock / PushTap のスレッドのノードに置き、プリフォールトもそこから始める
+    LineMemoryOptions Memory;
+
+    // 時間セグメント（PushBlock ごとの時刻）を保持する最大数。リングでは押し出された行の分は捨てるので、
+    // 容量ぶんの行を覆えるだけあればよい。超えると古いものから捨て、その区間の時刻は外挿になる
+    std::int64_t TimeSegCapacity = 4096;
+
+    // コールド層（リング用）：Commit 後の行をバックグラウンドで圧縮して ColdCapacityLines 行まで残す。
+    // リングから押し出された行も TryCopyWindow で読める（その場で復元。ポインタ版の窓取得はホットの行だけ）。
+    // 圧縮は ColdChunkRows 行ずつ、書き込まれた直後に行うので、writer の Push は待たない。0 なら無効。
+    // 押し出された行の時刻（RowTimeSec / RowTimeNs / FindRowAtTime / GetRowRangeForTimes）はチャンクに残した行ごとの時刻。
+    // 圧縮が追いつかずに抜けたチャンクの行だけは残っているセグメントからの外挿になる
+    std::int64_t ColdCapacityLines = 0;
+    int          ColdChunkRows     = 256;
+
+    // 時刻の基準：true なら行の時刻を steady_clock（NTP で飛ばない）で扱い、double の秒は TimeOriginNs()（生成時の
+    // steady_clock）からの経過秒になる（1 日でも ns 以下の分解能）。false なら Unix 秒（system_clock）。
+    // どちらでも *Ns の API はこの基準の整数 ns（true: steady_clock の ns / false: Unix ns）で受け渡す。
+    // カメラのハードウェア時刻は ClockSync で steady_clock の ns にしてから PushBlockNs に渡す
+    bool SteadyTime = false;
+
+    // 行ごとのメタデータ（エンコーダ値・トリガ ID・フレーム番号）を画素行と同じ物理行に持つ（欄ごとの配列。1 行 16 バイト）。
+    // 画素と同じ seqlock で公開・上書き検出する。ファイルバックでもメタデータはメモリ上だけ。AdoptFrames とは併用不可
+    bool LineMeta = false;
+
+    // 列ごとの統計：Push で書いた行がキャッシュにあるうちに（行ごとに）列ごとの平均・分散を更新する（SIMD）。
+    // 統計は補正（SetFlatField）前の値で取るので、そのまま暗電流・明るさの基準にできる。
+    // 数えるのはバッファに書いた行だけ（容量を超える 1 回の Push で書かずに飛ばした行は入らない）。AdoptFrames とは併用不可
+    ColumnStatsMode ColumnStats      = ColumnStatsMode::Off;
+    double          ColumnStatsAlpha = 1.0 / 1024; // Exponential の重み（0 < alpha <= 1）
+
+    // ファイルバック：画素バッファをこのファイルのメモリマップにする（容量は RAM でなくディスクで決まる）。
+    // 構成・Commit 基準・時間セグメントも同じファイルに置くので、LineStore::OpenReadOnly で再度開ける
+    std::string  FilePath;
+    int          FileFlushIntervalMs = 100;     // バックグラウンド書き戻しの間隔（0 なら Dispose 時のみ）
+    std::int64_t FileSegCapacity     = 1 << 16; // ファイルに残す時間セグメントの最大数（超えたら古いものから上書き）
 };
 
 class LineStore
@@ -19,9 +189,13 @@ public:
     LineStore(int srcWidth, int roiX, int roiW,
               i64 capacityLines, int warmupMax, PixelType pt,
               bool circular = false);
+    LineStore(int srcWidth, int roiX, int roiW,
+              i64 capacityLines, int warmupMax, PixelType pt,
+              const LineStoreOptions& opt);
     ~LineStore();
 
     void Dispose() noexcept;
+    bool IsDisposed() const noexcept;
 
     // ---- 構成情報 ----
     int  SourceWidth()    const noexcept;
@@ -31,13 +205,28 @@ public:
     int  WarmupMax()      const noexcept;
     PixelType PixelT()    const noexcept;
     int  ElemSizeBytes()  const noexcept;
-    int  RowBytes()       const noexcept;
-    int  SourceRowBytes() const noexcept;
+    int  RowBytes()       const noexcept; // 1 行の画素バイト数（Width * ElemSizeBytes）
+    int  RowPitchBytes()  const noexcept; // バッファ内の行間隔（RowAlignBytes で切り上げ。読み出しの strideBytes）
+    int  SourceRowBytes() const noexcept; // 取り込み元 1 行のバイト数（パック形式を考慮）
+    SourceFormat SourceT() const noexcept;
+    bool Mirrored()       const noexcept;
+    const LineMemory& Memory() const noexcept; // 確保結果（HugePagesActive / Locked / PrefaultDone）
 
     // ---- 状態 ----
-    i64 HeadTotal()   const noexcept; // これまでに Push した総行数
+    i64 HeadTotal()   const noexcept; // これまでに Push した総行数（この値に入った行は読み出せる）
     i64 StoredLines() const noexcept; // 現在バッファ内に存在する行数
 
+    // ---- 状態（絶対行：Commit 時のウォームアップ先頭 = 0）----
+    i64 OldestRowAbs() const noexcept; // 読み出し可能な最古の絶対行
+    i64 EndRowAbs()    const noexcept; // 書き込み完了済み末尾の絶対行（この行は含まない）
+
+    i64 DroppedRows()         const noexcept; // 受け入れずに捨てた行数（線形の容量切れ / Backpressure）
+    i64 TimeSegments()        const noexcept; // 保持している時間セグメント数
+    i64 DroppedTimeSegments() const noexcept; // TimeSegCapacity を超えて捨てた時間セグメント数
+
+    // 行の欠落・上書き・Push の所要時間。どのスレッドからでも呼べる（writer を止めない）
+    LineStoreStats Stats() const noexcept;
+
     // ---- Commit（ウォームアップ完了）----
     void Commit();
 
@@ -48,7 +237,76 @@ public:
     bool PushBlock(const void* src, int rows, int srcStrideBytes,
                    double acquiredUtcSec);
 
+    // 時刻を整数 ns（SteadyTime なら steady_clock の ns、それ以外は Unix ns）で渡す。
+    // 前回の PushBlockNs より前の時刻は前回の時刻に詰める（ClockSync の直線の更新で行の時刻が戻らないように）
+    bool PushBlockNs(const void* src, int rows, int srcStrideBytes, std::int64_t timeNs);
+
+    // 大きなブロックの取り込み（ROI 切り出し・形式変換）を CopyThreads のワーカーと分担する
+    // （行が十分あれば行の範囲で、少なければ列の帯で分ける）。公開（publishIndex_ / storedLines_ / headTotal_）は
+    // 全員のコピーが終わってから writer が行うので、reader から見た順序・上書き検出は PushBlock と同じ
+    bool PushBlockParallel(const void* src, int rows, int srcStrideBytes);
+    bool PushBlockParallel(const void* src, int rows, int srcStrideBytes, double acquiredUtcSec);
+
+    // ---- 取り込みブロックの採用（AdoptFrames。lineStoreAdopt.cpp）----
+    // frame の先頭から rows 行（行間隔 srcStrideBytes、取り込み元の全幅）をコピーせずに保持する。
+    // frame は保持期間を過ぎたとき・Dispose 時に解放される（ドライバへ返る）。
+    // 解放後の領域を読んだ reader は TryCopyWindow / ValidateWindow で Overwritten になるので、
+    // frame の領域は解放後もマップされたままのもの（ドライバのバッファプール）であること。
+    // 窓がブロック 1 つに収まれば TryGetWindowPtr / TryBeginWindow がブロック内を指し（strideBytes はそのブロックの行間隔）、
+    // 跨ぐ窓は TryCopyWindow でつなげてコピーする。Backpressure で入り切らなければ frame ごと解放して false
+    bool AdoptBlock(CameraFrame&& frame, int rows, int srcStrideBytes);
+    bool AdoptBlock(CameraFrame&& frame, int rows, int srcStrideBytes, double acquiredUtcSec);
+
+    // ---- 分割書き込み（マルチタップ / 複数カメラ。lineStoreTaps.cpp）----
+    // 1 行を列の範囲ごとに別々の writer スレッドが書く。RegisterTap で ROI 内の列 [x0, x0 + width) を受け持つ tap を登録し、
+    // 各 tap は PushTap で自分の範囲だけの行（src は範囲の左端から。取り込み元の形式）を渡す。
+    // 各 tap の k 行目は同じ絶対行になり、全 tap が書き終えた行から reader に公開する（publishIndex_ / storedLines_）。
+    // 範囲は重ならずに ROI 全体を覆うこと（最初の PushTap で確かめ、以降は登録できない）。Commit 後のみ。
+    // tap を登録したら PushBlock は使えない。行の時刻は tap 0 の PushTap のもの（他の tap の timeSec は使わない）。
+    // リングで 1 つの tap が他の tap より容量以上先に進むと、遅い側の行は公開されても Overwritten になる。
+    // Backpressure カーソル・ColumnStats・フラットフィールド・BinLevels・LineMeta・AdoptFrames とは併用不可
+    int  RegisterTap(int x0, int width);
+    // 線形モードで容量を超えた行は捨てて false（どの tap でも同じ行が捨てられる）
+    bool PushTap(int tap, const void* src, int rows, int srcStrideBytes, double timeSec);
+    int  TapCount() const noexcept;
+
+    // ---- 行ごとのメタデータ（LineMeta。lineStoreMeta.cpp）----
+    // PushBlock と同じ。meta の各配列の先頭 rows 個を各行に添える（LineMeta 無しなら例外）。
+    // メタデータ無しの PushBlock で入れた行は 0 になる
+    bool PushBlock(const void* src, int rows, int srcStrideBytes, double acquiredUtcSec, const LineMetaBlock& meta);
+
+    // 絶対行 rowAbs から rows 行のメタデータをコピーし、上書きが無かったことを検証する（TryCopyWindow と同じ）。
+    // 出力先は nullptr なら読まない。Commit 後のみ
+    ReadResult TryCopyLineMeta(i64 rowAbs, int rows, std::int64_t* encoder,
+                               std::uint32_t* triggerId, std::uint32_t* frameCounter) const noexcept;
+
+    // ---- エンコーダ値 → 行（LineMeta・Commit 後のみ）----
+    // 行のエンコーダ値は単調非減少の前提（FindRowAtTime と同じ）。
+    // エンコーダ値 <= pos の最も新しい絶対行。最古の行より前・未 Commit なら -1
+    i64    FindRowAtEncoder(i64 pos) const noexcept;
+    // pos の位置を前後の行のエンコーダ値で線形補間した行（小数）。保持している範囲外なら NaN
+    double RowAtEncoder(double pos) const noexcept;
+    // pos0 <= エンコーダ値 <= pos1 の行を絶対行の半開区間 [rowBegin, rowEnd) で返す。該当行が無ければ false
+    bool   GetRowRangeForEncoder(i64 pos0, i64 pos1, i64& rowBegin, i64& rowEnd) const noexcept;
+
+    // ---- 列ごとの統計 / フラットフィールド（lineStoreColumns.cpp）----
+    // 統計の写し（ColumnStats = Off なら例外）。どのスレッドからでも呼べ、writer を待たせない
+    // （writer が更新し続けて写せなければ、次の Push の区切りで writer が写したものを待つ）
+    ColumnStatsSnapshot ColumnStats() const;
+    // 次の Push から数え直す（それまでの ColumnStats は Rows = 0）
+    void                ResetColumnStats();
+
+    // 取り込み時の補正 row[x] = (row[x] - dark[x]) * gain[x]（最近接に丸め、保存形式の範囲に飽和）を設定する。
+    // 表は Width 個ずつ。どのスレッドからでも呼べ、次の Push から効く（1 回の Push の中で表が混ざることは無い）。
+    // ウォームアップ中の行も補正する。AdoptFrames・読み取り専用・ビニングレベルでは例外
+    void SetFlatField(const std::vector<float>& dark, const std::vector<float>& gain);
+    // 暗・明の基準（ColumnStats の Mean など）から gain = target / (bright - dark) で設定する（差が 0 以下の列は gain = 0）
+    void SetFlatFieldFromReferences(const std::vector<double>& dark, const std::vector<double>& bright, double target);
+    void ClearFlatField();
+
     // ---- 読み出し（時刻つき）----
+    // リングの継ぎ目を跨ぐ窓（ウォームアップ中、Commit 後は Mirrored でないリングの末尾）は、
+    // 呼び出したスレッドの作業領域に写したものを指す（同じスレッドが次に窓を取るまで有効。strideBytes は同じ）
     bool TryGetLatestWindowPtr(int winW, int winH, int x0,
                                const void*& ptr, int& strideBytes, double& timeSecAtTop) const noexcept;
 
@@ -62,25 +320,317 @@ public:
     bool TryGetWindowPtr(i64 startRow, int winW, int winH, int x0,
                          const void*& ptr, int& strideBytes) const noexcept;
 
+    // ---- 読み出し（上書き検出つき・Commit 後のみ）----
+    // rowAbs は絶対行。リングモードで writer が追い越した場合は Overwritten を返す
+    // （コールド層があれば、押し出された行はそこから復元して Ok）。
+    // コピー版：dst へ winH 行をコピーし、コピー完了後に上書きが無かったことを検証する
+    ReadResult TryCopyWindow(i64 rowAbs, int winW, int winH, int x0,
+                             void* dst, int dstStrideBytes, double& timeSecAtTop) const noexcept;
+
+    // ゼロコピー版：ポインタとチケットを返す。使い終わったら ValidateWindow で検証すること
+    ReadResult TryBeginWindow(i64 rowAbs, int winW, int winH, int x0,
+                              const void*& ptr, int& strideBytes, double& timeSecAtTop,
+                              WindowTicket& ticket) const noexcept;
+
+    // チケットの行がまだ上書きされていなければ true
+    bool ValidateWindow(const WindowTicket& ticket) const noexcept;
+
+    // コールド層で読める最古の絶対行（コールド層が無い・まだ空なら OldestRowAbs()）
+    i64 ColdOldestRowAbs() const noexcept;
+
+    // ---- 新しい行の待機（ポーリング不要）----
+    // HeadTotal() >= minHeadTotal になるまで眠って待つ（writer の Push で起こされる）。
+    // 満たせば true、タイムアウト・Dispose なら false。timeout 既定は無期限
+    bool WaitForLines(i64 minHeadTotal,
+                      std::chrono::nanoseconds timeout = std::chrono::nanoseconds::max()) const noexcept;
+
+    // 上と同じ。*stop が true になっても false で戻る（立てた側が NotifyWaiters() で起こすこと）
+    bool WaitForLines(i64 minHeadTotal, std::chrono::nanoseconds timeout,
+                      const std::atomic<bool>* stop) const noexcept;
+
+    // 待っている reader をすべて起こす（自前の停止フラグを立てた後に呼ぶ）
+    void NotifyWaiters() noexcept;
+
+    // 呼び出し時点の HeadTotal() から n 行増えるまで待つ
+    bool WaitForNextRows(i64 n,
+                         std::chrono::nanoseconds timeout = std::chrono::nanoseconds::max()) const noexcept;
+
+    // ---- 読み出しカーソル（lineStoreCursor.cpp）----
+    // 1 カーソル = 1 reader スレッド。Open/Close は任意のスレッドから呼べる
+    static constexpr int MAX_CURSORS = 16;
+
+    // startRowAbs < 0 なら現在の末尾から読む。空きスロットが無ければ例外
+    int  OpenCursor(CursorPolicy policy, i64 startRowAbs = -1);
+    void CloseCursor(int id) noexcept;
+
+    // カーソル位置から winH 行の窓が読めれば Ok と rowAbs（TryCopyWindow / TryBeginWindow に渡す）。
+    // 追い越されていればポリシーに従って位置を直す（ReportGap は Overwritten と gapRows を 1 度返す）。
+    // 読み出し後に Overwritten になった場合も、次の呼び出しで同じように直る
+    ReadResult CursorAcquire(int id, int winH, i64& rowAbs, i64& gapRows) noexcept;
+
+    // 読み終えた rows 行だけ進める（Backpressure ではここで writer が上書きできるようになる）
+    void CursorAdvance(int id, i64 rows);
+
+    // カーソル位置から winH 行が書き込まれるまで待つ（WaitForLines と同じ）
+    bool CursorWait(int id, int winH,
+                    std::chrono::nanoseconds timeout = std::chrono::nanoseconds::max()) const noexcept;
+
+    CursorInfo GetCursorInfo(int id) const;
+
+    // ---- 時刻の基準 ----
+    bool         SteadyTime()   const noexcept;
+    std::int64_t TimeOriginNs() const noexcept; // double の秒 = (ns - TimeOriginNs()) * 1e-9（Unix 秒なら 0）
+
+    // 絶対行 rowAbs の時刻（ns）。保持している範囲外・未 Commit なら false
+    bool RowTimeNs(i64 rowAbs, std::int64_t& timeNs) const noexcept;
+    // 同じく秒（TryGetWindowPtr の timeSecAtTop と同じ値）
+    bool RowTimeSec(i64 rowAbs, double& timeSec) const noexcept;
+
+    // ---- 時刻 → 行（Commit 後のみ）----
+    // 行の時刻は TryGetWindowPtr が返すものと同じ（セグメント間の線形補間）。時刻は単調非減少の前提。
+    // 時刻 <= t の最も新しい絶対行を返す。最古の行（コールド層があればその最古）より前・未 Commit なら -1
+    i64  FindRowAtTime(double t) const noexcept;
+
+    // t0 <= 時刻 <= t1 の行を絶対行の半開区間 [rowBegin, rowEnd) で返す。該当行が無ければ false
+    bool GetRowRangeForTimes(double t0, double t1, i64& rowBegin, i64& rowEnd) const noexcept;
+
+    // 上の 2 つを整数 ns で（PushBlockNs と同じ基準）
+    i64  FindRowAtTimeNs(std::int64_t timeNs) const noexcept;
+    bool GetRowRangeForTimesNs(std::int64_t t0Ns, std::int64_t t1Ns, i64& rowBegin, i64& rowEnd) const noexcept;
+
+    // ---- ビニングレベル（lineStoreBinning.cpp）----
+    // factor = 2 / 4 / 8 のレベル。BinLevels で作っていなければ nullptr。
+    // レベルは通常の LineStore と同じように読める（窓・検証付き読み出し・待機・カーソル・時刻 → 行）。
+    // 行の時刻は元の先頭行（r*f）の時刻。レベルへの PushBlock は例外（書き込むのは元のストアだけ）
+    LineStore*       Level(int factor) noexcept;
+    const LineStore* Level(int factor) const noexcept;
+    int              BinFactor() const noexcept; // レベルなら元の何倍か（元のストアは 1）
+
+    // ---- ファイルバック ----
+    // FilePath で書いたファイルを読み取り専用で開く（画素はゼロコピーで TryGetWindowPtr から読める）
+    static std::unique_ptr<LineStore> OpenReadOnly(const std::string& path);
+    bool ReadOnly() const noexcept;
+
+    // 再起動後の再開：FilePath のファイル（または SaveSnapshot の出力）をそのまま読み書きでマップし直し、
+    // ウォームアップ・Commit 基準・時間セグメント・リングを復元して続きから Push できるようにする（画素はコピーしない）。
+    // 構成（幅・容量・形式など）はファイルのもの。opt からはそれ以外（Memory.Lock / CopyThreads / FileFlushIntervalMs /
+    // ColdCapacityLines など）を使う。BinLevels / LineMeta はファイルに無いので使えない。
+    // Push の途中でプロセスが止まったファイルも開ける（書きかけの行と、それが潰した古い行は読めない扱い）。
+    // 同じファイルを書いている他のプロセスがいないこと
+    static std::unique_ptr<LineStore> OpenResume(const std::string& path, const LineStoreOptions& opt = {});
+
+    // 今の状態を FilePath と同じ形式のファイルに書き出す（OpenResume / OpenReadOnly で開ける）。
+    // ヒープのストアを終了時に残す用。一時ファイルをディスクまで書き切ってから置き換えるので、途中で止まっても（電源断でも）
+    // 前のファイルは残る。writer スレッドから（または Push が止まっている間に）呼ぶこと。
+    // ビニングのレベル・LineMeta・コールド層・列統計は含まない
+    void SaveSnapshot(const std::string& path) const;
+
     // ---- util ----
     static double NowUnixSec();
     static double ToUnixSec(std::chrono::system_clock::time_point tp);
+    static std::int64_t NowSteadyNs() noexcept;
 
 private:
-    struct TimeSeg
-    {
-        i64   Start; // 論理行インデックス
-        double T;    // Unix sec
-    };
+    friend class LineStoreGroup;
+    template <class PixelT, bool Circular, bool Pow2> friend class BasicLineStore;
 
     static int  clamp(int v, int lo, int hi) noexcept;
     void        check_not_disposed() const;
 
+    double NowSec() const noexcept;                 // 時刻の基準での現在時刻（秒）
+    double NsToSec(std::int64_t ns) const noexcept;
+    std::int64_t SecToNs(double t) const noexcept;
     void   AddSeg(i64 startLogical, double t);
     double RowTimeSec(i64 rowAbs) const noexcept;
+    // [OldestRowAbs, EndRowAbs] のうち、時刻が t 以上（after なら t 超）になる最初の絶対行
+    i64    RowBoundForTime(double t, bool after) const noexcept;
+
+    i64    PhysRow(i64 rowAbs) const noexcept;
+    bool   RowsIntact(i64 rowAbs) const noexcept;
 
+    void   CopyRow(const std::uint8_t* srcLine, std::uint8_t* dstLine) const noexcept;
+
+    // newSeg=false: 同じブロックの続き（分割して Push するとき、時間セグメントを切らない）
+    bool   PushRows(const void* src, int rows, int srcStrideBytes, double timeSec, bool newSeg);
     void   PushWarmup(const void* src, int rows, int srcStrideBytes, double timeSec);
-    bool   PushLinear(const void* src, int rows, int srcStrideBytes, double timeSec);
+    void   SetWarmupTime(int phys, double timeSec) noexcept; // ファイルバックならファイルの時刻領域にも
+    bool   WarmupWindowPtr(i64 startRow, int winH, int x0c, const void*& ptr, double& timeSecAtTop) const noexcept;
+    const std::uint8_t* CopySeamWindow(i64 physRow, i64 ringRows, int winH) const noexcept;
+    void   RotateWarmup();
+
+    // ---- 統計 ----
+    // Push の入口に置く：抜けるとき（例外でも）所要時間を記録する
+    struct PushTimer
+    {
+        LineStore&                            Self;
+        std::chrono::steady_clock::time_point T0 = std::chrono::steady_clock::now();
+        ~PushTimer() { Self.RecordPush(T0); }
+    };
+    void       RecordPush(std::chrono::steady_clock::time_point t0) noexcept;
+    void       RecordPushNs(std::uint64_t ns) noexcept; // writer 専用
+    ReadResult CountOverwritten() const noexcept;       // 上書きで読めなかった 1 回を数えて Overwritten を返す
+
+    // ---- 形式・モード別の特殊化（lineStoreSpecialized.cpp）----
+    // 要素サイズ・線形/リング・容量が 2 のべき乗か、をコンパイル時に固定した Push / 窓取得。
+    // LineStore は生成時に 1 組を選んで関数ポインタで呼び、BasicLineStore は直接呼ぶ。
+    // Commit 後の Push は付加機能が何も無ければ（PlainPush）、それらの分岐を持たない Plain = true の版を通る
+    template <class PixelT, bool Circular, bool Pow2>
+    bool   PushRowsT(const void* src, int rows, int srcStrideBytes, double timeSec, bool newSeg);
+    template <class PixelT, bool Circular, bool Pow2, bool Plain>
+    bool   PushCommittedT(const std::uint8_t* src, int rows, int srcStrideBytes, double timeSec, bool newSeg);
+    // 統計・補正・ビニング・メタデータ・ファイル・形式変換・分担コピー・Backpressure カーソルのどれも無い（writer）
+    bool   PlainPush() const noexcept;
+    template <class PixelT, bool Plain = false>
+    void   CopyRowsT(const std::uint8_t* src, int srcStrideBytes, std::uint8_t* dst, int rows) const noexcept;
+    // ROI 内の列 [x0, x0 + n) だけを取り込む（PushBlockParallel の列の帯）
+    template <class PixelT>
+    void   CopySpanT(const std::uint8_t* src, int srcStrideBytes, std::uint8_t* dst, int rows, int x0, int n) const noexcept;
+    template <class PixelT, bool Circular, bool Pow2>
+    bool   TryGetWindowPtrT(i64 startRow, int winW, int winH, int x0,
+                            const void*& ptr, int& strideBytes, double& timeSecAtTop) const noexcept;
+    void   SelectSpecialized();
+
+    using PushFn   = bool (LineStore::*)(const void*, int, int, double, bool);
+    using WindowFn = bool (LineStore::*)(i64, int, int, int, const void*&, int&, double&) const noexcept;
+
+    // ---- 取り込みブロックの採用（lineStoreAdopt.cpp）----
+    // 記述子は reader もロック無しで読む。writer は記述子のスロットを再利用する前に adoptTail_ を進めるので、
+    // reader は読み終えた後に adoptTail_ を見直して読んだスロットが潰されていないことを確かめる（TimeIndex と同じ）
+    struct AdoptedBlock
+    {
+        const std::uint8_t* Data;   // ROI 前の先頭行
+        int                 Stride; // 行間隔
+        i64                 Start;  // 先頭の絶対行
+        int                 Rows;
+    };
+
+    void   InitAdopt(const LineStoreOptions& opt);
+    bool   FindAdopted(i64 rowAbs, AdoptedBlock& blk) const noexcept;
+    void   ReleaseAdopted(i64 endAbs);     // endAbs まで書いたとして保持期間外のブロックを解放（writer）
+    void   ReleaseAllAdopted() noexcept;
+    bool   PushRowsAdopted(const void* src, int rows, int srcStrideBytes, double timeSec, bool newSeg);
+    bool   TryGetWindowPtrAdopted(i64 startRow, int winW, int winH, int x0,
+                                  const void*& ptr, int& strideBytes, double& timeSecAtTop) const noexcept;
+    // ブロックを跨いでつなげてコピー（解放済みのブロックに当たれば false）
+    bool   CopyRowsAdopted(i64 rowAbs, int winH, i64 xOff, size_t lineBytes,
+                           std::uint8_t* dst, int dstStrideBytes) const noexcept;
+
+    // ---- PushBlockParallel の分担（CopyPool::Run に渡す）----
+    struct CopyJob
+    {
+        const LineStore*    Self;
+        const std::uint8_t* Src;
+        int                 SrcStride;
+        std::uint8_t*       Dst;
+        int                 Rows;
+        bool                ByRows; // true: 行の範囲 / false: 列の帯
+        int                 Step;   // 1 分担の行数 / 画素数
+    };
+    template <class PixelT>
+    static void CopyPartT(void* job, int part) noexcept;
+
+    // 今 Push して上書き・容量切れにならない行数（Backpressure カーソルと線形の残り容量）。writer 専用
+    i64    WritableRows() const noexcept;
+
+    // owner の時間セグメント表を共有し、自分では追記しない
+    void   ShareTimeIndex(const LineStore& owner);
+
+    // ---- 読み出しカーソル ----
+    struct CursorSlot
+    {
+        enum : int { Free, Opening, Active };
+        std::atomic<int>  State{Free};
+        CursorPolicy      Policy = CursorPolicy::SkipToLatest;
+        std::atomic<i64>  Pos{0};      // reader が更新、writer が Backpressure で読む
+        std::atomic<i64>  Overruns{0};
+        std::atomic<i64>  LostRows{0};
+    };
+
+    CursorSlot&       Cursor(int id);
+    const CursorSlot& Cursor(int id) const;
+
+    // ---- ビニングレベル（lineStoreBinning.cpp）----
+    struct BinLevel
+    {
+        int                        Factor;  // 元の何倍か（2, 4, 8）
+        int                        Width;   // 出力画素数
+        int                        Shift;   // Mean: 和を割る右シフト（Sum は 0）
+        BinPairSumFn               PairSum; // 入力 1 行（元の画素 / 前段の和）の横 2 画素和を Acc に足す
+        BinStoreFn                 Store;
+        std::vector<std::uint32_t> Acc;     // 縦 2 行ぶんの和（f×f 画素の和）
+        int                        Phase;   // Acc に足した入力行数
+        std::vector<std::uint8_t>  Stage;   // まだ Push していない出力行（STAGE_ROWS 行まで）
+        int                        Staged;
+        std::unique_ptr<LineStore> Rows;
+    };
+    static constexpr int BIN_STAGE_ROWS = 32;
+
+    void   CreateLevels(const LineStoreOptions& opt);
+    void   CommitLevels();
+    void   FeedLevels(i64 fromAbs, i64 endAbs); // 公開済みの絶対行 [fromAbs, endAbs) をレベルへ
+    void   BinRow(size_t k, const void* in);
+    void   FlushLevel(BinLevel& lv);
+
+    // ---- 行ごとのメタデータ（lineStoreMeta.cpp）----
+    void   PutMeta(i64 fromAbs, int srcRow, int rows) noexcept;   // Commit 後：絶対行 fromAbs から（リングは折り返す）
+    void   PutWarmupMeta(i64 phys, int srcRow) noexcept;          // ウォームアップ：物理行 phys へ 1 行
+    void   RotateWarmupMeta(int head);
+    // [OldestRowAbs, EndRowAbs] のうち、エンコーダ値が pos 以上（after なら pos 超）になる最初の絶対行
+    i64    RowBoundForEncoder(i64 pos, bool after) const noexcept;
+    bool   EncoderAt(i64 rowAbs, i64& v) const noexcept;          // 読んだ後に上書きされていなければ true
+
+    // ---- 列ごとの統計 / フラットフィールド（lineStoreColumns.cpp）----
+    struct FlatFieldTable
+    {
+        std::vector<float> Dark;
+        std::vector<float> Gain;
+    };
+
+    void   CreateColumns(const LineStoreOptions& opt);
+    void   PublishFlatField(std::unique_ptr<const FlatFieldTable> table);
+    void   TakeFlatField() noexcept;                    // writer：Push の先頭で差し替えを受け取る
+    bool   IngestStageActive() const noexcept { return colStats_ != ColumnStatsMode::Off || flat_; }
+    void   IngestStage(std::uint8_t* dst, int rows);   // writer：書いた rows 行（rowPitch_ 間隔）の統計・補正
+
+    // ---- 分割書き込み（lineStoreTaps.cpp）----
+    struct TapSlot
+    {
+        int              X0;
+        int              Width;
+        std::atomic<i64> Done{0}; // この tap が書き終えた末尾の絶対行（書くのはこの tap だけ）
+    };
+
+    void   SealTaps();
+    void   CopyTapRows(const TapSlot& t, const std::uint8_t* src, int srcStrideBytes, i64 fromAbs, int rows) const noexcept;
+    void   PublishTaps();              // 全 tap が書き終えた行まで公開する
+
+    // ---- コールド層（lineStoreCold.cpp）----
+    struct ColdChunk
+    {
+        i64                       Start;      // 先頭の絶対行（ColdChunkRows の倍数）
+        std::vector<double>       Times;      // 行ごとの時刻（押し出された後は時間セグメントが無いので）
+        std::vector<std::uint32_t> Offsets;   // 行ごとの Data 内の位置（行数 + 1 個）
+        std::vector<std::uint8_t> Data;
+    };
+
+    void   StartCold();
+    void   StopCold() noexcept;
+    void   ColdLoop();                     // 圧縮スレッド
+    bool   CompressChunk(i64 start, std::vector<std::uint8_t>& raw, std::vector<std::uint8_t>& enc);
+    std::shared_ptr<const ColdChunk> FindColdChunk(i64 rowAbs) const noexcept;
+    // [rowAbs, rowAbs + winH) を、ホットに無い行はコールド層から復元してコピー
+    ReadResult CopyWindowCold(i64 rowAbs, int winH, i64 xOff, size_t lineBytes,
+                              std::uint8_t* dst, int dstStrideBytes, double& timeSecAtTop) const noexcept;
+
+    // ---- ファイルバック（lineStoreFile.cpp）----
+    void   OpenFile(const LineStoreOptions& opt);
+    void   InitFileHeader(LineStoreFileHeader& h, i64 segCapacity) const noexcept; // 構成欄とオフセット
+    void   RestoreFromFile();
+    void   WriteFileState(LineStoreFileHeader& h) const noexcept;
+    void   SyncFileState() noexcept;       // writer: ヘッダの状態欄を更新
+    void   FlushLoop();                    // 書き戻しスレッド
+    void   FlushFileRows(bool wait) noexcept;
+    void   CloseFile() noexcept;
 
 private:
     // 設定
@@ -88,30 +638,154 @@ private:
     int       roiX_;
     int       width_;
     i64       capacityLines_;
+    i64       capMask_;               // 容量が 2 のべき乗なら capacityLines_ - 1、それ以外は -1
+    int       rowAlign_;              // 0 なら詰める
+    int       rowPitch_;              // バッファ内の行間隔（>= RowBytes）
     int       warmupMax_;
     PixelType pixelType_;
     int       elemSizeBytes_;
+    SourceFormat sourceFormat_;
+    int          sourceShift_;
+    RowConvertFn convert_;            // nullptr なら memcpy
+    PushFn       pushFn_;             // 特殊化した PushRowsT
+    WindowFn     windowFn_;           // 特殊化した TryGetWindowPtrT
+
+    // 取り込みブロックの採用（AdoptFrames）
+    bool                                    adopt_;
+    std::vector<AdoptedBlock>               adoptSlots_;  // 記述子のリング
+    std::vector<std::optional<CameraFrame>> adoptFrames_; // 同じ位置の frame（writer 専用）
+    i64                                     adoptMask_;
+    std::atomic<i64>                        adoptHead_;   // 次に書く通し番号
+    std::atomic<i64>                        adoptTail_;   // 最古の保持中ブロックの通し番号
+
+    // PushBlockParallel
+    std::unique_ptr<CopyPool> copyPool_;      // CopyThreads > 0 のときだけ
+    int                       parallelMinBytes_;
+    bool                      parallelPush_;  // writer 専用：PushBlockParallel の中なら true
 
     // 状態
     std::atomic<bool> committed_;     // Commit 済みか
     int               warmupCount_;   // ウォームアップで埋まっている行数
+    std::atomic<int>  warmupHead_;    // 満杯後のウォームアップ（リング）で最古の行の物理位置。Commit で 0 に戻す
 
+    LineMemory    memory_;            // buf_ の実体
     std::uint8_t* buf_;               // 実データ
     i64           writeIndex_;        // Commit 後: 絶対行インデックス（0,1,2,...）
 
-    std::atomic<i64> headTotal_;      // Push された総行数（ウォームアップ含む）
+    std::atomic<i64> headTotal_;      // Push された総行数（ウォームアップ含む）。行の公開後に release で進める
     std::atomic<i64> storedLines_;    // 現在バッファ内に存在する行数（最大 capacityLines）
     std::atomic<bool> disposed_;
 
+    // 上書き検出（seqlock 相当）: writer は書き込み前に claimIndex_ を進め、
+    // 書き込み後に publishIndex_ を進める。どちらも絶対行（writeIndex_ と同じ座標）
+    std::atomic<i64>  claimIndex_;    // この値 - capacityLines_ 未満の行は上書き中/済み
+    std::atomic<i64>  publishIndex_;  // この値未満の行は書き込み完了
+
+    // 待機：writer は公開のたびに wakeSeq_ を進め、眠っている reader がいれば起こす
+    mutable std::atomic<std::uint32_t> wakeSeq_;
+    mutable std::atomic<int>           waiters_;
+
+    // 読み出しカーソル
+    std::array<CursorSlot, MAX_CURSORS> cursors_;
+    std::atomic<int>                    backpressureCursors_; // Active な Backpressure カーソル数
+    std::atomic<i64>                    droppedRows_;
+    std::atomic<i64>                    lostRows_;    // カーソルが追い越しで飛ばした行数（全カーソル、閉じた分も）
+
+    // 統計
+    std::atomic<i64>         pushCalls_;        // writer 専用（load + store）
+    mutable std::atomic<i64> overwrittenReads_;
+    LatencyHistogram         pushLatency_;
+
     // ウォームアップ用の per-line 時刻
     std::vector<double> warmupTimes_;
 
-    // セグメント（時間情報）
-    std::vector<TimeSeg> segs_;
-    std::atomic<int>     segCount_;
+    // セグメント（時間情報）。LineStoreGroup では同じ行進行の複数ストアで共有する
+    std::shared_ptr<TimeIndex> segs_;
+    bool                       ownsSegs_; // false なら共有先が追記・削除する
 
     double warmupLastTimeSec_;
+    bool         steadyTime_;
+    std::int64_t timeOriginNs_;       // double の秒の基準（steadyTime_ なら生成時の steady_clock。それ以外は 0）
+    std::int64_t lastPushNs_;         // writer 専用：PushBlockNs の前回の時刻
     i64    commitBase_;               // 絶対行 -> 論理行のオフセット
 
     bool circular_;                   // true ならリングバッファ動作
+
+    // 行ごとのメタデータ（物理行で引く。LineMeta 無しなら空）
+    bool                       meta_;
+    std::vector<std::int64_t>  metaEncoder_;
+    std::vector<std::uint32_t> metaTrigger_;
+    std::vector<std::uint32_t> metaFrame_;
+    const LineMetaBlock*       pushMeta_;   // writer 専用：Push 中のブロックのメタデータ（無ければ nullptr）
+
+    // 列ごとの統計（ColumnStats != Off のときだけ）。colAcc_ は writer だけが更新し、ロックは取らない。
+    // reader は colSeq_（奇数なら更新中）で確かめて写す（seqlock）。写せないまま続けば colWanted_ を立て、
+    // writer が IngestStage の終わりに colSnap_ へ写して colSnapSeq_ を進める
+    struct ColumnAccum
+    {
+        std::vector<std::uint64_t> Sum;   // Cumulative
+        std::vector<std::uint64_t> SumSq;
+        std::vector<float>         Mean;  // Exponential
+        std::vector<float>         Var;
+        i64                        Rows = 0;
+    };
+    void   PublishColumnSnapshot() noexcept; // writer
+
+    ColumnStatsMode                    colStats_;
+    float                              colAlpha_;
+    ColumnSumFn                        colSumFn_;
+    ColumnEmaFn                        colEmaFn_;
+    ColumnAccum                        colAcc_;
+    ColumnAccum                        colSnap_;
+    std::atomic<std::uint64_t>         colSeq_;
+    mutable std::atomic<bool>          colWanted_;
+    std::atomic<std::uint64_t>         colSnapSeq_;
+    std::atomic<bool>                  colResetPending_;
+    mutable std::mutex                 colMutex_;  // reader どうし（ColumnStats / ResetColumnStats）
+
+    // フラットフィールド。writer は flat_ だけを使い、差し替えは Push の先頭で flatNext_ から受け取る。
+    // 外した表は flatOld_ に残し、次の SetFlatField / ClearFlatField が解放する（writer は解放しない）
+    FlatFieldFn                           flatFn_;
+    std::unique_ptr<const FlatFieldTable> flat_;        // writer 専用
+    std::unique_ptr<const FlatFieldTable> flatNext_;    // flatMutex_ で保護
+    std::unique_ptr<const FlatFieldTable> flatOld_;     // flatMutex_ で保護
+    std::atomic<bool>                     flatPending_; // flatNext_ が未受け取り
+    std::mutex                            flatMutex_;
+
+    // 分割書き込み（RegisterTap。最初の PushTap で固定）
+    std::vector<std::unique_ptr<TapSlot>> taps_;
+    std::atomic<int>                      tapCount_;
+    std::atomic<bool>                     tapsSealed_;
+    std::mutex                            tapMutex_;   // 登録・固定・公開・tap 0 の時間セグメント
+    i64                                   tapSegEnd_;  // tap 0 が時間セグメントを登録し終えた末尾の絶対行（tapMutex_）
+
+    // コールド層（ColdCapacityLines > 0 のときだけ）
+    int                                           coldChunkRows_;
+    std::vector<std::shared_ptr<const ColdChunk>> coldSlots_;  // 通し番号 (Start / coldChunkRows_) % 個数。coldMutex_ で保護
+    mutable std::mutex                            coldMutex_;
+    std::thread                                   coldThread_;
+    std::atomic<bool>                             coldStop_;
+    std::atomic<i64>                              coldLostRows_;
+    std::atomic<i64>                              coldBytes_;
+    std::atomic<i64>                              coldRows_;
+    std::atomic<i64>                              coldSegRow_; // 最後の時間セグメントの先頭（絶対行）。これより前の行の時刻は確定
+
+    // ビニングレベル
+    std::vector<BinLevel>     levels_;     // 2x, 4x, 8x の順（writer 専用。Rows は reader も読む）
+    std::vector<std::uint8_t> binZeroRow_; // 1 回で一周以上した Push で飛ばした行の代わり
+    const LineStore*          binParent_;  // レベルなら元のストア（時刻は元の行で引く）
+    int                       binFactor_;
+
+    // ファイルバック
+    LineStoreFileHeader*    fileHeader_;      // nullptr ならファイル無し
+    TimeSeg*                fileSegs_;        // SegCapacity 個のリング
+    double*                 fileWarmupTimes_; // WarmupMax 個（warmupTimes_ と同じ並び。Commit 前に止まっても残る）
+    i64                     fileSegCount_;    // 書いた時間セグメントの総数
+    bool                    readOnly_;
+    int                     flushIntervalMs_;
+    i64                     flushedIndex_;    // 書き戻しスレッド専用
+    std::thread             flushThread_;
+    std::mutex              flushMutex_;
+    std::condition_variable flushCv_;
+    bool                    flushStop_;       // flushMutex_ で保護
 };
\ No newline at end of file
@@ -0,0 +1,179 @@
+// LineStoreAdopt.cpp
+// 取り込みブロックの採用（AdoptFrames）：ドライバのフレームをコピーせずに保持する
+//   - 画素リングの代わりにブロック記述子のリング。行は絶対行で連続し、ブロックは行の区間を持つ
+//   - 保持期間（capacityLines 行）を過ぎたブロックはまるごと解放する。最古の行は最古の保持中ブロックの先頭で、
+//     上書き検出（claimIndex_ - capacityLines_）もその行に合わせて進める
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include "lineStore2.hpp"
+
+// ---- 生成 ----
+void LineStore::InitAdopt(const LineStoreOptions& opt) {
+    if (convert_) throw std::invalid_argument("AdoptFrames requires Source matching PixelType");
+    if (opt.AdoptMaxFrames <= 0) throw std::out_of_range("AdoptMaxFrames");
+
+    i64 n = 1;
+    while (n < opt.AdoptMaxFrames) n <<= 1;
+    adoptSlots_.assign(static_cast<size_t>(n), AdoptedBlock{});
+    adoptFrames_.resize(static_cast<size_t>(n));
+    adoptMask_ = n - 1;
+
+    // ウォームアップは無い：生成時から Commit 済み（絶対行 0 から）
+    committed_.store(true, std::memory_order_release);
+}
+
+// ---- 採用（writer スレッド）----
+bool LineStore::AdoptBlock(CameraFrame&& frame, int rows, int srcStrideBytes) {
+    return AdoptBlock(std::move(frame), rows, srcStrideBytes, NowSec());
+}
+
+bool LineStore::AdoptBlock(CameraFrame&& frame, int rows, int srcStrideBytes, double acquiredUtcSec) {
+    check_not_disposed();
+    if (!adopt_) throw std::logic_error("AdoptBlock requires AdoptFrames");
+    PushTimer timer{ *this };
+
+    CameraFrame held(std::move(frame)); // ここで所有する（拒否・例外でも解放される）
+    if (!held.data()) throw std::invalid_argument("frame");
+    if (rows <= 0) return true;
+    if (srcStrideBytes < SourceRowBytes())
+        throw std::invalid_argument("srcStrideBytes too small (for source width)");
+    if (static_cast<i64>(rows - 1) * srcStrideBytes + SourceRowBytes() > static_cast<i64>(held.size()))
+        throw std::invalid_argument("frame too small for rows");
+
+    // Backpressure カーソルの未読行を解放することになるなら受け入れない（ブロックは分けられないので丸ごと）
+    if (backpressureCursors_.load(std::memory_order_seq_cst) != 0 && WritableRows() < rows) {
+        droppedRows_.fetch_add(rows, std::memory_order_relaxed);
+        return false;
+    }
+
+    const i64 start = writeIndex_;
+    const i64 end   = start + rows;
+
+    // 保持期間を過ぎたブロック（記述子が満杯なら最古のものも）を先に解放してスロットを空ける
+    ReleaseAdopted(end);
+
+    const i64    head = adoptHead_.load(std::memory_order_relaxed);
+    const size_t slot = static_cast<size_t>(head & adoptMask_);
+    adoptSlots_[slot] = AdoptedBlock{ held.data(), srcStrideBytes, start, rows };
+    adoptFrames_[slot].emplace(std::move(held));
+    adoptHead_.store(head + 1, std::memory_order_release);
+
+    AddSeg(start - commitBase_, acquiredUtcSec);
+
+    writeIndex_ = end;
+    publishIndex_.store(end, std::memory_order_release);
+    if (ownsSegs_) segs_->TrimBefore(OldestRowAbs() - commitBase_);
+    storedLines_.store(end - OldestRowAbs(), std::memory_order_release);
+    headTotal_.fetch_add(rows, std::memory_order_release); // 最後に進める（WaitForLines で起きた reader が読めるように）
+
+    NotifyWaiters();
+    return true;
+}
+
+void LineStore::ReleaseAdopted(i64 endAbs) {
+    const i64 head = adoptHead_.load(std::memory_order_relaxed);
+    const i64 tail = adoptTail_.load(std::memory_order_relaxed);
+
+    // 全行が endAbs - capacityLines_ より前のブロック、と新しいブロックの分のスロット
+    i64 t = tail;
+    while (t < head) {
+        const auto& b       = adoptSlots_[static_cast<size_t>(t & adoptMask_)];
+        const bool  expired = b.Start + b.Rows <= endAbs - capacityLines_;
+        const bool  full    = head + 1 - t > adoptMask_ + 1;
+        if (!expired && !full) break;
+        ++t;
+    }
+    if (t == tail) return;
+
+    // reader に先に知らせる：最古の行と記述子の tail を進めてから解放・スロットの再利用をする
+    // （release fence 以降の変更を見た reader は、この claimIndex_ / adoptTail_ も必ず見る）
+    const i64 oldest = (t < head) ? adoptSlots_[static_cast<size_t>(t & adoptMask_)].Start : writeIndex_;
+    claimIndex_.store(oldest + capacityLines_, std::memory_order_relaxed);
+    adoptTail_.store(t, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (i64 i = tail; i < t; ++i)
+        adoptFrames_[static_cast<size_t>(i & adoptMask_)].reset(); // ドライバへ返す
+}
+
+void LineStore::ReleaseAllAdopted() noexcept {
+    if (!adopt_) return;
+    claimIndex_.store(writeIndex_ + capacityLines_, std::memory_order_relaxed);
+    adoptTail_.store(adoptHead_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (auto& f : adoptFrames_) f.reset();
+}
+
+bool LineStore::PushRowsAdopted(const void*, int, int, double, bool) {
+    throw std::logic_error("AdoptFrames store takes rows through AdoptBlock");
+}
+
+// ---- 読み出し ----
+bool LineStore::FindAdopted(i64 rowAbs, AdoptedBlock& blk) const noexcept {
+    auto slot = [&](i64 i) -> const AdoptedBlock& { return adoptSlots_[static_cast<size_t>(i & adoptMask_)]; };
+
+    for (;;) {
+        const i64 head = adoptHead_.load(std::memory_order_acquire);
+        const i64 tail = adoptTail_.load(std::memory_order_acquire);
+        if (head <= tail) return false;
+
+        // max(Start <= rowAbs) を二分探索
+        i64 lo = tail, hi = head - 1, k = tail - 1;
+        while (lo <= hi) {
+            const i64 mid = lo + (hi - lo) / 2;
+            if (slot(mid).Start <= rowAbs) { k = mid; lo = mid + 1; }
+            else                           { hi = mid - 1; }
+        }
+        if (k < tail) return false; // 最古のブロックより前（解放済み）
+        blk = slot(k);
+
+        // 読んだスロットが再利用されていなければ確定（tail が進んでいたら読み直し）
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (adoptTail_.load(std::memory_order_relaxed) != tail) continue;
+
+        return rowAbs < blk.Start + blk.Rows;
+    }
+}
+
+bool LineStore::TryGetWindowPtrAdopted(i64 startRow, int winW, int winH, int x0,
+                                       const void*& ptr, int& strideBytes, double& timeSecAtTop) const noexcept
+{
+    ptr = nullptr; strideBytes = rowPitch_; timeSecAtTop = std::numeric_limits<double>::quiet_NaN();
+    if (startRow < 0 || winW <= 0 || winH <= 0 || winW > width_) return false;
+
+    const i64 avail = storedLines_.load(std::memory_order_acquire);
+    if (startRow + winH > avail) return false;
+
+    const i64 rowAbs = publishIndex_.load(std::memory_order_acquire) - avail + startRow;
+
+    AdoptedBlock blk;
+    if (!FindAdopted(rowAbs, blk)) return false;
+    if (rowAbs + winH > blk.Start + blk.Rows) return false; // ブロックを跨ぐ窓は連続でない（TryCopyWindow を使う）
+
+    const int x0c = clamp(x0, 0, std::max(0, width_ - winW));
+    ptr = static_cast<const void*>(blk.Data + (rowAbs - blk.Start) * blk.Stride
+                                   + static_cast<i64>(roiX_ + x0c) * elemSizeBytes_);
+    strideBytes  = blk.Stride;
+    timeSecAtTop = RowTimeSec(rowAbs);
+    return true;
+}
+
+bool LineStore::CopyRowsAdopted(i64 rowAbs, int winH, i64 xOff, size_t lineBytes,
+                                std::uint8_t* dst, int dstStrideBytes) const noexcept
+{
+    const i64 x = static_cast<i64>(roiX_) * elemSizeBytes_ + xOff;
+    for (int y = 0; y < winH;) {
+        const i64 row = rowAbs + y;
+        AdoptedBlock blk;
+        if (!FindAdopted(row, blk)) return false;
+
+        const int   n = static_cast<int>(std::min<i64>(winH - y, blk.Start + blk.Rows - row));
+        const auto* s = blk.Data + (row - blk.Start) * blk.Stride + x;
+        for (int i = 0; i < n; ++i)
+            std::memcpy(dst + static_cast<i64>(y + i) * dstStrideBytes, s + static_cast<i64>(i) * blk.Stride, lineBytes);
+        y += n;
+    }
+    return true;
+}
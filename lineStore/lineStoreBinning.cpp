@@ -0,0 +1,113 @@
+// LineStoreBinning.cpp
+// ビニングレベル（2x / 4x / 8x に縦横まとめた縮小版を Push のたびに作る）
+//   - 各段は「横 2 画素の和を u32 に足す」を縦 2 行ぶん繰り返すだけ。完成した和の行をそのまま次段の入力にする
+//     ので、元の画素を読むのは 1 回で、8x でも和は正確（平均の丸めは出力時の 1 回だけ）
+//   - 出力行はレベルごとに溜めて、元の Push 1 回につき 1 回だけレベルへ Push する
+#include <algorithm>
+#include <stdexcept>
+#include "lineStore2.hpp"
+
+// ---- 生成 ----
+void LineStore::CreateLevels(const LineStoreOptions& opt) {
+    if (opt.BinLevels == 0) return;
+
+    // レベルは通常の LineStore（同じモード・行レイアウト・確保方法）。ファイルは持たず、時刻は元のストアで引く
+    LineStoreOptions lopt;
+    lopt.Circular               = opt.Circular;
+    lopt.Mirrored               = opt.Mirrored;
+    lopt.RowAlignBytes          = opt.RowAlignBytes;
+    lopt.PowerOfTwoCapacity     = opt.PowerOfTwoCapacity;
+    lopt.Memory                 = opt.Memory;
+    lopt.Memory.FilePath.clear();
+    lopt.Memory.FileHeaderBytes = 0;
+    lopt.Memory.FileReadOnly    = false;
+    lopt.TimeSegCapacity        = 1;
+
+    const PixelType lpt = (opt.Bin == BinMode::Sum) ? PixelType::U16 : pixelType_;
+
+    levels_.reserve(static_cast<size_t>(opt.BinLevels));
+    for (int k = 0; k < opt.BinLevels; ++k) {
+        const int f = 2 << k;
+        const int w = width_ / f;
+        if (w <= 0) throw std::out_of_range("BinLevels (roiW too small)");
+
+        BinLevel lv;
+        lv.Factor  = f;
+        lv.Width   = w;
+        lv.Shift   = (opt.Bin == BinMode::Mean) ? 2 * (k + 1) : 0; // f×f = 4^(k+1)
+        lv.PairSum = SelectBinPairSum(k == 0 ? elemSizeBytes_ : 4);
+        lv.Store   = SelectBinStore(lpt);
+        lv.Acc.assign(static_cast<size_t>(w), 0u);
+        lv.Phase   = 0;
+        lv.Rows    = std::make_unique<LineStore>(w, 0, w, std::max<i64>(1, capacityLines_ / f), 1, lpt, lopt);
+        lv.Stage.resize(static_cast<size_t>(BIN_STAGE_ROWS) * static_cast<size_t>(lv.Rows->RowBytes()));
+        lv.Staged  = 0;
+
+        lv.Rows->binParent_ = this;
+        lv.Rows->binFactor_ = f;
+        levels_.push_back(std::move(lv));
+    }
+}
+
+// ---- Commit：レベルも Commit して、ウォームアップで残った行から作る ----
+void LineStore::CommitLevels() {
+    if (levels_.empty()) return;
+    for (auto& lv : levels_) lv.Rows->Commit();
+    FeedLevels(0, warmupCount_);
+}
+
+// ---- 取り込み（writer スレッド）----
+void LineStore::FeedLevels(i64 fromAbs, i64 endAbs) {
+    // 1 回で一周以上した Push は先頭側がバッファに残っていない。
+    // 行の対応（元の r ↔ レベルの r / f）を保つため、その行は 0 として数える
+    const i64 oldest = circular_ ? endAbs - capacityLines_ : fromAbs;
+
+    for (i64 r = fromAbs; r < endAbs; ++r) {
+        const std::uint8_t* row;
+        if (r < oldest) {
+            if (binZeroRow_.empty()) binZeroRow_.assign(static_cast<size_t>(rowPitch_), 0);
+            row = binZeroRow_.data();
+        } else {
+            row = buf_ + PhysRow(r) * rowPitch_;
+        }
+        BinRow(0, row);
+    }
+
+    for (auto& lv : levels_) FlushLevel(lv);
+}
+
+void LineStore::BinRow(size_t k, const void* in) {
+    auto& lv = levels_[k];
+    lv.PairSum(in, lv.Width, lv.Acc.data());
+    if (++lv.Phase < 2) return;
+
+    // 縦 2 行そろった = f×f 画素の和が完成。次段へ渡してから保存形式にして溜める
+    if (k + 1 < levels_.size()) BinRow(k + 1, lv.Acc.data());
+
+    auto* dst = lv.Stage.data() + static_cast<size_t>(lv.Staged) * static_cast<size_t>(lv.Rows->RowBytes());
+    lv.Store(lv.Acc.data(), lv.Width, lv.Shift, dst);
+    std::fill(lv.Acc.begin(), lv.Acc.end(), 0u);
+    lv.Phase = 0;
+
+    if (++lv.Staged == BIN_STAGE_ROWS) FlushLevel(lv);
+}
+
+void LineStore::FlushLevel(BinLevel& lv) {
+    if (lv.Staged == 0) return;
+    // 時刻は元のストアで引くので時間セグメントは切らない。入り切らない行はレベルの DroppedRows に数わる
+    lv.Rows->PushRows(lv.Stage.data(), lv.Staged, lv.Rows->RowBytes(), 0.0, /*newSeg=*/false);
+    lv.Staged = 0;
+}
+
+// ---- 取得 ----
+LineStore* LineStore::Level(int factor) noexcept {
+    for (auto& lv : levels_)
+        if (lv.Factor == factor) return lv.Rows.get();
+    return nullptr;
+}
+
+const LineStore* LineStore::Level(int factor) const noexcept {
+    return const_cast<LineStore*>(this)->Level(factor);
+}
+
+int LineStore::BinFactor() const noexcept { return binFactor_; }
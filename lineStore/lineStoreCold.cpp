@@ -0,0 +1,170 @@
+// LineStoreCold.cpp
+// コールド層（ColdCapacityLines）：リングより長い履歴を圧縮して残す
+//   - 圧縮スレッドは publishIndex_ を追い、ColdChunkRows 行そろうたびにホットのリングから
+//     TryCopyWindow と同じ手順（コピー → RowsIntact で検証）で写して圧縮する。writer は待たない
+//   - 追いつけずに行がリングから押し出されたら、その分は飛ばして ColdLostRows に数える
+//   - チャンクは (Start / ColdChunkRows) % 個数 のスロットに置き、古いものから置き換える。
+//     reader はスロットの shared_ptr を短いロックの中で取り、復元はロックの外で行う
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include "coldCodec.hpp"
+#include "lineStore2.hpp"
+
+// ---- 開始 / 停止 ----
+void LineStore::StartCold() {
+    if (coldSlots_.empty() || readOnly_ || coldThread_.joinable()) return;
+    coldStop_.store(false, std::memory_order_relaxed);
+    coldThread_ = std::thread([this] { ColdLoop(); });
+}
+
+void LineStore::StopCold() noexcept {
+    if (!coldThread_.joinable()) return;
+    coldStop_.store(true, std::memory_order_relaxed);
+    NotifyWaiters(); // WaitForLines で眠っていれば起こす
+    coldThread_.join();
+}
+
+// ---- 圧縮スレッド ----
+void LineStore::ColdLoop() {
+    const i64 C = coldChunkRows_;
+    std::vector<std::uint8_t> raw(static_cast<size_t>(C) * static_cast<size_t>(RowBytes()));
+    std::vector<std::uint8_t> enc(static_cast<size_t>(C) * ColdMaxRowBytes(width_));
+
+    i64 next = 0; // 次に圧縮するチャンクの先頭（絶対行）
+    while (!coldStop_.load(std::memory_order_relaxed) && !disposed_.load(std::memory_order_acquire)) {
+        // チャンクの行の時刻が確定する（次の時間セグメントがチャンクの後ろから始まる）まで待つ。
+        // 最後の Push の行は直前の傾きで外挿した時刻なので、そのまま残すと押し出された後も外れたままになる
+        const i64 end = publishIndex_.load(std::memory_order_acquire);
+        if (end < next + C || coldSegRow_.load(std::memory_order_acquire) < next + C) {
+            // 足りない行数だけ（行が揃っていれば次の Push まで）HeadTotal が進むまで眠る（Dispose / 停止でも起こされる）
+            const i64 need = headTotal_.load(std::memory_order_acquire) + std::max<i64>(next + C - end, 1);
+            WaitForLines(need, std::chrono::milliseconds(100));
+            continue;
+        }
+
+        // リングから押し出された行は取れないので、残っている最初のチャンクまで飛ばす
+        const i64 oldest = claimIndex_.load(std::memory_order_acquire) - capacityLines_;
+        if (next < oldest) {
+            const i64 to = (oldest + C - 1) / C * C;
+            coldLostRows_.fetch_add(to - next, std::memory_order_relaxed);
+            next = to;
+            continue;
+        }
+
+        if (!CompressChunk(next, raw, enc)) continue; // 写している間に追い越された（次の周回で飛ばす）
+        next += C;
+    }
+}
+
+bool LineStore::CompressChunk(i64 start, std::vector<std::uint8_t>& raw, std::vector<std::uint8_t>& enc) {
+    const int  C  = coldChunkRows_;
+    const i64  rb = RowBytes();
+
+    // ホットから写す（TryCopyWindow と同じく、写した後に上書きが無かったことを確かめる）
+    auto chunk = std::make_shared<ColdChunk>();
+    chunk->Start = start;
+    chunk->Times.resize(static_cast<size_t>(C));
+    for (int y = 0; y < C; ++y) {
+        std::memcpy(raw.data() + y * rb, buf_ + PhysRow(start + y) * rowPitch_, static_cast<size_t>(rb));
+        chunk->Times[static_cast<size_t>(y)] = RowTimeSec(start + y);
+    }
+    if (!RowsIntact(start)) return false;
+
+    // 圧縮は写しから（ロックもリングも触らない）
+    chunk->Offsets.resize(static_cast<size_t>(C) + 1);
+    size_t pos = 0;
+    for (int y = 0; y < C; ++y) {
+        chunk->Offsets[static_cast<size_t>(y)] = static_cast<std::uint32_t>(pos);
+        pos += ColdEncodeRow(raw.data() + y * rb, width_, elemSizeBytes_, enc.data() + pos);
+    }
+    chunk->Offsets[static_cast<size_t>(C)] = static_cast<std::uint32_t>(pos);
+    chunk->Data.assign(enc.begin(), enc.begin() + static_cast<std::ptrdiff_t>(pos));
+
+    const i64 bytes = static_cast<i64>(chunk->Data.size());
+    const auto slot = static_cast<size_t>((start / C) % static_cast<i64>(coldSlots_.size()));
+
+    std::shared_ptr<const ColdChunk> old;
+    {
+        std::lock_guard<std::mutex> lk(coldMutex_);
+        old = std::move(coldSlots_[slot]);
+        coldSlots_[slot] = std::move(chunk);
+    }
+    coldBytes_.fetch_add(bytes - (old ? static_cast<i64>(old->Data.size()) : 0), std::memory_order_relaxed);
+    if (!old) coldRows_.fetch_add(C, std::memory_order_relaxed);
+    return true; // old はロックの外で解放する
+}
+
+// ---- 読み出し ----
+std::shared_ptr<const LineStore::ColdChunk> LineStore::FindColdChunk(i64 rowAbs) const noexcept {
+    const i64 C    = coldChunkRows_;
+    const i64 k    = rowAbs / C;
+    const auto slot = static_cast<size_t>(k % static_cast<i64>(coldSlots_.size()));
+
+    std::shared_ptr<const ColdChunk> c;
+    {
+        std::lock_guard<std::mutex> lk(coldMutex_);
+        c = coldSlots_[slot];
+    }
+    if (!c || c->Start != k * C) return nullptr; // 置き換え済み / 飛ばしたチャンク
+    return c;
+}
+
+ReadResult LineStore::CopyWindowCold(i64 rowAbs, int winH, i64 xOff, size_t lineBytes,
+                                     std::uint8_t* dst, int dstStrideBytes, double& timeSecAtTop) const noexcept
+{
+    if (coldSlots_.empty()) return CountOverwritten();
+
+    // 復元先の 1 行（reader スレッドごと）
+    thread_local std::vector<std::uint8_t> row;
+    try {
+        row.resize(static_cast<size_t>(RowBytes()));
+    } catch (...) {
+        return ReadResult::InvalidArg;
+    }
+
+    // 途中でホットの行が押し出されたら、その行はもうコールド層にあるはずなのでもう 1 回だけやり直す
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const i64 hot   = claimIndex_.load(std::memory_order_relaxed) - capacityLines_;
+        const i64 split = std::clamp(hot, rowAbs, rowAbs + winH); // [rowAbs, split) はコールド、以降はホット
+
+        bool ok = true;
+        std::shared_ptr<const ColdChunk> top;
+        for (i64 r = rowAbs; r < split && ok;) {
+            auto c = FindColdChunk(r);
+            if (!c) { ok = false; break; }
+            if (r == rowAbs) top = c;
+
+            const i64 n = std::min(split, c->Start + coldChunkRows_) - r;
+            for (i64 i = 0; i < n; ++i) {
+                const auto y = static_cast<size_t>(r + i - c->Start);
+                ColdDecodeRow(c->Data.data() + c->Offsets[y], width_, elemSizeBytes_, row.data());
+                std::memcpy(dst + (r + i - rowAbs) * dstStrideBytes, row.data() + xOff, lineBytes);
+            }
+            r += n;
+        }
+        if (!ok) return CountOverwritten(); // コールド層にも無い（古すぎる / 圧縮が追いつかなかった）
+
+        for (i64 r = split; r < rowAbs + winH; ++r)
+            std::memcpy(dst + (r - rowAbs) * dstStrideBytes, buf_ + PhysRow(r) * rowPitch_ + xOff, lineBytes);
+        if (split < rowAbs + winH && !RowsIntact(split)) continue;
+
+        timeSecAtTop = top ? top->Times[static_cast<size_t>(rowAbs - top->Start)] : RowTimeSec(rowAbs);
+        return ReadResult::Ok;
+    }
+    return CountOverwritten();
+}
+
+LineStore::i64 LineStore::ColdOldestRowAbs() const noexcept {
+    const i64 hot = OldestRowAbs();
+    if (coldSlots_.empty()) return hot;
+
+    i64 oldest = std::numeric_limits<i64>::max();
+    {
+        std::lock_guard<std::mutex> lk(coldMutex_);
+        for (const auto& c : coldSlots_)
+            if (c) oldest = std::min(oldest, c->Start);
+    }
+    return std::min(oldest, hot);
+}
@@ -0,0 +1,208 @@
+// LineStoreColumns.cpp
+// 取り込み時の列ごとの統計（ColumnStats）とフラットフィールド補正（SetFlatField）
+//   - Push でバッファへ書いた行を、公開（publishIndex_）の前に 1 行ずつ処理する。行は書いた直後で L1 にあるので、
+//     窓を読み直して統計・補正をかける 2 回のパスが要らなくなる
+//   - 統計は補正前の値。1 行の中で統計 → 補正の順にかける
+//   - 補正表の差し替えは Push の先頭でだけ受け取るので、1 回の Push の行はすべて同じ表で補正される
+//   - 統計の写しは seqlock（colSeq_）。writer はロックを取らず、reader を待たない
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include "lineStore2.hpp"
+
+// ---- 生成 ----
+void LineStore::CreateColumns(const LineStoreOptions& opt) {
+    flatFn_ = SelectFlatField(pixelType_);
+    if (colStats_ == ColumnStatsMode::Off) return;
+
+    const auto w = static_cast<size_t>(width_);
+    if (colStats_ == ColumnStatsMode::Cumulative) {
+        colSumFn_ = SelectColumnSum(pixelType_);
+        colAcc_.Sum.assign(w, 0);
+        colAcc_.SumSq.assign(w, 0);
+    } else {
+        if (!(opt.ColumnStatsAlpha > 0.0 && opt.ColumnStatsAlpha <= 1.0)) throw std::out_of_range("ColumnStatsAlpha");
+        colEmaFn_ = SelectColumnEma(pixelType_);
+        colAcc_.Mean.assign(w, 0.0f);
+        colAcc_.Var.assign(w, 0.0f);
+    }
+    colSnap_ = colAcc_; // writer が写すときに確保しない
+}
+
+// ---- 取り込み（writer スレッド）----
+void LineStore::IngestStage(std::uint8_t* dst, int rows) {
+    const FlatFieldTable* flat  = flat_.get();
+    const bool            stats = (colStats_ != ColumnStatsMode::Off);
+    auto&                 a     = colAcc_;
+
+    if (stats) {
+        // 奇数の間は更新中（reader は写し直す）。後のデータ書き込みより先に見えるよう release fence
+        colSeq_.store(colSeq_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        if (colResetPending_.load(std::memory_order_acquire) && colResetPending_.exchange(false, std::memory_order_acq_rel)) {
+            std::fill(a.Sum.begin(), a.Sum.end(), 0);
+            std::fill(a.SumSq.begin(), a.SumSq.end(), 0);
+            a.Rows = 0;
+        }
+    }
+
+    for (int y = 0; y < rows; ++y) {
+        std::uint8_t* row = dst + static_cast<i64>(y) * rowPitch_;
+
+        if (colStats_ == ColumnStatsMode::Cumulative) {
+            colSumFn_(row, width_, a.Sum.data(), a.SumSq.data());
+            ++a.Rows;
+        } else if (colStats_ == ColumnStatsMode::Exponential) {
+            if (a.Rows == 0) { // 最初の行で平均を初期化（0 から立ち上がらないように）。分散は 1 行では分からないので 0
+                for (int x = 0; x < width_; ++x) {
+                    a.Mean[static_cast<size_t>(x)] = (elemSizeBytes_ == 1)
+                        ? static_cast<float>(row[x])
+                        : static_cast<float>(reinterpret_cast<const std::uint16_t*>(row)[x]);
+                    a.Var[static_cast<size_t>(x)] = 0.0f;
+                }
+            } else {
+                colEmaFn_(row, width_, colAlpha_, a.Mean.data(), a.Var.data());
+            }
+            ++a.Rows;
+        }
+
+        if (flat) flatFn_(row, width_, flat->Dark.data(), flat->Gain.data());
+    }
+
+    if (stats) {
+        colSeq_.store(colSeq_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        if (colWanted_.load(std::memory_order_relaxed)) [[unlikely]] PublishColumnSnapshot();
+    }
+}
+
+// 写せずにいる reader のために、Push の区切りで今の統計を colSnap_ へ写す（colSnapSeq_ が奇数の間は写し中）
+void LineStore::PublishColumnSnapshot() noexcept {
+    auto&       d = colSnap_;
+    const auto& a = colAcc_;
+    colSnapSeq_.store(colSnapSeq_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::copy(a.Sum.begin(), a.Sum.end(), d.Sum.begin());
+    std::copy(a.SumSq.begin(), a.SumSq.end(), d.SumSq.begin());
+    std::copy(a.Mean.begin(), a.Mean.end(), d.Mean.begin());
+    std::copy(a.Var.begin(), a.Var.end(), d.Var.begin());
+    d.Rows = a.Rows;
+    colWanted_.store(false, std::memory_order_relaxed);
+    colSnapSeq_.store(colSnapSeq_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+void LineStore::TakeFlatField() noexcept {
+    std::lock_guard<std::mutex> lk(flatMutex_);
+    flatOld_ = std::move(flat_); // 前回の Set で空にしてあるので、ここでは解放しない
+    flat_    = std::move(flatNext_);
+    flatPending_.store(false, std::memory_order_relaxed);
+}
+
+// ---- 補正表の設定 ----
+void LineStore::SetFlatField(const std::vector<float>& dark, const std::vector<float>& gain) {
+    const auto w = static_cast<size_t>(width_);
+    if (dark.size() != w || gain.size() != w) throw std::invalid_argument("flat-field table size must be Width");
+
+    auto t  = std::make_unique<FlatFieldTable>();
+    t->Dark = dark;
+    t->Gain = gain;
+    PublishFlatField(std::move(t));
+}
+
+void LineStore::SetFlatFieldFromReferences(const std::vector<double>& dark, const std::vector<double>& bright, double target) {
+    const auto w = static_cast<size_t>(width_);
+    if (dark.size() != w || bright.size() != w) throw std::invalid_argument("reference size must be Width");
+
+    auto t = std::make_unique<FlatFieldTable>();
+    t->Dark.resize(w);
+    t->Gain.resize(w);
+    for (size_t x = 0; x < w; ++x) {
+        const double span = bright[x] - dark[x];
+        t->Dark[x] = static_cast<float>(dark[x]);
+        t->Gain[x] = (span > 0.0) ? static_cast<float>(target / span) : 0.0f; // 死んだ列は 0
+    }
+    PublishFlatField(std::move(t));
+}
+
+void LineStore::ClearFlatField() {
+    PublishFlatField(nullptr);
+}
+
+void LineStore::PublishFlatField(std::unique_ptr<const FlatFieldTable> table) {
+    check_not_disposed();
+    if (readOnly_) throw std::logic_error("LineStore is read-only");
+    if (adopt_) throw std::logic_error("flat-field is not supported with AdoptFrames");
+    if (binParent_) throw std::logic_error("LineStore bin level is written by its parent");
+    if (tapCount_.load(std::memory_order_acquire) != 0) throw std::logic_error("flat-field is not supported with taps");
+
+    // 外した表・受け取られなかった表はロックの外で解放する
+    std::unique_ptr<const FlatFieldTable> old, unused;
+    {
+        std::lock_guard<std::mutex> lk(flatMutex_);
+        old       = std::move(flatOld_);
+        unused    = std::move(flatNext_);
+        flatNext_ = std::move(table);
+        flatPending_.store(true, std::memory_order_release);
+    }
+}
+
+// ---- 統計の取得 ----
+ColumnStatsSnapshot LineStore::ColumnStats() const {
+    if (colStats_ == ColumnStatsMode::Off) throw std::logic_error("ColumnStats is Off");
+
+    const auto w = static_cast<size_t>(width_);
+    ColumnStatsSnapshot s;
+    s.Mean.resize(w);
+    s.Variance.resize(w);
+
+    std::lock_guard<std::mutex> lk(colMutex_);
+    if (colResetPending_.load(std::memory_order_acquire)) return s; // 数え直しを writer がまだ受け取っていない
+
+    // seqlock で写す。writer が更新し続けていれば、Push の区切りで writer が写したものを使う
+    // （colSnap_ も seqlock。頼んだ後に写し終わったもの = 頼んだ時点より新しい偶数）
+    ColumnAccum   a;
+    std::uint64_t asked = 0;
+    for (int attempt = 0;; ++attempt) {
+        const std::uint64_t seq = colSeq_.load(std::memory_order_acquire);
+        if ((seq & 1) == 0) {
+            a = colAcc_;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (colSeq_.load(std::memory_order_relaxed) == seq) break;
+        }
+        if (attempt >= 4) {
+            const std::uint64_t snap = colSnapSeq_.load(std::memory_order_acquire);
+            if (attempt == 4) asked = snap;
+            if ((snap & 1) == 0 && snap > asked) {
+                a = colSnap_;
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (colSnapSeq_.load(std::memory_order_relaxed) == snap) break;
+            }
+            colWanted_.store(true, std::memory_order_relaxed);
+        }
+        std::this_thread::yield();
+    }
+    colWanted_.store(false, std::memory_order_relaxed);
+
+    s.Rows = a.Rows;
+    if (s.Rows == 0) return s;
+    if (colStats_ == ColumnStatsMode::Cumulative) {
+        const double n = static_cast<double>(s.Rows);
+        for (size_t x = 0; x < w; ++x) {
+            const double m = static_cast<double>(a.Sum[x]) / n;
+            s.Mean[x]     = m;
+            s.Variance[x] = std::max(0.0, static_cast<double>(a.SumSq[x]) / n - m * m);
+        }
+    } else {
+        std::copy(a.Mean.begin(), a.Mean.end(), s.Mean.begin());
+        std::copy(a.Var.begin(), a.Var.end(), s.Variance.begin());
+    }
+    return s;
+}
+
+void LineStore::ResetColumnStats() {
+    if (colStats_ == ColumnStatsMode::Off) throw std::logic_error("ColumnStats is Off");
+
+    // writer が次の IngestStage の先頭で 0 に戻す（Exponential は Rows = 0 で次の行から初期化し直す）
+    std::lock_guard<std::mutex> lk(colMutex_);
+    colResetPending_.store(true, std::memory_order_release);
+}
@@ -0,0 +1,137 @@
+// LineStoreCursor.cpp
+// 読み出しカーソル（登録・遅れの監視・追い越し時のポリシー・Backpressure）
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include "lineStore2.hpp"
+
+LineStore::CursorSlot& LineStore::Cursor(int id) {
+    if (id < 0 || id >= MAX_CURSORS) throw std::out_of_range("cursor id");
+    auto& c = cursors_[static_cast<size_t>(id)];
+    if (c.State.load(std::memory_order_acquire) != CursorSlot::Active) throw std::out_of_range("cursor not open");
+    return c;
+}
+
+const LineStore::CursorSlot& LineStore::Cursor(int id) const {
+    return const_cast<LineStore*>(this)->Cursor(id);
+}
+
+// ---- 登録 / 解除 ----
+int LineStore::OpenCursor(CursorPolicy policy, i64 startRowAbs) {
+    check_not_disposed();
+    if (policy == CursorPolicy::Backpressure && tapCount_.load(std::memory_order_acquire) != 0)
+        throw std::invalid_argument("Backpressure cursor is not supported with taps");
+
+    for (int id = 0; id < MAX_CURSORS; ++id) {
+        auto& c = cursors_[static_cast<size_t>(id)];
+        int expected = CursorSlot::Free;
+        if (!c.State.compare_exchange_strong(expected, CursorSlot::Opening, std::memory_order_acquire))
+            continue;
+
+        c.Policy = policy;
+        c.Pos.store(startRowAbs < 0 ? EndRowAbs() : startRowAbs, std::memory_order_relaxed);
+        c.Overruns.store(0, std::memory_order_relaxed);
+        c.LostRows.store(0, std::memory_order_relaxed);
+
+        // Backpressure は公開した後に始まる Push から効く（その前に潰れた行は CursorAcquire が直す）
+        if (policy == CursorPolicy::Backpressure)
+            backpressureCursors_.fetch_add(1, std::memory_order_seq_cst);
+        c.State.store(CursorSlot::Active, std::memory_order_seq_cst);
+        return id;
+    }
+    throw std::runtime_error("no free cursor slot");
+}
+
+void LineStore::CloseCursor(int id) noexcept {
+    if (id < 0 || id >= MAX_CURSORS) return;
+    auto& c = cursors_[static_cast<size_t>(id)];
+    int expected = CursorSlot::Active;
+    if (!c.State.compare_exchange_strong(expected, CursorSlot::Opening, std::memory_order_acq_rel))
+        return;
+    if (c.Policy == CursorPolicy::Backpressure)
+        backpressureCursors_.fetch_sub(1, std::memory_order_release);
+    c.State.store(CursorSlot::Free, std::memory_order_release);
+}
+
+// ---- 読み出し ----
+ReadResult LineStore::CursorAcquire(int id, int winH, i64& rowAbs, i64& gapRows) noexcept {
+    rowAbs = -1; gapRows = 0;
+    if (id < 0 || id >= MAX_CURSORS) return ReadResult::InvalidArg;
+    auto& c = cursors_[static_cast<size_t>(id)];
+    if (c.State.load(std::memory_order_acquire) != CursorSlot::Active) return ReadResult::InvalidArg;
+    if (winH <= 0 || winH > capacityLines_) return ReadResult::InvalidArg;
+    if (!committed_.load(std::memory_order_acquire)) return ReadResult::NotReady;
+
+    i64       pos = c.Pos.load(std::memory_order_relaxed); // 書くのはこの reader だけ
+    const i64 end = publishIndex_.load(std::memory_order_acquire);
+
+    if (circular_) {
+        // claim - cap 未満は上書き中/済み（RowsIntact と同じ基準）
+        const i64 oldest = claimIndex_.load(std::memory_order_acquire) - capacityLines_;
+        if (pos < oldest) {
+            const i64 to = (c.Policy == CursorPolicy::SkipToLatest) ? std::max(oldest, end - winH) : oldest;
+            gapRows = to - pos;
+            c.Overruns.fetch_add(1, std::memory_order_relaxed);
+            c.LostRows.fetch_add(gapRows, std::memory_order_relaxed);
+            lostRows_.fetch_add(gapRows, std::memory_order_relaxed);
+            c.Pos.store(to, std::memory_order_release);
+            pos = to;
+            if (c.Policy != CursorPolicy::SkipToLatest) { // 欠落を知らせる（次の呼び出しからは続きを返す）
+                rowAbs = pos;
+                return ReadResult::Overwritten;
+            }
+        }
+    }
+
+    if (pos + winH > end) return ReadResult::NotReady;
+    rowAbs = pos;
+    return ReadResult::Ok;
+}
+
+void LineStore::CursorAdvance(int id, i64 rows) {
+    if (rows < 0) throw std::invalid_argument("rows");
+    auto& c = Cursor(id);
+    // release：ここまでの読み出しを終えてから writer に上書きを許す
+    c.Pos.store(c.Pos.load(std::memory_order_relaxed) + rows, std::memory_order_release);
+}
+
+bool LineStore::CursorWait(int id, int winH, std::chrono::nanoseconds timeout) const noexcept {
+    if (id < 0 || id >= MAX_CURSORS || winH <= 0) return false;
+    const auto& c = cursors_[static_cast<size_t>(id)];
+    if (c.State.load(std::memory_order_acquire) != CursorSlot::Active) return false;
+
+    // HeadTotal はウォームアップで捨てた行も数えるので、絶対行の不足分に換算して待つ。
+    // HeadTotal を先に読む（末尾は先に公開されるので、待ち過ぎることは無い）
+    const i64 head = HeadTotal();
+    const i64 need = c.Pos.load(std::memory_order_relaxed) + winH - EndRowAbs();
+    if (need <= 0 && committed_.load(std::memory_order_acquire)) return true;
+    return WaitForLines(head + std::max<i64>(need, 1), timeout);
+}
+
+CursorInfo LineStore::GetCursorInfo(int id) const {
+    const auto& c = Cursor(id);
+    CursorInfo info;
+    info.Position = c.Pos.load(std::memory_order_acquire);
+    info.Lag      = std::max<i64>(0, EndRowAbs() - info.Position);
+    info.Overruns = c.Overruns.load(std::memory_order_relaxed);
+    info.LostRows = c.LostRows.load(std::memory_order_relaxed);
+    info.Policy   = c.Policy;
+    return info;
+}
+
+// ---- writer ----
+LineStore::i64 LineStore::WritableRows() const noexcept {
+    constexpr i64 UNLIMITED = std::numeric_limits<i64>::max();
+    if (!committed_.load(std::memory_order_relaxed)) return UNLIMITED; // ウォームアップは前詰めで常に入る
+    if (!circular_) return std::max<i64>(0, capacityLines_ - writeIndex_);
+    if (backpressureCursors_.load(std::memory_order_seq_cst) == 0) return UNLIMITED;
+
+    i64 slowest = UNLIMITED;
+    for (const auto& c : cursors_) {
+        if (c.State.load(std::memory_order_seq_cst) != CursorSlot::Active) continue;
+        if (c.Policy != CursorPolicy::Backpressure) continue;
+        slowest = std::min(slowest, c.Pos.load(std::memory_order_acquire));
+    }
+    if (slowest == UNLIMITED) return UNLIMITED;
+    return std::max<i64>(0, slowest + capacityLines_ - writeIndex_);
+}
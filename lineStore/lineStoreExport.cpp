@@ -0,0 +1,583 @@
+// LineStoreExport.cpp
+#include "lineStoreExport.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#if defined(_WIN32)
+  #ifndef NOMINMAX
+    #define NOMINMAX
+  #endif
+  #include <windows.h>
+  #include <malloc.h>
+  #include <filesystem>
+#else
+  #include <fcntl.h>
+  #include <unistd.h>
+  #include <sys/resource.h>
+  #if defined(__linux__)
+    #include <sys/syscall.h>
+  #endif
+#endif
+
+namespace {
+
+using i64 = std::int64_t;
+
+constexpr i64 IO_ALIGN = 4096; // O_DIRECT の境界（論理セクタの最大を想定）
+
+i64 align_up(i64 v, i64 a) { return (v + a - 1) / a * a; }
+
+// ---- 境界合わせの書き込み ----
+// 書き込みは IO_ALIGN の倍数でまとめて出す。最後の半端は 0 で埋めて書き、閉じる前に実サイズへ切り詰める
+class DirectFile
+{
+public:
+    DirectFile(const std::string& path, i64 bufferBytes, bool direct)
+        : cap_(align_up(std::max<i64>(bufferBytes, IO_ALIGN), IO_ALIGN))
+    {
+#if defined(_WIN32)
+        buf_ = static_cast<std::uint8_t*>(_aligned_malloc(static_cast<size_t>(cap_), IO_ALIGN));
+        if (!buf_) throw std::bad_alloc();
+        const auto wpath = std::filesystem::path(path).wstring();
+        const DWORD flags = FILE_ATTRIBUTE_NORMAL | (direct ? (FILE_FLAG_NO_BUFFERING | FILE_FLAG_WRITE_THROUGH) : 0);
+        h_ = CreateFileW(wpath.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, flags, nullptr);
+        if (h_ == INVALID_HANDLE_VALUE && direct)
+            h_ = CreateFileW(wpath.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (h_ == INVALID_HANDLE_VALUE) {
+            _aligned_free(buf_);
+            throw std::runtime_error("cannot create: " + path);
+        }
+#else
+        buf_ = static_cast<std::uint8_t*>(std::aligned_alloc(IO_ALIGN, static_cast<size_t>(cap_)));
+        if (!buf_) throw std::bad_alloc();
+        int flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+  #if defined(O_DIRECT)
+        if (direct) flags |= O_DIRECT;
+  #endif
+        fd_ = ::open(path.c_str(), flags, 0644);
+        if (fd_ < 0 && direct) fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644); // tmpfs など
+        if (fd_ < 0) {
+            std::free(buf_);
+            throw std::runtime_error("cannot create: " + path + " (" + std::strerror(errno) + ")");
+        }
+#endif
+    }
+
+    ~DirectFile() {
+#if defined(_WIN32)
+        if (h_ != INVALID_HANDLE_VALUE) CloseHandle(h_);
+        _aligned_free(buf_);
+#else
+        if (fd_ >= 0) ::close(fd_);
+        std::free(buf_);
+#endif
+    }
+
+    DirectFile(const DirectFile&) = delete;
+    DirectFile& operator=(const DirectFile&) = delete;
+
+    void Append(const void* p, i64 n) {
+        const auto* s = static_cast<const std::uint8_t*>(p);
+        while (n > 0) {
+            const i64 k = std::min(n, cap_ - used_);
+            std::memcpy(buf_ + used_, s, static_cast<size_t>(k));
+            used_ += k; s += k; n -= k;
+            if (used_ == cap_) Flush(cap_);
+        }
+    }
+
+    void AppendZeros(i64 n) {
+        while (n > 0) {
+            const i64 k = std::min(n, cap_ - used_);
+            std::memset(buf_ + used_, 0, static_cast<size_t>(k));
+            used_ += k; n -= k;
+            if (used_ == cap_) Flush(cap_);
+        }
+    }
+
+    i64 Size() const noexcept { return written_ + used_; }
+
+    // 残りを書き、実サイズに切り詰めてディスクまで書き切る
+    void Close() {
+        const i64 size = Size();
+        if (used_ > 0) {
+            const i64 padded = align_up(used_, IO_ALIGN);
+            std::memset(buf_ + used_, 0, static_cast<size_t>(padded - used_));
+            Flush(padded);
+        }
+#if defined(_WIN32)
+        LARGE_INTEGER li; li.QuadPart = size;
+        if (!SetFilePointerEx(h_, li, nullptr, FILE_BEGIN) || !SetEndOfFile(h_) || !FlushFileBuffers(h_))
+            throw std::runtime_error("export: cannot finish file");
+        CloseHandle(h_);
+        h_ = INVALID_HANDLE_VALUE;
+#else
+        if (::ftruncate(fd_, size) != 0) throw std::runtime_error(std::string("export: ftruncate: ") + std::strerror(errno));
+  #if defined(__linux__)
+        ::fdatasync(fd_);
+  #else
+        ::fsync(fd_);
+  #endif
+        ::close(fd_);
+        fd_ = -1;
+#endif
+    }
+
+private:
+    void Flush(i64 n) {
+        const std::uint8_t* p = buf_;
+        i64 left = n;
+        while (left > 0) {
+#if defined(_WIN32)
+            DWORD wrote = 0;
+            const DWORD chunk = static_cast<DWORD>(std::min<i64>(left, 1 << 30));
+            if (!WriteFile(h_, p, chunk, &wrote, nullptr) || wrote == 0)
+                throw std::runtime_error("export: write failed");
+#else
+            const ssize_t wrote = ::write(fd_, p, static_cast<size_t>(left));
+            if (wrote < 0 && errno == EINTR) continue;
+            if (wrote <= 0) throw std::runtime_error(std::string("export: write: ") + std::strerror(errno));
+#endif
+            p += wrote; left -= static_cast<i64>(wrote);
+        }
+        // 途中の Flush は常に cap_ 全体（境界の倍数）なので、ファイル位置も境界にそろったまま
+        written_ += std::min(n, used_);
+        used_ = 0;
+    }
+
+    i64           cap_;
+    std::uint8_t* buf_  = nullptr;
+    i64           used_ = 0;
+    i64           written_ = 0;
+#if defined(_WIN32)
+    HANDLE h_ = INVALID_HANDLE_VALUE;
+#else
+    int fd_ = -1;
+#endif
+};
+
+// ---- タイル TIFF のヘッダ ----
+// 非圧縮のタイルは全部同じ大きさなので、タイルの位置表まで先頭で確定できる（後から戻って書き直さない）。
+// [ヘッダ 8][IFD][TileOffsets][TileByteCounts][0 埋め → IO_ALIGN 境界][タイル…]
+struct TiffLayout
+{
+    std::vector<std::uint8_t> Head; // 画素の手前まで（IO_ALIGN の倍数）
+    i64                       TileBytes;
+};
+
+void put16(std::vector<std::uint8_t>& v, size_t at, std::uint16_t x) { std::memcpy(v.data() + at, &x, 2); }
+void put32(std::vector<std::uint8_t>& v, size_t at, std::uint32_t x) { std::memcpy(v.data() + at, &x, 4); }
+
+TiffLayout tiff_layout(int width, i64 height, int elemBytes, int tw, int tl) {
+    static_assert(sizeof(std::uint16_t) == 2 && sizeof(std::uint32_t) == 4);
+    const i64 across = (width + tw - 1) / tw;
+    const i64 down   = (height + tl - 1) / tl;
+    const i64 tiles  = across * down;
+
+    constexpr int ENTRIES = 12;
+    const i64 ifdOff    = 8;
+    const i64 arraysOff = align_up(ifdOff + 2 + ENTRIES * 12 + 4, 4);
+    const i64 countsOff = arraysOff + tiles * 4;
+    const i64 dataOff   = align_up(countsOff + tiles * 4, IO_ALIGN);
+
+    TiffLayout lay;
+    lay.TileBytes = static_cast<i64>(tw) * tl * elemBytes;
+    if (dataOff + tiles * lay.TileBytes > 0xFFFFFFFFLL)
+        throw std::invalid_argument("export too large for TIFF (use ExportFormat::Raw)");
+
+    auto& h = lay.Head;
+    h.assign(static_cast<size_t>(dataOff), 0);
+    h[0] = 'I'; h[1] = 'I';         // little endian
+    put16(h, 2, 42);
+    put32(h, 4, static_cast<std::uint32_t>(ifdOff));
+
+    size_t e = static_cast<size_t>(ifdOff);
+    put16(h, e, ENTRIES); e += 2;
+    // タグ順に並べる。型 3 = SHORT, 4 = LONG。値が 4 バイトに入れば直接、入らなければ位置
+    auto entry = [&](std::uint16_t tag, std::uint16_t type, std::uint32_t count, std::uint32_t value) {
+        put16(h, e, tag); put16(h, e + 2, type); put32(h, e + 4, count);
+        if (type == 3 && count == 1) put16(h, e + 8, static_cast<std::uint16_t>(value));
+        else                         put32(h, e + 8, value);
+        e += 12;
+    };
+    const bool inlineArrays = (tiles == 1);
+    entry(256, 4, 1, static_cast<std::uint32_t>(width));       // ImageWidth
+    entry(257, 4, 1, static_cast<std::uint32_t>(height));      // ImageLength
+    entry(258, 3, 1, static_cast<std::uint32_t>(elemBytes * 8)); // BitsPerSample
+    entry(259, 3, 1, 1);                                       // Compression: none
+    entry(262, 3, 1, 1);                                       // Photometric: BlackIsZero
+    entry(277, 3, 1, 1);                                       // SamplesPerPixel
+    entry(284, 3, 1, 1);                                       // PlanarConfiguration: chunky
+    entry(322, 4, 1, static_cast<std::uint32_t>(tw));          // TileWidth
+    entry(323, 4, 1, static_cast<std::uint32_t>(tl));          // TileLength
+    entry(324, 4, static_cast<std::uint32_t>(tiles), inlineArrays ? static_cast<std::uint32_t>(dataOff) : static_cast<std::uint32_t>(arraysOff));
+    entry(325, 4, static_cast<std::uint32_t>(tiles), inlineArrays ? static_cast<std::uint32_t>(lay.TileBytes) : static_cast<std::uint32_t>(countsOff));
+    entry(339, 3, 1, 1);                                       // SampleFormat: unsigned
+    put32(h, e, 0);                                            // 次の IFD は無し
+
+    if (!inlineArrays) {
+        for (i64 i = 0; i < tiles; ++i) {
+            put32(h, static_cast<size_t>(arraysOff + i * 4), static_cast<std::uint32_t>(dataOff + i * lay.TileBytes));
+            put32(h, static_cast<size_t>(countsOff + i * 4), static_cast<std::uint32_t>(lay.TileBytes));
+        }
+    }
+    return lay;
+}
+
+// I/O スレッドの優先度を下げる（失敗しても続ける）
+void lower_thread_priority() noexcept {
+#if defined(_WIN32)
+    SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_BEGIN); // CPU / I/O / メモリ優先度
+#elif defined(__linux__)
+    const auto tid = static_cast<id_t>(::syscall(SYS_gettid));
+    (void)::setpriority(PRIO_PROCESS, tid, 10);
+    constexpr int IOPRIO_WHO_PROCESS = 1, IOPRIO_CLASS_BE = 2, IOPRIO_CLASS_SHIFT = 13;
+    (void)::syscall(SYS_ioprio_set, IOPRIO_WHO_PROCESS, 0, (IOPRIO_CLASS_BE << IOPRIO_CLASS_SHIFT) | 7);
+#endif
+}
+
+bool terminal(ExportState s) { return s == ExportState::Done || s == ExportState::Failed || s == ExportState::Canceled; }
+
+} // namespace
+
+// ---- 生成/破棄 ----
+LineStoreExporter::LineStoreExporter(LineStore& store, const ExportOptions& opt)
+    : store_(store)
+    , opt_(opt)
+    , nextId_(1)
+    , stop_(false)
+{
+    if (opt_.IoBufferBytes <= 0) throw std::out_of_range("IoBufferBytes");
+    if (opt_.MaxPinBytes < 0)    throw std::out_of_range("MaxPinBytes");
+    if (opt_.KeepFinished < 0)   throw std::out_of_range("KeepFinished");
+    worker_ = std::thread([this] { WorkerLoop(); });
+}
+
+LineStoreExporter::~LineStoreExporter() {
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        stop_ = true;
+        for (auto& kv : jobs_) kv.second->Cancel.store(true, std::memory_order_relaxed);
+    }
+    cv_.notify_all();
+    if (worker_.joinable()) worker_.join();
+}
+
+// ---- 依頼 ----
+int LineStoreExporter::Submit(const ExportRequest& req) {
+    if (req.Path.empty()) throw std::invalid_argument("Path");
+    if (req.RowBegin < 0 || req.RowEnd <= req.RowBegin) throw std::out_of_range("RowBegin / RowEnd");
+    if (req.X0 < 0 || req.X0 >= store_.Width() || req.Width < 0 || req.X0 + req.Width > store_.Width())
+        throw std::out_of_range("X0 / Width");
+    if (req.Format == ExportFormat::TiledTiff &&
+        (req.TileWidth <= 0 || req.TileLength <= 0 || req.TileWidth % 16 != 0 || req.TileLength % 16 != 0))
+        throw std::invalid_argument("TileWidth / TileLength must be positive multiples of 16");
+
+    auto job = std::make_shared<Job>();
+    job->Req = req;
+    if (job->Req.Width == 0) job->Req.Width = store_.Width() - req.X0;
+
+    // もう押し出された行（コールド層にも無い）から始まる依頼は受けない
+    if (req.RowBegin < store_.ColdOldestRowAbs()) throw std::out_of_range("RowBegin already overwritten");
+    if (req.PinRows) Pin(*job);
+
+    int id;
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        id      = nextId_++;
+        job->Id = id;
+        jobs_.emplace(id, job);
+        queue_.push_back(job);
+    }
+    cv_.notify_all();
+    return id;
+}
+
+int LineStoreExporter::SubmitTimeRange(double t0, double t1, ExportRequest req) {
+    i64 b, e;
+    if (!store_.GetRowRangeForTimes(t0, t1, b, e)) throw std::out_of_range("no rows in time range");
+    req.RowBegin = b;
+    req.RowEnd   = e;
+    return Submit(req);
+}
+
+// リングにある範囲の行を時刻ごと写す（writer は止めない）。
+// 時刻を先に引き、写した後の検証（TryCopyWindow）で引いている間も行が残っていたことを確かめる。
+// 写している間に追い越されたら残っている行からやり直し、追いつけなければ写さない（I/O スレッドが読めるところまで読む）
+void LineStoreExporter::Pin(Job& job) const {
+    const auto& req   = job.Req;
+    const i64   lineB = static_cast<i64>(req.Width) * store_.ElemSizeBytes();
+
+    for (int attempt = 0; attempt < 4; ++attempt) {
+        const i64 b = std::max(req.RowBegin, store_.OldestRowAbs());
+        const i64 e = std::min(req.RowEnd, store_.EndRowAbs());
+        if (b >= e) return; // まだ書かれていない
+        if ((e - b) * lineB > opt_.MaxPinBytes)
+            throw std::length_error("export range exceeds MaxPinBytes (use PinRows=false or a smaller range)");
+
+        job.Pinned.resize(static_cast<size_t>((e - b) * lineB));
+        job.PinnedTimes.resize(static_cast<size_t>(e - b));
+        bool timed = true;
+        for (i64 r = b; r < e && timed; ++r) timed = store_.RowTimeSec(r, job.PinnedTimes[static_cast<size_t>(r - b)]);
+
+        double t;
+        if (timed && store_.TryCopyWindow(b, req.Width, static_cast<int>(e - b), req.X0,
+                                          job.Pinned.data(), static_cast<int>(lineB), t) == ReadResult::Ok) {
+            job.PinBegin = b;
+            job.PinEnd   = e;
+            return;
+        }
+    }
+    job.Pinned      = {};
+    job.PinnedTimes = {};
+}
+
+ExportStatus LineStoreExporter::Status(int id) {
+    std::lock_guard<std::mutex> lk(mutex_);
+    const auto it = jobs_.find(id);
+    if (it == jobs_.end()) throw std::out_of_range("export id");
+    const Job& j = *it->second;
+
+    ExportStatus st;
+    st.State     = j.State;
+    st.RowsDone  = j.RowsDone.load(std::memory_order_relaxed);
+    st.RowsTotal = j.Req.RowEnd - j.Req.RowBegin;
+    st.Error     = j.Error;
+    st.LostRow   = j.LostRow.load(std::memory_order_relaxed);
+
+    // 終わった依頼は取りに来たところで消す
+    if (terminal(j.State)) {
+        finished_.erase(std::find(finished_.begin(), finished_.end(), id));
+        jobs_.erase(it);
+    }
+    return st;
+}
+
+bool LineStoreExporter::Wait(int id, std::chrono::nanoseconds timeout) const {
+    std::unique_lock<std::mutex> lk(mutex_);
+    const auto it = jobs_.find(id);
+    if (it == jobs_.end()) throw std::out_of_range("export id");
+    const auto job  = it->second;
+    const auto done = [&] { return terminal(job->State); };
+
+    if (timeout == std::chrono::nanoseconds::max()) { cv_.wait(lk, done); return true; }
+    return cv_.wait_for(lk, timeout, done);
+}
+
+void LineStoreExporter::Cancel(int id) {
+    std::shared_ptr<Job> queued;
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        const auto it = jobs_.find(id);
+        if (it == jobs_.end()) throw std::out_of_range("export id");
+        it->second->Cancel.store(true, std::memory_order_relaxed);
+
+        // まだ始まっていなければここで終える（写した行をすぐ放す）
+        const auto q = std::find(queue_.begin(), queue_.end(), it->second);
+        if (q != queue_.end()) {
+            queued = *q;
+            queue_.erase(q);
+        }
+    }
+    if (queued) Finish(*queued, ExportState::Canceled, {});
+}
+
+void LineStoreExporter::Finish(Job& job, ExportState state, const std::string& error) {
+    job.Pinned      = {};
+    job.PinnedTimes = {};
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        job.State = state;
+        job.Error = error;
+
+        // 取りに来ないまま溜まった終わった依頼は古いものから消す
+        finished_.push_back(job.Id);
+        while (finished_.size() > static_cast<size_t>(opt_.KeepFinished)) {
+            jobs_.erase(finished_.front());
+            finished_.pop_front();
+        }
+    }
+    cv_.notify_all();
+}
+
+// ---- I/O スレッド ----
+void LineStoreExporter::WorkerLoop() {
+    if (opt_.LowPriority) lower_thread_priority();
+
+    for (;;) {
+        std::shared_ptr<Job> job;
+        {
+            std::unique_lock<std::mutex> lk(mutex_);
+            cv_.wait(lk, [&] { return stop_ || !queue_.empty(); });
+            if (stop_) break;
+            job = queue_.front();
+            queue_.pop_front();
+            job->State = ExportState::Running;
+        }
+        cv_.notify_all();
+
+        try {
+            Run(*job);
+            Finish(*job, job->Cancel.load(std::memory_order_relaxed) ? ExportState::Canceled : ExportState::Done, {});
+        } catch (const std::exception& ex) {
+            Finish(*job, ExportState::Failed, ex.what());
+        }
+    }
+
+    // 停止：残りの依頼は取り消し（写した行を放す）
+    std::deque<std::shared_ptr<Job>> rest;
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        rest.swap(queue_);
+    }
+    for (auto& j : rest) Finish(*j, ExportState::Canceled, {});
+}
+
+bool LineStoreExporter::ReadRows(Job& job, i64 row, int n, std::uint8_t* dst, int dstStride, double* times) {
+    // [row, end) のうち [pb, pe) は Submit で写した行、その前後はストアから
+    const i64 end   = row + n;
+    const i64 pb    = std::clamp(job.PinBegin, row, end);
+    const i64 pe    = std::clamp(job.PinEnd, pb, end);
+    const i64 lineB = static_cast<i64>(job.Req.Width) * store_.ElemSizeBytes();
+
+    if (pb > row && !ReadRowsFromStore(job, row, static_cast<int>(pb - row), dst, dstStride, times)) return false;
+    for (i64 r = pb; r < pe; ++r) {
+        std::memcpy(dst + (r - row) * dstStride, job.Pinned.data() + (r - job.PinBegin) * lineB, static_cast<size_t>(lineB));
+        if (!times) continue;
+        // 写した時点で最後の Push だった行の時刻は外挿なので、まだリングにあれば今の時刻を使う
+        // （引いた後も最古の行より新しければ、時間セグメントは捨てられていない）
+        double t;
+        const bool live = store_.RowTimeSec(r, t) && r >= store_.OldestRowAbs();
+        times[r - row] = live ? t : job.PinnedTimes[static_cast<size_t>(r - job.PinBegin)];
+    }
+    if (pe < end)
+        return ReadRowsFromStore(job, pe, static_cast<int>(end - pe), dst + (pe - row) * dstStride, dstStride,
+                                 times ? times + (pe - row) : nullptr);
+    return true;
+}
+
+bool LineStoreExporter::ReadRowsFromStore(Job& job, i64 row, int n, std::uint8_t* dst, int dstStride, double* times) {
+    const auto& req = job.Req;
+    const int   cap = static_cast<int>(std::min<i64>(store_.CapacityLines(), 1 << 20));
+
+    for (int done = 0; done < n;) {
+        if (job.Cancel.load(std::memory_order_relaxed)) return false;
+
+        // 時刻を先に引く（写した後の検証が通れば、引いている間も行は残っていた = 時刻は正しい）
+        const int k     = std::min(n - done, cap);
+        bool      timed = true;
+        if (times)
+            for (int i = 0; i < k && timed; ++i) timed = store_.RowTimeSec(row + done + i, times[done + i]);
+
+        double     t = 0.0;
+        const auto r = store_.TryCopyWindow(row + done, req.Width, k, req.X0,
+                                            dst + static_cast<i64>(done) * dstStride, dstStride, t);
+        switch (r) {
+        case ReadResult::Ok:
+            if (timed) done += k; // 引いた後に書かれた行があれば引き直す
+            break;
+        case ReadResult::NotReady: { // まだ書かれていない（未 Commit も）
+            const i64 need = row + done + k - store_.EndRowAbs();
+            store_.WaitForLines(store_.HeadTotal() + std::max<i64>(need, 1), std::chrono::milliseconds(100));
+            break;
+        }
+        case ReadResult::Overwritten:
+            job.LostRow.store(row + done, std::memory_order_relaxed);
+            throw std::runtime_error("rows overwritten before export (row " + std::to_string(row + done) + ")");
+        default:
+            throw std::invalid_argument("export window");
+        }
+    }
+    return true;
+}
+
+void LineStoreExporter::Run(Job& job) {
+    const auto& req   = job.Req;
+    const int   eb    = store_.ElemSizeBytes();
+    const int   w     = req.Width;
+    const i64   rows  = req.RowEnd - req.RowBegin;
+    const i64   lineB = static_cast<i64>(w) * eb;
+
+    // 取り消し・失敗で途中までのファイルを残さない
+    struct Cleanup
+    {
+        const ExportRequest& Req;
+        bool                 Keep = false;
+        ~Cleanup() {
+            if (Keep) return;
+            std::remove(Req.Path.c_str());
+            if (Req.TimeSidecar) std::remove((Req.Path + ".times.csv").c_str());
+        }
+    } cleanup{ req };
+
+    std::unique_ptr<std::FILE, int (*)(std::FILE*)> side(nullptr, &std::fclose);
+    if (req.TimeSidecar) {
+        side.reset(std::fopen((req.Path + ".times.csv").c_str(), "w"));
+        if (!side) throw std::runtime_error("cannot create: " + req.Path + ".times.csv");
+        std::fprintf(side.get(), "# width=%d height=%lld pixel=%s time_origin_ns=%lld\nrow,time_sec\n",
+                     w, static_cast<long long>(rows), eb == 1 ? "u8" : "u16",
+                     static_cast<long long>(store_.TimeOriginNs()));
+    }
+    std::vector<double> times;
+    auto write_times = [&](i64 row0, int n) {
+        if (!side) return;
+        for (int i = 0; i < n; ++i)
+            std::fprintf(side.get(), "%lld,%.9f\n", static_cast<long long>(row0 + i), times[static_cast<size_t>(i)]);
+    };
+
+    DirectFile file(req.Path, opt_.IoBufferBytes, opt_.DirectIo);
+
+    if (req.Format == ExportFormat::Raw) {
+        const int batch = static_cast<int>(std::clamp<i64>(opt_.IoBufferBytes / std::max<i64>(lineB, 1), 1, rows));
+        std::vector<std::uint8_t> buf(static_cast<size_t>(batch * lineB));
+        if (side) times.resize(static_cast<size_t>(batch));
+        for (i64 r = 0; r < rows;) {
+            const int n = static_cast<int>(std::min<i64>(batch, rows - r));
+            if (!ReadRows(job, req.RowBegin + r, n, buf.data(), static_cast<int>(lineB), side ? times.data() : nullptr)) return;
+            job.RowsDone.fetch_add(n, std::memory_order_relaxed);
+            file.Append(buf.data(), n * lineB);
+            write_times(req.RowBegin + r, n);
+            r += n;
+        }
+    } else {
+        const int  tw  = req.TileWidth;
+        const int  tl  = req.TileLength;
+        const auto lay = tiff_layout(w, rows, eb, tw, tl);
+        file.Append(lay.Head.data(), static_cast<i64>(lay.Head.size()));
+
+        // タイルの高さぶんの行（帯）を写してから、左から順にタイルを書く。下端・右端は 0 で埋める
+        std::vector<std::uint8_t> strip(static_cast<size_t>(tl * lineB));
+        if (side) times.resize(static_cast<size_t>(tl));
+        const i64 across = (w + tw - 1) / tw;
+        for (i64 r = 0; r < rows;) {
+            const int n = static_cast<int>(std::min<i64>(tl, rows - r));
+            if (!ReadRows(job, req.RowBegin + r, n, strip.data(), static_cast<int>(lineB), side ? times.data() : nullptr)) return;
+            job.RowsDone.fetch_add(n, std::memory_order_relaxed);
+
+            for (i64 tx = 0; tx < across; ++tx) {
+                const i64 x0    = tx * tw * eb;
+                const i64 valid = std::min<i64>(static_cast<i64>(tw) * eb, lineB - x0);
+                for (int y = 0; y < tl; ++y) {
+                    if (y < n) {
+                        file.Append(strip.data() + y * lineB + x0, valid);
+                        file.AppendZeros(static_cast<i64>(tw) * eb - valid);
+                    } else {
+                        file.AppendZeros(static_cast<i64>(tw) * eb);
+                    }
+                }
+            }
+            write_times(req.RowBegin + r, n);
+            r += n;
+        }
+    }
+
+    file.Close();
+    if (side && std::fflush(side.get()) != 0) throw std::runtime_error("cannot write: " + req.Path + ".times.csv");
+    cleanup.Keep = true;
+}
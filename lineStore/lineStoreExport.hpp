@@ -0,0 +1,139 @@
+#pragma once
+// LineStoreExport.hpp
+// LineStore の行範囲をバックグラウンドでファイルへ書き出す（タイル TIFF / raw + 時刻のサイドカー）
+//
+// 書き出しは優先度を下げた専用の I/O スレッド 1 本で、依頼順に 1 件ずつ行う。
+// 行は TryCopyWindow で写してから（コールド層があれば押し出された行も）書くので、取り込みの writer とは競合しない。
+// PinRows なら Submit の時点でリングに残っている範囲の行（と時刻）を写して持つ。writer は止めない（行も捨てさせない）。
+// 写せなかった行（まだ書かれていない行・PinRows=false）は I/O スレッドが追いかけて読み、読む前に上書きされていれば
+// その依頼は Failed になる（ExportStatus::LostRow に読めなかった最初の行）。
+// ファイルは O_DIRECT（Windows は FILE_FLAG_NO_BUFFERING）で大きな境界合わせの書き込みにする（使えなければ通常の書き込み）
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "lineStore2.hpp"
+
+enum class ExportFormat
+{
+    TiledTiff, // 非圧縮・グレースケールのタイル TIFF（4 GiB まで）
+    Raw,       // 行を詰めて並べただけ（Width * 要素サイズ バイト / 行）
+};
+
+enum class ExportState
+{
+    Queued,
+    Running,
+    Done,
+    Failed,
+    Canceled,
+};
+
+struct ExportRequest
+{
+    std::int64_t RowBegin = 0; // 絶対行の半開区間 [RowBegin, RowEnd)。まだ書かれていない行は書かれるまで待つ
+    std::int64_t RowEnd   = 0;
+    std::string  Path;
+    ExportFormat Format = ExportFormat::TiledTiff;
+
+    int X0    = 0; // ROI 内の列 [X0, X0 + Width)。Width = 0 なら X0 から右端まで
+    int Width = 0;
+
+    int TileWidth  = 256; // TiledTiff：16 の倍数
+    int TileLength = 256;
+
+    bool PinRows     = true; // Submit の時点でリングにある範囲の行を写して持つ（ROI 幅 × 行数のメモリ。MaxPinBytes まで）
+    bool TimeSidecar = true; // Path + ".times.csv" に行ごとの時刻（row,time_sec）
+};
+
+struct ExportStatus
+{
+    ExportState  State     = ExportState::Queued;
+    std::int64_t RowsDone  = 0;
+    std::int64_t RowsTotal = 0;
+    std::string  Error;        // Failed のときの理由
+    std::int64_t LostRow   = -1; // 書き出す前に上書きされて Failed になったとき、読めなかった最初の絶対行
+};
+
+struct ExportOptions
+{
+    int  IoBufferBytes = 8 << 20; // 1 回の書き込みの大きさ（4 KiB の倍数に切り上げ）
+    bool DirectIo      = true;    // O_DIRECT / FILE_FLAG_NO_BUFFERING（ページキャッシュを汚さない）
+    bool LowPriority   = true;    // I/O スレッドの CPU / I/O 優先度を下げる
+
+    std::int64_t MaxPinBytes  = std::int64_t{ 1 } << 30; // PinRows で 1 件に写す上限（超える依頼は Submit で例外）
+    int          KeepFinished = 64; // 終わった依頼を Status 用に残す件数（古いものから消す）
+};
+
+class LineStoreExporter
+{
+public:
+    using i64 = std::int64_t;
+
+    // store は Commit 済みであること（exporter より長く生きること）
+    explicit LineStoreExporter(LineStore& store, const ExportOptions& opt = {});
+    ~LineStoreExporter(); // 待っている依頼・書き出し中の依頼は取り消す
+
+    LineStoreExporter(const LineStoreExporter&) = delete;
+    LineStoreExporter& operator=(const LineStoreExporter&) = delete;
+
+    // 依頼を積んで id を返す。PinRows ならこの時点でリングにある行を写す
+    int Submit(const ExportRequest& req);
+    // 時刻 [t0, t1] の行（GetRowRangeForTimes）を書き出す。該当行が無ければ例外
+    int SubmitTimeRange(double t0, double t1, ExportRequest req);
+
+    // 終わった（Done / Failed / Canceled）依頼はこれで状態を返した時点で消える（以後その id は out_of_range）。
+    // 取りに来なくても KeepFinished 件を超えたら古いものから消える
+    ExportStatus Status(int id);
+    // 終わる（Done / Failed / Canceled）まで待つ。終わっていれば true
+    bool Wait(int id, std::chrono::nanoseconds timeout = std::chrono::nanoseconds::max()) const;
+    void Cancel(int id);
+
+private:
+    struct Job
+    {
+        int               Id = 0;
+        ExportRequest     Req;
+        ExportState       State  = ExportState::Queued; // mutex_ で保護
+        std::string       Error;                        // mutex_ で保護
+        std::atomic<i64>  RowsDone{0};
+        std::atomic<i64>  LostRow{-1};
+        std::atomic<bool> Cancel{false};
+
+        // PinRows で写した行 [PinBegin, PinEnd)（行間隔 = Width * 要素サイズ）と行ごとの時刻
+        i64                       PinBegin = 0;
+        i64                       PinEnd   = 0;
+        std::vector<std::uint8_t> Pinned;
+        std::vector<double>       PinnedTimes;
+    };
+
+    void WorkerLoop();
+    void Pin(Job& job) const;          // Submit から
+    void Run(Job& job);                // 失敗は例外
+    void Finish(Job& job, ExportState state, const std::string& error);
+    // [row, row + n) を dst へ写し（まだ書かれていなければ待つ）、times があれば行ごとの時刻も入れる。取り消されたら false
+    bool ReadRows(Job& job, i64 row, int n, std::uint8_t* dst, int dstStride, double* times);
+    bool ReadRowsFromStore(Job& job, i64 row, int n, std::uint8_t* dst, int dstStride, double* times);
+
+    LineStore&    store_;
+    ExportOptions opt_;
+
+    mutable std::mutex              mutex_;
+    mutable std::condition_variable cv_;       // 依頼の追加・状態の変化
+    std::map<int, std::shared_ptr<Job>> jobs_;     // 待ち・実行中・まだ取りに来ていない終わった依頼
+    std::deque<std::shared_ptr<Job>>    queue_;
+    std::deque<int>                     finished_; // 終わった順（KeepFinished を超えたら古いものから jobs_ から消す）
+    int  nextId_;
+    bool stop_;
+
+    std::thread worker_;
+};
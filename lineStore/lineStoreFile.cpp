@@ -0,0 +1,383 @@
+// LineStoreFile.cpp
+// ファイルバック LineStore（作成 / 読み取り専用・再開で再オープン / 書き戻し / スナップショット）
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <initializer_list>
+#include <stdexcept>
+#include "lineStore2.hpp"
+
+#if defined(_WIN32)
+  #ifndef NOMINMAX
+    #define NOMINMAX
+  #endif
+  #include <windows.h>
+#else
+  #include <fcntl.h>
+  #include <unistd.h>
+#endif
+
+namespace {
+
+constexpr std::int64_t HEADER_BYTES = 4096;
+constexpr std::int64_t DATA_ALIGN   = 64 * 1024; // Windows の割り当て粒度にも揃う
+
+std::int64_t align_up(std::int64_t v, std::int64_t a) {
+    return (v + a - 1) / a * a;
+}
+
+LineStoreFileHeader read_header(const std::string& path) {
+    LineStoreFileHeader h{};
+    {
+        std::ifstream f(path, std::ios::binary);
+        if (!f) throw std::runtime_error("cannot open: " + path);
+        f.read(reinterpret_cast<char*>(&h), sizeof(h));
+        if (!f) throw std::runtime_error("short header: " + path);
+    }
+    if (std::memcmp(h.Magic, LineStoreFileHeader::MAGIC, sizeof(h.Magic)) != 0)
+        throw std::runtime_error("not a LineStore file: " + path);
+    // 旧版のヘッダは短いだけで、足りない欄は 0（ファイル作成時に 0 埋め）
+    if (h.Version == 0 || h.Version > LineStoreFileHeader::VERSION || h.HeaderBytes > sizeof(LineStoreFileHeader))
+        throw std::runtime_error("unsupported LineStore file version: " + path);
+    return h;
+}
+
+// ---- 電源断でも残る書き出し ----
+// tmp に parts を順に書いてディスクまで書き切り、path へ置き換える（置き換えもディレクトリごと書き切る）。
+// 途中で止まっても path は前の中身のまま
+struct Part
+{
+    const void*  Data;
+    std::int64_t Bytes;
+};
+
+void write_file_durable(const std::string& path, const std::string& tmp, std::initializer_list<Part> parts) {
+#if defined(_WIN32)
+    const auto wtmp  = std::filesystem::path(tmp).wstring();
+    const auto wpath = std::filesystem::path(path).wstring();
+    HANDLE h = CreateFileW(wtmp.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (h == INVALID_HANDLE_VALUE) throw std::runtime_error("cannot create: " + tmp);
+    bool ok = true;
+    for (const auto& p : parts) {
+        const auto*  b    = static_cast<const std::uint8_t*>(p.Data);
+        std::int64_t left = p.Bytes;
+        while (ok && left > 0) {
+            DWORD wrote = 0;
+            const DWORD chunk = static_cast<DWORD>(std::min<std::int64_t>(left, 1 << 30));
+            ok = WriteFile(h, b, chunk, &wrote, nullptr) && wrote > 0;
+            b += wrote; left -= wrote;
+        }
+    }
+    ok = ok && FlushFileBuffers(h);
+    CloseHandle(h);
+    if (!ok || !MoveFileExW(wtmp.c_str(), wpath.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+        DeleteFileW(wtmp.c_str());
+        throw std::runtime_error("cannot write: " + path + " (" + std::to_string(GetLastError()) + ")");
+    }
+#else
+    auto fail = [&](const char* what) {
+        const std::string msg = std::string(what) + ": " + path + " (" + std::strerror(errno) + ")";
+        ::unlink(tmp.c_str());
+        throw std::runtime_error(msg);
+    };
+
+    const int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) throw std::runtime_error("cannot create: " + tmp + " (" + std::strerror(errno) + ")");
+    bool ok = true;
+    for (const auto& p : parts) {
+        const auto*  b    = static_cast<const std::uint8_t*>(p.Data);
+        std::int64_t left = p.Bytes;
+        while (ok && left > 0) {
+            const ssize_t n = ::write(fd, b, static_cast<size_t>(std::min<std::int64_t>(left, 1 << 30)));
+            if (n < 0 && errno == EINTR) continue;
+            ok = (n > 0);
+            if (ok) { b += n; left -= n; }
+        }
+    }
+    #if defined(__linux__)
+    ok = ok && ::fdatasync(fd) == 0;
+    #else
+    ok = ok && ::fsync(fd) == 0;
+    #endif
+    if (::close(fd) != 0) ok = false;
+    if (!ok) fail("cannot write");
+    if (::rename(tmp.c_str(), path.c_str()) != 0) fail("cannot rename");
+
+    // 置き換え（ディレクトリの項目）も書き切る
+    const auto dir = std::filesystem::path(path).parent_path();
+    const int  dfd = ::open(dir.empty() ? "." : dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dfd >= 0) {
+        ::fsync(dfd);
+        ::close(dfd);
+    }
+#endif
+}
+
+// 構成はファイルのものに置き換える
+void apply_header(LineStoreOptions& opt, const LineStoreFileHeader& h, const std::string& path) {
+    opt.Circular           = (h.Circular != 0);
+    opt.Mirrored           = false;
+    opt.PowerOfTwoCapacity = false; // 容量は切り上げ済み
+    opt.Source             = static_cast<SourceFormat>(h.SourceFormat);
+    opt.SourceShift        = h.SourceShift;
+    opt.RowAlignBytes      = h.RowAlignBytes;
+    opt.SteadyTime         = (h.SteadyTime != 0);
+    opt.FilePath           = path;
+    opt.FileSegCapacity    = h.SegCapacity;
+}
+
+} // namespace
+
+// ---- 読み取り専用で開く ----
+std::unique_ptr<LineStore> LineStore::OpenReadOnly(const std::string& path) {
+    const LineStoreFileHeader h = read_header(path);
+
+    LineStoreOptions opt;
+    apply_header(opt, h, path);
+    opt.Memory.FileReadOnly = true;
+
+    return std::make_unique<LineStore>(h.SourceWidth, h.RoiX, h.Width, h.CapacityLines, h.WarmupMax,
+                                       static_cast<PixelType>(h.PixelType), opt);
+}
+
+// ---- 再開（読み書きで開き直す）----
+std::unique_ptr<LineStore> LineStore::OpenResume(const std::string& path, const LineStoreOptions& options) {
+    if (options.BinLevels != 0 || options.LineMeta || options.AdoptFrames)
+        throw std::invalid_argument("OpenResume does not support BinLevels / LineMeta / AdoptFrames");
+    const LineStoreFileHeader h = read_header(path);
+
+    LineStoreOptions opt = options;
+    apply_header(opt, h, path);
+    opt.Memory.FileReadOnly     = false;
+    opt.Memory.FileOpenExisting = true;
+
+    return std::make_unique<LineStore>(h.SourceWidth, h.RoiX, h.Width, h.CapacityLines, h.WarmupMax,
+                                       static_cast<PixelType>(h.PixelType), opt);
+}
+
+bool LineStore::ReadOnly() const noexcept { return readOnly_; }
+
+// ---- 作成 / マップ ----
+void LineStore::OpenFile(const LineStoreOptions& opt) {
+    if (opt.FileSegCapacity <= 0) throw std::out_of_range("FileSegCapacity");
+
+    LineStoreFileHeader layout{};
+    InitFileHeader(layout, opt.FileSegCapacity);
+
+    LineMemoryOptions mopt = opt.Memory;
+    mopt.Mirrored        = opt.Mirrored;
+    mopt.FilePath        = opt.FilePath;
+    mopt.FileHeaderBytes = static_cast<size_t>(layout.DataOffset);
+    memory_ = LineMemory(static_cast<size_t>(layout.DataBytes), mopt);
+    buf_    = memory_.Data();
+
+    fileHeader_      = reinterpret_cast<LineStoreFileHeader*>(memory_.FileHeader());
+    fileSegs_        = reinterpret_cast<TimeSeg*>(memory_.FileHeader() + layout.SegOffset);
+    fileWarmupTimes_ = reinterpret_cast<double*>(memory_.FileHeader() + layout.WarmupTimesOffset);
+    readOnly_        = mopt.FileReadOnly;
+
+    if (readOnly_ || mopt.FileOpenExisting) {
+        auto& h = *fileHeader_;
+        if (h.DataOffset != layout.DataOffset || h.DataBytes != layout.DataBytes || h.SegOffset != layout.SegOffset)
+            throw std::runtime_error("LineStore file layout mismatch: " + opt.FilePath);
+        RestoreFromFile();
+        if (readOnly_) {
+            fileSegs_        = nullptr; // 書き込まない
+            fileWarmupTimes_ = nullptr;
+            return;
+        }
+
+        // 再開：以降の Push はこのヘッダを更新する（旧版のファイルは今の版に上げる）
+        h.Version     = LineStoreFileHeader::VERSION;
+        h.HeaderBytes = sizeof(LineStoreFileHeader);
+        flushedIndex_ = writeIndex_;
+        SyncFileState();
+        if (committed_.load(std::memory_order_relaxed)) StartCold(); // Commit は済んでいるので呼ばれない
+    } else {
+        auto& h = *fileHeader_;
+        h = layout;
+        std::memcpy(fileWarmupTimes_, warmupTimes_.data(), warmupTimes_.size() * sizeof(double)); // 未充填は NaN
+        SyncFileState();
+    }
+
+    if (flushIntervalMs_ > 0)
+        flushThread_ = std::thread([this] { FlushLoop(); });
+}
+
+// 構成欄と各領域のオフセット（状態欄は 0）
+void LineStore::InitFileHeader(LineStoreFileHeader& h, i64 segCapacity) const noexcept {
+    const std::int64_t warmupOff = HEADER_BYTES;
+    const std::int64_t segOff    = align_up(warmupOff + static_cast<std::int64_t>(warmupMax_) * sizeof(double), HEADER_BYTES);
+    const std::int64_t dataOff   = align_up(segOff + segCapacity * static_cast<std::int64_t>(sizeof(TimeSeg)), DATA_ALIGN);
+
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.Magic, LineStoreFileHeader::MAGIC, sizeof(h.Magic));
+    h.Version           = LineStoreFileHeader::VERSION;
+    h.HeaderBytes       = sizeof(LineStoreFileHeader);
+    h.SourceWidth       = sourceWidth_;
+    h.RoiX              = roiX_;
+    h.Width             = width_;
+    h.WarmupMax         = warmupMax_;
+    h.CapacityLines     = capacityLines_;
+    h.PixelType         = static_cast<std::int32_t>(pixelType_);
+    h.SourceFormat      = static_cast<std::int32_t>(sourceFormat_);
+    h.SourceShift       = sourceShift_;
+    h.Circular          = circular_ ? 1 : 0;
+    h.RowAlignBytes     = rowAlign_;
+    h.SteadyTime        = steadyTime_ ? 1 : 0;
+    h.TimeOriginNs      = timeOriginNs_;
+    h.WarmupTimesOffset = warmupOff;
+    h.SegOffset         = segOff;
+    h.SegCapacity       = segCapacity;
+    h.DataOffset        = dataOff;
+    h.DataBytes         = capacityLines_ * static_cast<i64>(rowPitch_);
+}
+
+// ---- 状態の復元（読み取り専用 / 再開）----
+void LineStore::RestoreFromFile() {
+    const auto& h = *fileHeader_;
+
+    warmupCount_       = h.WarmupCount;
+    commitBase_        = h.CommitBase;
+    writeIndex_        = h.WriteIndex;
+    warmupLastTimeSec_ = h.WarmupLastTimeSec;
+    timeOriginNs_      = h.TimeOriginNs;
+    warmupHead_.store(h.WarmupHead, std::memory_order_relaxed);
+
+    std::memcpy(warmupTimes_.data(), memory_.FileHeader() + h.WarmupTimesOffset,
+                warmupTimes_.size() * sizeof(double));
+
+    // セグメント領域はリングなので、古い順に並べ直して渡す
+    const auto* segs = reinterpret_cast<const TimeSeg*>(memory_.FileHeader() + h.SegOffset);
+    const i64   n    = std::min(h.SegCount, h.SegCapacity);
+    const i64   first = h.SegCount - n;
+    std::vector<TimeSeg> ordered(static_cast<size_t>(n));
+    for (i64 i = 0; i < n; ++i)
+        ordered[static_cast<size_t>(i)] = segs[(first + i) % h.SegCapacity];
+    if (static_cast<i64>(n) > segs_->Capacity())
+        segs_ = std::make_shared<TimeIndex>(n);
+    segs_->Assign(ordered.data(), n);
+    fileSegCount_ = h.SegCount;
+
+    headTotal_.store(h.HeadTotal, std::memory_order_relaxed);
+    if (h.Committed) {
+        // Push の途中で止まっていたら、予約済み（ClaimIndex）で書きかけの行が潰した古い行は残さない。
+        // 書きかけの行そのものは WriteIndex より後なので、次の Push が上書きする
+        i64 claim = writeIndex_, stored = writeIndex_;
+        if (circular_) {
+            claim  = std::max(h.ClaimIndex, writeIndex_);
+            stored = std::clamp<i64>(capacityLines_ - (claim - writeIndex_), 0, std::min(writeIndex_, capacityLines_));
+        }
+        claimIndex_.store(claim, std::memory_order_relaxed);
+        publishIndex_.store(writeIndex_, std::memory_order_relaxed);
+        storedLines_.store(stored, std::memory_order_relaxed);
+        committed_.store(true, std::memory_order_release);
+    } else {
+        storedLines_.store(warmupCount_, std::memory_order_release);
+    }
+}
+
+// ---- ヘッダ状態の更新（writer スレッド）----
+void LineStore::SyncFileState() noexcept {
+    WriteFileState(*fileHeader_);
+}
+
+// ClaimIndex は Push がデータより先に書く（ここでは触らない）
+void LineStore::WriteFileState(LineStoreFileHeader& h) const noexcept {
+    h.Committed         = committed_.load(std::memory_order_relaxed) ? 1 : 0;
+    h.WarmupCount       = warmupCount_;
+    h.CommitBase        = commitBase_;
+    h.WriteIndex        = publishIndex_.load(std::memory_order_relaxed);
+    h.HeadTotal         = headTotal_.load(std::memory_order_relaxed);
+    h.SegCount          = fileSegCount_;
+    h.WarmupLastTimeSec = warmupLastTimeSec_;
+    h.WarmupHead        = warmupHead_.load(std::memory_order_relaxed);
+}
+
+// ---- 書き戻し ----
+void LineStore::FlushLoop() {
+    std::unique_lock<std::mutex> lk(flushMutex_);
+    while (!flushStop_) {
+        flushCv_.wait_for(lk, std::chrono::milliseconds(flushIntervalMs_));
+        if (flushStop_) break;
+        lk.unlock();
+        FlushFileRows(/*wait=*/false);
+        lk.lock();
+    }
+}
+
+// 前回から増えた行だけ書き出しを開始する（ヘッダ・時刻領域は毎回。汚れていないページは OS が飛ばす）
+void LineStore::FlushFileRows(bool wait) noexcept {
+    const i64 dataOff = fileHeader_->DataOffset;
+    const i64 rb      = rowPitch_;
+
+    if (!committed_.load(std::memory_order_acquire)) {
+        // ウォームアップ中は前詰めで書き換わるので領域ごと
+        memory_.FlushFile(static_cast<size_t>(dataOff), static_cast<size_t>(warmupMax_ * rb), wait);
+    } else {
+        const i64 end   = publishIndex_.load(std::memory_order_acquire);
+        i64       begin = flushedIndex_;
+        if (circular_ && end - begin > capacityLines_) begin = end - capacityLines_;
+
+        while (begin < end) {
+            const i64 phys = PhysRow(begin);
+            const i64 n    = circular_ ? std::min(end - begin, capacityLines_ - phys) : end - begin;
+            memory_.FlushFile(static_cast<size_t>(dataOff + phys * rb), static_cast<size_t>(n * rb), wait);
+            begin += n;
+        }
+        flushedIndex_ = end;
+    }
+
+    memory_.FlushFile(0, static_cast<size_t>(dataOff), wait);
+}
+
+void LineStore::CloseFile() noexcept {
+    if (!fileHeader_) return;
+
+    if (flushThread_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lk(flushMutex_);
+            flushStop_ = true;
+        }
+        flushCv_.notify_all();
+        flushThread_.join();
+    }
+
+    if (!readOnly_) {
+        SyncFileState();
+        flushedIndex_ = 0;           // 最後は全体を確実に書き出す
+        FlushFileRows(/*wait=*/true);
+    }
+
+    fileHeader_      = nullptr;
+    fileSegs_        = nullptr;
+    fileWarmupTimes_ = nullptr;
+}
+
+// ---- スナップショット ----
+void LineStore::SaveSnapshot(const std::string& path) const {
+    check_not_disposed();
+    if (adopt_) throw std::logic_error("SaveSnapshot is not supported with AdoptFrames");
+
+    // 時間セグメントは今保持している分だけ（ファイルの容量はストアの TimeSegCapacity と同じ）
+    const i64 segCap = segs_->Capacity();
+    LineStoreFileHeader layout{};
+    InitFileHeader(layout, segCap);
+
+    std::vector<char> head(static_cast<size_t>(layout.DataOffset), 0);
+    auto& h = *reinterpret_cast<LineStoreFileHeader*>(head.data());
+    h = layout;
+    WriteFileState(h);
+    h.SegCount   = segs_->CopyTo(reinterpret_cast<TimeSeg*>(head.data() + layout.SegOffset), segCap);
+    h.ClaimIndex = h.WriteIndex;
+    std::memcpy(head.data() + layout.WarmupTimesOffset, warmupTimes_.data(), warmupTimes_.size() * sizeof(double));
+
+    // 一時ファイルにディスクまで書き終えてから置き換える（電源断でも前のファイルか新しいファイルのどちらかが残る）
+    write_file_durable(path, path + ".tmp", { { head.data(), static_cast<i64>(head.size()) },
+                                              { buf_, layout.DataBytes } });
+}
@@ -0,0 +1,50 @@
+#pragma once
+// LineStoreFile.hpp
+// ファイルバック LineStore のファイル形式
+//
+//   [ヘッダ 4KiB][ウォームアップ行時刻 double x WarmupMax][時間セグメント x SegCapacity][画素 CapacityLines x 行間隔]
+//   各領域の先頭はヘッダのオフセットで示す（画素は 64KiB 境界）
+
+#include <cstdint>
+
+struct LineStoreFileHeader
+{
+    static constexpr char          MAGIC[8] = { 'L', 'S', 'T', 'O', 'R', 'E', '0', '1' };
+    static constexpr std::uint32_t VERSION  = 5; // 2: WarmupHead, 3: RowAlignBytes, 4: SteadyTime, 5: ClaimIndex（旧版は 0 として読める）
+
+    // ---- 構成（作成時に確定）----
+    char          Magic[8];
+    std::uint32_t Version;
+    std::uint32_t HeaderBytes;        // sizeof(LineStoreFileHeader)
+    std::int32_t  SourceWidth;
+    std::int32_t  RoiX;
+    std::int32_t  Width;
+    std::int32_t  WarmupMax;
+    std::int64_t  CapacityLines;
+    std::int32_t  PixelType;
+    std::int32_t  SourceFormat;
+    std::int32_t  SourceShift;
+    std::int32_t  Circular;
+    std::int64_t  WarmupTimesOffset;  // double[WarmupMax]
+    std::int64_t  SegOffset;          // {int64 Start; double T}[SegCapacity]（SegCount % SegCapacity に書くリング）
+    std::int64_t  SegCapacity;
+    std::int64_t  DataOffset;
+    std::int64_t  DataBytes;
+
+    // ---- 状態（writer が Push/Commit ごとに更新）----
+    std::int32_t  Committed;
+    std::int32_t  WarmupCount;
+    std::int64_t  CommitBase;
+    std::int64_t  WriteIndex;         // 書き込み完了済み末尾の絶対行
+    std::int64_t  HeadTotal;
+    std::int64_t  SegCount;           // 書いた時間セグメントの総数（残っているのは末尾 SegCapacity 個）
+    double        WarmupLastTimeSec;
+    std::int32_t  WarmupHead;         // 未 Commit で満杯のウォームアップ（リング）の最古行の物理位置
+    std::int32_t  RowAlignBytes;      // 行の境界（0 なら行間隔 = Width * 要素サイズ）
+    std::int32_t  SteadyTime;         // 1 なら時刻は TimeOriginNs（steady_clock の ns）からの秒
+    std::int64_t  TimeOriginNs;
+    std::int64_t  ClaimIndex;         // リングで上書きを予約した末尾。データより先に書くので、Push の途中で止まっても
+                                      // 書きかけの行が潰した古い行が分かる（WriteIndex 以下なら途中の Push は無い）
+};
+
+static_assert(sizeof(LineStoreFileHeader) <= 4096, "header must fit in one page");
@@ -0,0 +1,111 @@
+// LineStoreGroup.cpp
+#include "lineStoreGroup.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+LineStoreGroup::LineStoreGroup(int srcWidth, const std::vector<RoiSpec>& rois,
+                               i64 capacityLines, int warmupMax, PixelType pt,
+                               const LineStoreOptions& opt)
+{
+    if (rois.empty()) throw std::invalid_argument("rois");
+
+    stores_.reserve(rois.size());
+    for (size_t i = 0; i < rois.size(); ++i) {
+        // ファイルバックは ROI ごとに別ファイル（<FilePath>.<i>）
+        LineStoreOptions o = opt;
+        if (!o.FilePath.empty()) o.FilePath += "." + std::to_string(i);
+        stores_.push_back(std::make_unique<LineStore>(srcWidth, rois[i].X, rois[i].W, capacityLines, warmupMax, pt, o));
+    }
+
+    // 行の進み方は全ストア共通なので時間セグメントは 1 つを共有する。
+    // 二重マップでは ROI 幅で容量が切り上がるため、最も長く行を保持するストアを owner にする
+    const auto owner = std::max_element(stores_.begin(), stores_.end(),
+        [](const auto& a, const auto& b) { return a->CapacityLines() < b->CapacityLines(); });
+    pushOrder_.push_back(owner->get());
+    for (auto& s : stores_) {
+        if (s == *owner) continue;
+        s->ShareTimeIndex(**owner);
+        pushOrder_.push_back(s.get());
+    }
+}
+
+int LineStoreGroup::Count() const noexcept {
+    return static_cast<int>(stores_.size());
+}
+
+LineStore& LineStoreGroup::Store(int i) {
+    return *stores_.at(static_cast<size_t>(i));
+}
+
+const LineStore& LineStoreGroup::Store(int i) const {
+    return *stores_.at(static_cast<size_t>(i));
+}
+
+void LineStoreGroup::Commit() {
+    for (auto* s : pushOrder_) s->Commit();
+}
+
+void LineStoreGroup::Dispose() noexcept {
+    for (auto& s : stores_) s->Dispose();
+}
+
+bool LineStoreGroup::PushBlock(const void* src, int rows, int srcStrideBytes) {
+    return PushBlock(src, rows, srcStrideBytes, stores_.front()->NowSec());
+}
+
+bool LineStoreGroup::PushBlock(const void* src, int rows, int srcStrideBytes,
+                               std::chrono::system_clock::time_point acquiredUtc)
+{
+    if (stores_.front()->steadyTime_) throw std::logic_error("SteadyTime store takes steady_clock times (PushBlockNs)");
+    return PushBlock(src, rows, srcStrideBytes, LineStore::ToUnixSec(acquiredUtc));
+}
+
+bool LineStoreGroup::PushBlockNs(const void* src, int rows, int srcStrideBytes, std::int64_t timeNs) {
+    // 前回の時刻は先頭のストアに持たせる（秒の基準は ShareTimeIndex で全ストア同じ）
+    auto& s0 = *stores_.front();
+    if (timeNs < s0.lastPushNs_) timeNs = s0.lastPushNs_;
+    s0.lastPushNs_ = timeNs;
+    return PushBlock(src, rows, srcStrideBytes, s0.NsToSec(timeNs));
+}
+
+bool LineStoreGroup::PushBlock(const void* src, int rows, int srcStrideBytes,
+                               double acquiredUtcSec)
+{
+    if (!src) throw std::invalid_argument("src");
+    if (rows <= 0) return true;
+
+    // 所要時間はグループ全体の 1 回ぶんを各ストアに記録する
+    struct Timer
+    {
+        std::vector<std::unique_ptr<LineStore>>& Stores;
+        std::chrono::steady_clock::time_point    T0 = std::chrono::steady_clock::now();
+        ~Timer() { for (auto& s : Stores) s->RecordPush(T0); }
+    } timer{ stores_ };
+
+    // 全ストアの行を揃えておく（時間セグメントを共有しているので）。
+    // どれかが受け入れられない行（線形の容量切れ / Backpressure）は全ストアで捨てる
+    LineStore::i64 room = rows;
+    for (auto& s : stores_) room = std::min(room, s->WritableRows());
+    bool all = (room == rows);
+    if (!all) {
+        for (auto& s : stores_) s->droppedRows_.fetch_add(rows - room, std::memory_order_relaxed);
+        rows = static_cast<int>(room);
+        if (rows <= 0) return false;
+    }
+
+    // 行ブロックを小分けにし、各ブロックを全 ROI へ配ってから次へ進む。
+    // ソースの読み出しはほぼ 1 回分（2 つ目以降の ROI はキャッシュから読む）
+    const int chunkRows = std::max(1, CHUNK_BYTES / std::max(1, srcStrideBytes));
+    const auto* sBase = static_cast<const std::uint8_t*>(src);
+
+    for (int r0 = 0; r0 < rows; r0 += chunkRows) {
+        const int   n      = std::min(chunkRows, rows - r0);
+        const auto* chunk  = sBase + static_cast<LineStore::i64>(r0) * srcStrideBytes;
+        const bool  newSeg = (r0 == 0); // 2 つ目以降は同じブロックの続き
+        for (auto* s : pushOrder_)
+            all &= s->PushRows(chunk, n, srcStrideBytes, acquiredUtcSec, newSeg);
+    }
+    return all;
+}
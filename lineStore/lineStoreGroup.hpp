@@ -0,0 +1,54 @@
+#pragma once
+// LineStoreGroup.hpp
+// 1 つの取り込み元から複数 ROI（レーン）を同時に保持する
+// PushBlock 1 回でソース行をキャッシュに載せたまま各 ROI のストアへ振り分ける
+
+#include <memory>
+#include <vector>
+
+#include "lineStore2.hpp"
+
+struct RoiSpec
+{
+    int X; // 取り込み元座標の ROI 先頭
+    int W; // ROI 幅
+};
+
+class LineStoreGroup
+{
+public:
+    using i64 = LineStore::i64;
+
+    // 全 ROI が同じ容量・ウォームアップ・形式・モードを持つ
+    LineStoreGroup(int srcWidth, const std::vector<RoiSpec>& rois,
+                   i64 capacityLines, int warmupMax, PixelType pt,
+                   const LineStoreOptions& opt = {});
+
+    LineStoreGroup(const LineStoreGroup&) = delete;
+    LineStoreGroup& operator=(const LineStoreGroup&) = delete;
+
+    int              Count() const noexcept;
+    LineStore&       Store(int i);
+    const LineStore& Store(int i) const;
+
+    void Commit();
+    void Dispose() noexcept;
+
+    // 戻り値は全ストアが全行を受け入れたら true（線形モードの容量切れ / Backpressure カーソルで false）
+    bool PushBlock(const void* src, int rows, int srcStrideBytes);
+    bool PushBlock(const void* src, int rows, int srcStrideBytes,
+                   std::chrono::system_clock::time_point acquiredUtc);
+    bool PushBlock(const void* src, int rows, int srcStrideBytes,
+                   double acquiredUtcSec);
+    // 時刻を整数 ns で（LineStore::PushBlockNs と同じ。基準は opt.SteadyTime）
+    bool PushBlockNs(const void* src, int rows, int srcStrideBytes, std::int64_t timeNs);
+
+private:
+    // 1 回に振り分けるソース行の目安（L2 に収まる量）
+    static constexpr int CHUNK_BYTES = 256 * 1024;
+
+    std::vector<std::unique_ptr<LineStore>> stores_;
+    // Commit / Push の順。時間セグメントの owner が先頭：共有表にブロックのセグメントを追記してから
+    // 他のストアが行を公開する（逆だと、その間に最新行の時刻を引いた reader が外挿の値を得る）
+    std::vector<LineStore*>                 pushOrder_;
+};
@@ -0,0 +1,145 @@
+// LineStoreMeta.cpp
+// 行ごとのメタデータ（LineMeta）：エンコーダ値・トリガ ID・フレーム番号
+//   - 画素行と同じ物理行の位置に欄ごとの配列で持つ。書き込みは画素と同じく claimIndex_ と publishIndex_ の間なので、
+//     読み出しは TryCopyWindow と同じ「読んでから RowsIntact で検証」で済む
+//   - エンコーダ値 → 行は FindRowAtTime と同じ境界探索（値は行方向に単調非減少の前提）
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include "lineStore2.hpp"
+
+// ---- 書き込み（writer スレッド）----
+bool LineStore::PushBlock(const void* src, int rows, int srcStrideBytes, double acquiredUtcSec,
+                          const LineMetaBlock& meta)
+{
+    if (!meta_) throw std::logic_error("PushBlock with metadata requires LineMeta");
+
+    // 経路は PushBlock と同じ。取り込みの途中で pushMeta_ から各行へ書く（例外でも戻す）
+    struct Reset { const LineMetaBlock*& Meta; ~Reset() { Meta = nullptr; } } reset{ pushMeta_ };
+    pushMeta_ = &meta;
+    return PushBlock(src, rows, srcStrideBytes, acquiredUtcSec);
+}
+
+void LineStore::PutMeta(i64 fromAbs, int srcRow, int rows) noexcept {
+    const LineMetaBlock* m = pushMeta_;
+    for (int i = 0; i < rows;) {
+        // 物理末尾までを 1 区間として書く（リングは折り返す）
+        const i64 phys = PhysRow(fromAbs + i);
+        const int n    = static_cast<int>(std::min<i64>(rows - i, capacityLines_ - phys));
+        const auto p   = static_cast<size_t>(phys);
+        const int  s   = srcRow + i;
+
+        if (m && m->Encoder) std::copy_n(m->Encoder + s, n, metaEncoder_.begin() + p);
+        else                 std::fill_n(metaEncoder_.begin() + p, n, 0);
+        if (m && m->TriggerId) std::copy_n(m->TriggerId + s, n, metaTrigger_.begin() + p);
+        else                   std::fill_n(metaTrigger_.begin() + p, n, 0u);
+        if (m && m->FrameCounter) std::copy_n(m->FrameCounter + s, n, metaFrame_.begin() + p);
+        else                      std::fill_n(metaFrame_.begin() + p, n, 0u);
+        i += n;
+    }
+}
+
+void LineStore::PutWarmupMeta(i64 phys, int srcRow) noexcept {
+    const LineMetaBlock* m = pushMeta_;
+    const auto p = static_cast<size_t>(phys);
+    metaEncoder_[p] = (m && m->Encoder)      ? m->Encoder[srcRow]      : 0;
+    metaTrigger_[p] = (m && m->TriggerId)    ? m->TriggerId[srcRow]    : 0u;
+    metaFrame_[p]   = (m && m->FrameCounter) ? m->FrameCounter[srcRow] : 0u;
+}
+
+// Commit：画素と同じようにウォームアップのリングを先頭から並べる
+void LineStore::RotateWarmupMeta(int head) {
+    std::rotate(metaEncoder_.begin(), metaEncoder_.begin() + head, metaEncoder_.begin() + warmupMax_);
+    std::rotate(metaTrigger_.begin(), metaTrigger_.begin() + head, metaTrigger_.begin() + warmupMax_);
+    std::rotate(metaFrame_.begin(),   metaFrame_.begin() + head,   metaFrame_.begin() + warmupMax_);
+}
+
+// ---- 読み出し ----
+ReadResult LineStore::TryCopyLineMeta(i64 rowAbs, int rows, std::int64_t* encoder,
+                                      std::uint32_t* triggerId, std::uint32_t* frameCounter) const noexcept
+{
+    if (!meta_ || rowAbs < 0 || rows <= 0 || rows > capacityLines_) return ReadResult::InvalidArg;
+    if (!committed_.load(std::memory_order_acquire)) return ReadResult::NotReady;
+
+    const i64 end = publishIndex_.load(std::memory_order_acquire);
+    if (rowAbs + rows > end) return ReadResult::NotReady;
+    if (!RowsIntact(rowAbs)) return CountOverwritten();
+
+    for (int i = 0; i < rows;) {
+        const i64  phys = PhysRow(rowAbs + i);
+        const int  n    = static_cast<int>(std::min<i64>(rows - i, capacityLines_ - phys));
+        const auto p    = static_cast<size_t>(phys);
+        if (encoder)      std::copy_n(metaEncoder_.begin() + p, n, encoder + i);
+        if (triggerId)    std::copy_n(metaTrigger_.begin() + p, n, triggerId + i);
+        if (frameCounter) std::copy_n(metaFrame_.begin() + p, n, frameCounter + i);
+        i += n;
+    }
+
+    // コピー中に一周されていたら破棄
+    if (!RowsIntact(rowAbs)) return CountOverwritten();
+    return ReadResult::Ok;
+}
+
+bool LineStore::EncoderAt(i64 rowAbs, i64& v) const noexcept {
+    v = metaEncoder_[static_cast<size_t>(PhysRow(rowAbs))];
+    return RowsIntact(rowAbs);
+}
+
+// ---- エンコーダ値 → 行 ----
+LineStore::i64 LineStore::RowBoundForEncoder(i64 pos, bool after) const noexcept {
+    for (;;) {
+        i64 a = OldestRowAbs();
+        i64 b = EndRowAbs();
+
+        // 探索中に writer が追い越した行を読んだら、新しい最古の行から探し直す
+        bool lost = false;
+        auto before = [&](i64 r) {
+            i64 v;
+            if (!EncoderAt(r, v)) { lost = true; return false; }
+            return after ? v <= pos : v < pos;
+        };
+
+        while (a < b && !lost) {
+            const i64 m = a + (b - a) / 2;
+            if (before(m)) a = m + 1;
+            else           b = m;
+        }
+        if (!lost) return a;
+    }
+}
+
+LineStore::i64 LineStore::FindRowAtEncoder(i64 pos) const noexcept {
+    if (!meta_ || !committed_.load(std::memory_order_acquire)) return -1;
+    const i64 r = RowBoundForEncoder(pos, /*after=*/true) - 1;
+    return (r >= OldestRowAbs()) ? r : -1;
+}
+
+double LineStore::RowAtEncoder(double pos) const noexcept {
+    constexpr double NaN = std::numeric_limits<double>::quiet_NaN();
+    if (!meta_ || std::isnan(pos) || !committed_.load(std::memory_order_acquire)) return NaN;
+
+    // r0: 値 <= pos の最後の行、r1 = r0 + 1: 値 > pos の最初の行。その間を補間する
+    const i64 r1 = RowBoundForEncoder(static_cast<i64>(std::floor(pos)), /*after=*/true);
+    const i64 r0 = r1 - 1;
+    if (r0 < OldestRowAbs()) return NaN;
+
+    i64 e0, e1;
+    if (!EncoderAt(r0, e0)) return NaN;
+    if (static_cast<double>(e0) == pos) return static_cast<double>(r0);
+    if (r1 >= EndRowAbs() || !EncoderAt(r1, e1)) return NaN; // 最新の行より先
+    return static_cast<double>(r0) + (pos - static_cast<double>(e0)) / static_cast<double>(e1 - e0);
+}
+
+bool LineStore::GetRowRangeForEncoder(i64 pos0, i64 pos1, i64& rowBegin, i64& rowEnd) const noexcept {
+    rowBegin = rowEnd = -1;
+    if (!meta_ || pos0 > pos1) return false;
+    if (!committed_.load(std::memory_order_acquire)) return false;
+
+    const i64 b = RowBoundForEncoder(pos0, /*after=*/false);
+    const i64 e = RowBoundForEncoder(pos1, /*after=*/true);
+    if (b >= e) return false;
+    rowBegin = b;
+    rowEnd   = e;
+    return true;
+}
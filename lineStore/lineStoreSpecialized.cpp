@@ -0,0 +1,343 @@
+// LineStoreSpecialized.cpp
+// Push / 窓取得のホットパスを <画素型, 線形/リング, 容量が 2 のべき乗か> で特殊化したもの
+//   - 要素サイズは sizeof(PixelT) の定数
+//   - 線形/リングの分岐と物理行の計算（% か &）はコンパイル時に決まる
+//   - Commit 後の Push は付加機能が無ければ（PlainPush を Push ごとに 1 回）、それらの分岐の無い版を通る
+// LineStore は生成時に SelectSpecialized で 1 組を選び、以降は関数ポインタ 1 回で呼ぶ
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include "lineStore2.hpp"
+
+namespace {
+
+template <bool Circular, bool Pow2>
+inline std::int64_t phys_row(std::int64_t rowAbs, std::int64_t cap, std::int64_t mask) noexcept {
+    if constexpr (!Circular) { (void)cap; (void)mask; return rowAbs; }
+    else if constexpr (Pow2) { (void)cap;  return rowAbs & mask; }
+    else                     { (void)mask; return rowAbs % cap; }
+}
+
+} // namespace
+
+// ---- 行のまとめ取り込み（ROI 切り出し + 形式変換）----
+template <class PixelT, bool Plain>
+void LineStore::CopyRowsT(const std::uint8_t* src, int srcStrideBytes, std::uint8_t* dst, int rows) const noexcept {
+    constexpr i64 ELEM  = sizeof(PixelT);
+    const i64     rb    = static_cast<i64>(width_) * ELEM;
+    const i64     pitch = rowPitch_;
+
+    // Plain：分担・形式変換は無い（PlainPush で確かめてある）。行ごとの memcpy だけ
+    if constexpr (Plain) {
+        if (srcStrideBytes == rb && pitch == rb) {
+            std::memcpy(dst, src, static_cast<size_t>(rows * rb));
+            return;
+        }
+        const auto* s = src + static_cast<i64>(roiX_) * ELEM;
+        for (int i = 0; i < rows; ++i)
+            std::memcpy(dst + i * pitch, s + static_cast<i64>(i) * srcStrideBytes, static_cast<size_t>(rb));
+        return;
+    }
+
+    // PushBlockParallel：大きなブロックはワーカーと分担する（全員が終わるまで戻らない）
+    if (parallelPush_ && copyPool_ && rows * rb >= parallelMinBytes_) [[unlikely]] {
+        const int par  = copyPool_->Parallelism();
+        CopyJob   job{ this, src, srcStrideBytes, dst, rows, rows >= par, 0 };
+        int       parts;
+        if (job.ByRows) {
+            job.Step = (rows + par - 1) / par;
+            parts    = (rows + job.Step - 1) / job.Step;
+        } else {
+            // 列の帯は 64 画素単位（隣の帯と同じキャッシュラインに書かない）
+            job.Step = ((width_ + par - 1) / par + 63) / 64 * 64;
+            parts    = (width_ + job.Step - 1) / job.Step;
+        }
+        copyPool_->Run(parts, &LineStore::CopyPartT<PixelT>, &job);
+        return;
+    }
+
+    if (convert_) {
+        for (int i = 0; i < rows; ++i)
+            convert_(src + static_cast<i64>(i) * srcStrideBytes, roiX_, width_, dst + i * pitch, sourceShift_);
+        return;
+    }
+
+    // stride が ROI 行と同じなら取り込み元は ROI そのもの（roiX == 0 かつ全幅）。行を詰めていれば 1 回でコピー
+    if (srcStrideBytes == rb && pitch == rb) {
+        std::memcpy(dst, src, static_cast<size_t>(rows * rb));
+        return;
+    }
+    CopySpanT<PixelT>(src, srcStrideBytes, dst, rows, 0, width_);
+}
+
+template <class PixelT>
+void LineStore::CopySpanT(const std::uint8_t* src, int srcStrideBytes, std::uint8_t* dst,
+                          int rows, int x0, int n) const noexcept
+{
+    constexpr i64 ELEM  = sizeof(PixelT);
+    const i64     pitch = rowPitch_;
+    auto*         d     = dst + x0 * ELEM;
+
+    if (convert_) {
+        for (int i = 0; i < rows; ++i)
+            convert_(src + static_cast<i64>(i) * srcStrideBytes, roiX_ + x0, n, d + i * pitch, sourceShift_);
+        return;
+    }
+    const auto* s = src + static_cast<i64>(roiX_ + x0) * ELEM;
+    for (int i = 0; i < rows; ++i)
+        std::memcpy(d + i * pitch, s + static_cast<i64>(i) * srcStrideBytes, static_cast<size_t>(n * ELEM));
+}
+
+template <class PixelT>
+void LineStore::CopyPartT(void* jobv, int part) noexcept {
+    const auto& job  = *static_cast<const CopyJob*>(jobv);
+    const auto& self = *job.Self;
+
+    // writer が claimIndex_ の後に置いた release fence と同じ役目。ワーカーの書き込みを見た reader が
+    // 上書き予約（claimIndex_）も見えるように、受け取った予約を自分の書き込みより前に並べる
+    std::atomic_thread_fence(std::memory_order_release);
+
+    if (job.ByRows) {
+        const int r0 = part * job.Step;
+        const int n  = std::min(job.Step, job.Rows - r0);
+        self.CopySpanT<PixelT>(job.Src + static_cast<i64>(r0) * job.SrcStride, job.SrcStride,
+                               job.Dst + static_cast<i64>(r0) * self.rowPitch_, n, 0, self.width_);
+    } else {
+        const int x0 = part * job.Step;
+        self.CopySpanT<PixelT>(job.Src, job.SrcStride, job.Dst, job.Rows, x0, std::min(job.Step, self.width_ - x0));
+    }
+}
+
+// ---- PushBlock ----
+template <class PixelT, bool Circular, bool Pow2>
+bool LineStore::PushRowsT(const void* src, int rows, int srcStrideBytes, double timeSec, bool newSeg) {
+    check_not_disposed();
+    if (readOnly_) throw std::logic_error("LineStore is read-only");
+    if (tapCount_.load(std::memory_order_relaxed) != 0) [[unlikely]] throw std::logic_error("LineStore has taps (use PushTap)");
+    if (!src) throw std::invalid_argument("src");
+    if (rows <= 0) return true;
+    if (srcStrideBytes < SourceRowBytes())
+        throw std::invalid_argument("srcStrideBytes too small (for source width)");
+
+    // 補正表の差し替えはブロックの境目でだけ受け取る
+    if (flatPending_.load(std::memory_order_acquire)) [[unlikely]] TakeFlatField();
+    // NUMA_CURRENT：writer のノードに置く（最初の Push だけ）
+    if (memory_.NumaPending()) [[unlikely]] memory_.BindToCurrentNode();
+
+    const auto* s  = static_cast<const std::uint8_t*>(src);
+    bool        ok = true;
+    if (!committed_.load(std::memory_order_acquire)) [[unlikely]] {
+        PushWarmup(src, rows, srcStrideBytes, timeSec);
+        headTotal_.fetch_add(rows, std::memory_order_release);
+    } else if (PlainPush()) {
+        ok = PushCommittedT<PixelT, Circular, Pow2, true>(s, rows, srcStrideBytes, timeSec, newSeg);
+    } else {
+        const i64 from = writeIndex_;
+        ok = PushCommittedT<PixelT, Circular, Pow2, false>(s, rows, srcStrideBytes, timeSec, newSeg);
+        if (!levels_.empty()) FeedLevels(from, writeIndex_);
+    }
+
+    if (fileHeader_) SyncFileState();
+    NotifyWaiters();
+    return ok;
+}
+
+bool LineStore::PlainPush() const noexcept {
+    return !IngestStageActive() && !meta_ && levels_.empty() && !fileHeader_ && !convert_ && !parallelPush_ &&
+           backpressureCursors_.load(std::memory_order_seq_cst) == 0;
+}
+
+// ---- Commit 後：線形 / リング追記 ----
+template <class PixelT, bool Circular, bool Pow2, bool Plain>
+bool LineStore::PushCommittedT(const std::uint8_t* sBase, int rows, int srcStrideBytes, double timeSec, bool newSeg) {
+    const i64 pitch = rowPitch_;
+    const i64 cap   = capacityLines_;
+
+    // ---- 線形モード ----
+    if constexpr (!Circular) {
+        const i64 remain = cap - writeIndex_;
+        const int can    = static_cast<int>(std::clamp<i64>(remain, 0, rows));
+        if (can < rows) droppedRows_.fetch_add(rows - can, std::memory_order_relaxed);
+        if (can <= 0) return false;
+
+        // セグメント登録（論理行で）
+        if (newSeg) AddSeg(writeIndex_ - commitBase_, timeSec);
+
+        CopyRowsT<PixelT, Plain>(sBase, srcStrideBytes, buf_ + writeIndex_ * pitch, can);
+        if constexpr (!Plain) {
+            if (IngestStageActive()) IngestStage(buf_ + writeIndex_ * pitch, can);
+            if (meta_) PutMeta(writeIndex_, 0, can);
+        }
+
+        writeIndex_ += can;
+        claimIndex_.store(writeIndex_, std::memory_order_relaxed);
+        publishIndex_.store(writeIndex_, std::memory_order_release);
+
+        const i64 newStored = writeIndex_;
+        if (newStored > storedLines_.load(std::memory_order_relaxed))
+            storedLines_.store(newStored, std::memory_order_release);
+        headTotal_.fetch_add(can, std::memory_order_release);
+
+        return can == rows;
+    }
+
+    // ---- リングモード ----
+    else {
+        // Backpressure カーソルの未読行を潰す分は受け入れない（線形モードの容量切れと同じく先頭側だけ残す）
+        bool accepted = true;
+        if (!Plain && backpressureCursors_.load(std::memory_order_seq_cst) != 0) {
+            const i64 room = WritableRows();
+            if (room < rows) {
+                droppedRows_.fetch_add(rows - room, std::memory_order_relaxed);
+                rows     = static_cast<int>(room);
+                accepted = false;
+                if (rows <= 0) return false;
+            }
+        }
+
+        // セグメント登録：この Push の先頭行の「絶対行」から timeSec を割り当てる
+        if (newSeg) AddSeg(writeIndex_ - commitBase_, timeSec);
+
+        // 上書き予約：これから書く行の物理位置に居た古い行を読み手から無効化する
+        // （release fence 以降のデータ書き込みを見た読み手は、この claim も必ず見る）
+        claimIndex_.store(writeIndex_ + rows, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        if constexpr (!Plain)
+            if (fileHeader_) fileHeader_->ClaimIndex = writeIndex_ + rows; // 途中で止まっても再開時に分かるように
+
+        int remaining = rows;
+        int rowOffset = 0;
+
+        // 1 回で一周以上する場合、先頭側は書いてもすぐ上書きされるので飛ばす
+        if (rows > cap) {
+            const int skip = static_cast<int>(rows - cap);
+            writeIndex_ += skip;
+            remaining   -= skip;
+            rowOffset   += skip;
+        }
+
+        if constexpr (!Plain)
+            if (meta_) PutMeta(writeIndex_, rowOffset, remaining);
+
+        const bool mirrored = memory_.Mirrored();
+        while (remaining > 0) {
+            const i64 physIndex = phys_row<true, Pow2>(writeIndex_, cap, capMask_);
+
+            // 二重マップなら末尾の先も連続（後半の面に書けば前半の先頭に現れる）→ 1 回で書ける
+            const i64 tillEnd    = mirrored ? cap : cap - physIndex; // この位置から連続して書ける行数
+            const int contiguous = static_cast<int>(std::min<i64>(tillEnd, remaining));
+
+            CopyRowsT<PixelT, Plain>(sBase + static_cast<i64>(rowOffset) * srcStrideBytes, srcStrideBytes,
+                                     buf_ + physIndex * pitch, contiguous);
+            if constexpr (!Plain)
+                if (IngestStageActive()) IngestStage(buf_ + physIndex * pitch, contiguous); // 公開前に統計・補正
+
+            writeIndex_ += contiguous;   // 絶対行インデックス
+            remaining   -= contiguous;
+            rowOffset   += contiguous;
+        }
+
+        publishIndex_.store(writeIndex_, std::memory_order_release);
+
+        // 押し出された行だけを覆う時間セグメントを捨てる（共有表は最も長く保持する owner が行う）
+        if (ownsSegs_) segs_->TrimBefore(OldestRowAbs() - commitBase_);
+
+        // 保持できる最大行数は cap 行まで
+        const i64 prevStored = storedLines_.load(std::memory_order_relaxed);
+        const i64 newStored  = std::min(prevStored + rows, cap);
+        storedLines_.store(newStored, std::memory_order_release);
+        headTotal_.fetch_add(rows, std::memory_order_release); // 最後に進める（WaitForLines で起きた reader が読めるように）
+
+        return accepted; // Backpressure が無ければ常に全行受け入れ
+    }
+}
+
+// ---- 窓取得 ----
+template <class PixelT, bool Circular, bool Pow2>
+bool LineStore::TryGetWindowPtrT(i64 startRow, int winW, int winH, int x0,
+                                 const void*& ptr, int& strideBytes, double& timeSecAtTop) const noexcept
+{
+    constexpr i64 ELEM  = sizeof(PixelT);
+    const i64     pitch = rowPitch_;
+
+    ptr = nullptr; strideBytes = rowPitch_; timeSecAtTop = std::numeric_limits<double>::quiet_NaN();
+    if (startRow < 0 || winW <= 0 || winH <= 0 || winW > width_) return false;
+
+    const i64 avail = storedLines_.load(std::memory_order_acquire);
+    if (startRow + winH > avail) return false;
+
+    const int x0c = clamp(x0, 0, std::max(0, width_ - winW));
+
+    if (!committed_.load(std::memory_order_acquire)) [[unlikely]]
+        return WarmupWindowPtr(startRow, winH, x0c, ptr, timeSecAtTop);
+
+    // ---- コミット後：線形モード ----
+    if constexpr (!Circular) {
+        ptr = static_cast<const void*>(buf_ + startRow * pitch + x0c * ELEM);
+        timeSecAtTop = RowTimeSec(startRow);
+        return true;
+    }
+
+    // ---- コミット後：リングモード ----
+    else {
+        const i64 cap = capacityLines_;
+
+        // headTotal_ はウォームアップで捨てた行も数えるので、絶対行は publishIndex_ から求める
+        // （writer は publishIndex_ → storedLines_ の順に公開するので avail 以上の行が必ずある）
+        const i64 total    = publishIndex_.load(std::memory_order_acquire);
+        const i64 firstAbs = total - avail;         // 「バッファ内の論理行0」の絶対行
+        const i64 rowAbs   = firstAbs + startRow;   // 求めたい行の絶対インデックス
+        const i64 physRow  = phys_row<true, Pow2>(rowAbs, cap, capMask_);
+
+        // 末尾を跨ぐ窓：二重マップなら続いている。無ければ作業領域に写し、写している間に上書きされていないか確かめる
+        const std::uint8_t* base = buf_ + physRow * pitch;
+        if (physRow + winH > cap && !memory_.Mirrored()) [[unlikely]] {
+            base = CopySeamWindow(physRow, cap, winH);
+            if (!base || !RowsIntact(rowAbs)) return false;
+        }
+        ptr = static_cast<const void*>(base + x0c * ELEM);
+        timeSecAtTop = RowTimeSec(rowAbs);
+        return true;
+    }
+}
+
+// ---- 選択 ----
+void LineStore::SelectSpecialized() {
+    if (adopt_) { // 画素リングを持たない（lineStoreAdopt.cpp）
+        pushFn_   = &LineStore::PushRowsAdopted;
+        windowFn_ = &LineStore::TryGetWindowPtrAdopted;
+        return;
+    }
+    const bool pow2 = (capMask_ >= 0);
+
+#define LS_SELECT(T)                                                                                \
+    if (!circular_)  { pushFn_ = &LineStore::PushRowsT<T, false, false>;                            \
+                       windowFn_ = &LineStore::TryGetWindowPtrT<T, false, false>; }                 \
+    else if (pow2)   { pushFn_ = &LineStore::PushRowsT<T, true, true>;                              \
+                       windowFn_ = &LineStore::TryGetWindowPtrT<T, true, true>; }                   \
+    else             { pushFn_ = &LineStore::PushRowsT<T, true, false>;                             \
+                       windowFn_ = &LineStore::TryGetWindowPtrT<T, true, false>; }
+
+    switch (pixelType_) {
+    case PixelType::U8:  LS_SELECT(std::uint8_t);  break;
+    case PixelType::U16: LS_SELECT(std::uint16_t); break;
+    default: throw std::invalid_argument("PixelType");
+    }
+#undef LS_SELECT
+}
+
+// BasicLineStore から直接呼ぶ組み合わせ（線形は容量に依らないので Pow2 = false で共通）
+template bool LineStore::PushRowsT<std::uint8_t,  false, false>(const void*, int, int, double, bool);
+template bool LineStore::PushRowsT<std::uint8_t,  true,  false>(const void*, int, int, double, bool);
+template bool LineStore::PushRowsT<std::uint8_t,  true,  true >(const void*, int, int, double, bool);
+template bool LineStore::PushRowsT<std::uint16_t, false, false>(const void*, int, int, double, bool);
+template bool LineStore::PushRowsT<std::uint16_t, true,  false>(const void*, int, int, double, bool);
+template bool LineStore::PushRowsT<std::uint16_t, true,  true >(const void*, int, int, double, bool);
+
+template bool LineStore::TryGetWindowPtrT<std::uint8_t,  false, false>(i64, int, int, int, const void*&, int&, double&) const noexcept;
+template bool LineStore::TryGetWindowPtrT<std::uint8_t,  true,  false>(i64, int, int, int, const void*&, int&, double&) const noexcept;
+template bool LineStore::TryGetWindowPtrT<std::uint8_t,  true,  true >(i64, int, int, int, const void*&, int&, double&) const noexcept;
+template bool LineStore::TryGetWindowPtrT<std::uint16_t, false, false>(i64, int, int, int, const void*&, int&, double&) const noexcept;
+template bool LineStore::TryGetWindowPtrT<std::uint16_t, true,  false>(i64, int, int, int, const void*&, int&, double&) const noexcept;
+template bool LineStore::TryGetWindowPtrT<std::uint16_t, true,  true >(i64, int, int, int, const void*&, int&, double&) const noexcept;
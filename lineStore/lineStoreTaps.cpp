@@ -0,0 +1,171 @@
+// LineStoreTaps.cpp
+// 分割書き込み（マルチタップのラインセンサ / 列を分けて並べた複数カメラ）
+//   - tap ごとに列の範囲 [X0, X0 + Width) と「書き終えた末尾の絶対行」（Done）を持つ。Done を進めるのはその tap だけ
+//   - 公開は全 tap の Done の最小値まで（かつ tap 0 が時間セグメントを登録した行まで）。最後に追いついた tap が
+//     tapMutex_ の中で publishIndex_ / storedLines_ / headTotal_ を進める（reader から見た順序は PushBlock と同じ）
+//   - 時間セグメントは tap 0 だけが tapMutex_ の中で登録する（ファイルの時間セグメント欄も公開と同じロックで更新する）
+//   - リングの上書き予約（claimIndex_）は最も先の tap に合わせる。予約 → release fence → データの順は PushBlock と同じなので、
+//     RowsIntact の判定はそのまま使える
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include "lineStore2.hpp"
+
+// ---- 登録 ----
+int LineStore::RegisterTap(int x0, int width) {
+    check_not_disposed();
+    if (readOnly_) throw std::logic_error("LineStore is read-only");
+    if (binParent_) throw std::logic_error("LineStore bin level is written by its parent");
+    if (adopt_ || meta_ || !levels_.empty() || colStats_ != ColumnStatsMode::Off)
+        throw std::logic_error("taps are not supported with AdoptFrames / LineMeta / BinLevels / ColumnStats");
+    if (x0 < 0 || width <= 0 || x0 > width_ - width) throw std::out_of_range("x0 / width");
+
+    std::lock_guard<std::mutex> lk(tapMutex_);
+    if (tapsSealed_.load(std::memory_order_relaxed)) throw std::logic_error("taps are fixed after the first PushTap");
+    if (backpressureCursors_.load(std::memory_order_seq_cst) != 0)
+        throw std::logic_error("taps are not supported with Backpressure cursors");
+    {
+        std::lock_guard<std::mutex> fl(flatMutex_);
+        if (flat_ || flatNext_) throw std::logic_error("taps are not supported with flat-field");
+    }
+    for (const auto& t : taps_)
+        if (x0 < t->X0 + t->Width && t->X0 < x0 + width) throw std::invalid_argument("tap spans overlap");
+
+    auto t   = std::make_unique<TapSlot>();
+    t->X0    = x0;
+    t->Width = width;
+    taps_.push_back(std::move(t));
+
+    const int n = static_cast<int>(taps_.size());
+    tapCount_.store(n, std::memory_order_release);
+    return n - 1;
+}
+
+int LineStore::TapCount() const noexcept { return tapCount_.load(std::memory_order_acquire); }
+
+// 最初の PushTap で：範囲が ROI を隙間なく覆うか確かめ、全 tap の開始行を今の末尾に揃える
+void LineStore::SealTaps() {
+    std::lock_guard<std::mutex> lk(tapMutex_);
+    if (tapsSealed_.load(std::memory_order_relaxed)) return;
+
+    std::vector<std::pair<int, int>> spans;
+    for (const auto& t : taps_) spans.emplace_back(t->X0, t->Width);
+    std::sort(spans.begin(), spans.end());
+    int x = 0;
+    for (const auto& [x0, w] : spans) {
+        if (x0 != x) break;
+        x += w;
+    }
+    if (x != width_) throw std::logic_error("tap spans must cover the ROI width");
+
+    const i64 start = publishIndex_.load(std::memory_order_acquire);
+    for (const auto& t : taps_) t->Done.store(start, std::memory_order_relaxed);
+    tapSegEnd_ = start;
+    tapsSealed_.store(true, std::memory_order_release);
+}
+
+// ---- 書き込み（tap ごとに 1 スレッド）----
+bool LineStore::PushTap(int tap, const void* src, int rows, int srcStrideBytes, double timeSec) {
+    check_not_disposed();
+    if (tap < 0 || tap >= tapCount_.load(std::memory_order_acquire)) throw std::out_of_range("tap");
+    if (!src) throw std::invalid_argument("src");
+    if (!committed_.load(std::memory_order_acquire)) throw std::logic_error("PushTap requires Commit");
+    if (rows <= 0) return true;
+    if (!tapsSealed_.load(std::memory_order_acquire)) [[unlikely]] SealTaps();
+    if (memory_.NumaPending()) [[unlikely]] memory_.BindToCurrentNode(); // NUMA_CURRENT：最初に書く tap のノード
+
+    TapSlot& t = *taps_[static_cast<size_t>(tap)];
+    if (srcStrideBytes < (static_cast<i64>(t.Width) * SourceBitsPerPixel(sourceFormat_) + 7) / 8)
+        throw std::invalid_argument("srcStrideBytes too small (for tap width)");
+
+    // 統計（Push 回数・所要時間）は tap 0 だけが記録する（単一 writer 前提の表なので）
+    const auto t0   = std::chrono::steady_clock::now();
+    const bool lead = (tap == 0);
+    const auto* s   = static_cast<const std::uint8_t*>(src);
+
+    const i64 from = t.Done.load(std::memory_order_relaxed);
+    i64       to   = from + rows;
+    bool      ok   = true;
+
+    // 線形モード：容量を超えた行は捨てる（どの tap も同じ行数で切れるので行は揃ったまま）
+    if (!circular_ && to > capacityLines_) {
+        const i64 keep = std::max<i64>(0, capacityLines_ - from);
+        if (lead) droppedRows_.fetch_add(to - from - keep, std::memory_order_relaxed);
+        to = from + keep;
+        ok = false;
+        if (to == from) {
+            if (lead) RecordPush(t0);
+            return false;
+        }
+    }
+
+    // セグメント登録（行の時刻は tap 0 のもの）。公開より先に済ませ、登録した末尾を公開の上限にする
+    if (lead) {
+        std::lock_guard<std::mutex> lk(tapMutex_);
+        AddSeg(from - commitBase_, timeSec);
+        tapSegEnd_ = to;
+    }
+
+    i64 first = from;
+    if (circular_) {
+        // 上書き予約：他の tap が先に進めていればそのまま（予約は減らさない）
+        i64 c = claimIndex_.load(std::memory_order_acquire);
+        while (c < to && !claimIndex_.compare_exchange_weak(c, to, std::memory_order_acq_rel, std::memory_order_acquire)) {}
+        std::atomic_thread_fence(std::memory_order_release);
+        if (fileHeader_) { // 再開時に書きかけの行が分かるように（tap どうしで競るので atomic_ref で最大値を残す）
+            std::atomic_ref<i64> fc(fileHeader_->ClaimIndex);
+            i64 f = fc.load(std::memory_order_relaxed);
+            while (f < to && !fc.compare_exchange_weak(f, to, std::memory_order_relaxed)) {}
+        }
+
+        // 予約済みの末尾から一周以上前の行は、書いてもすぐ上書き扱いなので飛ばす
+        first = std::max(from, std::max(c, to) - capacityLines_);
+    }
+    if (first < to)
+        CopyTapRows(t, s + (first - from) * srcStrideBytes, srcStrideBytes, first, static_cast<int>(to - first));
+
+    t.Done.store(to, std::memory_order_release);
+    PublishTaps();
+
+    // 押し出された行だけを覆う時間セグメントを捨てる（AddSeg と同じ tap 0 のスレッドで）
+    if (lead && circular_ && ownsSegs_) segs_->TrimBefore(OldestRowAbs() - commitBase_);
+    if (lead) RecordPush(t0);
+    return ok;
+}
+
+void LineStore::CopyTapRows(const TapSlot& t, const std::uint8_t* src, int srcStrideBytes, i64 fromAbs, int rows) const noexcept {
+    const i64  xOff = static_cast<i64>(t.X0) * elemSizeBytes_;
+    const auto rb   = static_cast<size_t>(t.Width) * static_cast<size_t>(elemSizeBytes_);
+
+    for (int i = 0; i < rows; ++i) {
+        const std::uint8_t* s = src + static_cast<i64>(i) * srcStrideBytes;
+        std::uint8_t*       d = buf_ + PhysRow(fromAbs + i) * rowPitch_ + xOff;
+        if (convert_) convert_(s, 0, t.Width, d, sourceShift_); // src は tap の範囲の左端から
+        else          std::memcpy(d, s, rb);
+    }
+}
+
+void LineStore::PublishTaps() {
+    {
+        std::lock_guard<std::mutex> lk(tapMutex_);
+        i64 done = tapSegEnd_; // 時刻の無い行は公開しない
+        for (const auto& t : taps_) done = std::min(done, t->Done.load(std::memory_order_acquire));
+
+        const i64 pub = publishIndex_.load(std::memory_order_relaxed);
+        if (done <= pub) return; // まだ書いていない tap がある
+        const i64 rows = done - pub;
+
+        writeIndex_ = done;
+        if (!circular_) claimIndex_.store(done, std::memory_order_relaxed);
+        publishIndex_.store(done, std::memory_order_release);
+
+        const i64 prevStored = storedLines_.load(std::memory_order_relaxed);
+        storedLines_.store(circular_ ? std::min(prevStored + rows, capacityLines_) : done, std::memory_order_release);
+        headTotal_.fetch_add(rows, std::memory_order_release);
+
+        if (fileHeader_) SyncFileState();
+    }
+    NotifyWaiters();
+}
@@ -0,0 +1,107 @@
+// LineStoreWindows.cpp
+#include "lineStoreWindows.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+// ---- 生成/破棄 ----
+SlidingWindows::SlidingWindows(LineStore& store, const SlidingWindowOptions& opt)
+    : store_(store)
+    , opt_(opt)
+    , cursor_(-1)
+    , started_(false)
+    , done_(false)
+    , timedOut_(false)
+    , stop_(false)
+{
+    if (opt_.Step == 0) opt_.Step = opt_.Height;
+    if (opt_.Height <= 0 || opt_.Height > store.CapacityLines()) throw std::out_of_range("Height");
+    if (opt_.Step < 0) throw std::out_of_range("Step");
+    if (opt_.X0 < 0 || opt_.X0 >= store.Width() || opt_.Width < 0 || opt_.X0 + opt_.Width > store.Width())
+        throw std::out_of_range("X0 / Width");
+    if (opt_.Width == 0) opt_.Width = store.Width() - opt_.X0;
+
+    cursor_ = store_.OpenCursor(opt_.Policy, opt_.StartRowAbs);
+}
+
+SlidingWindows::~SlidingWindows() {
+    store_.CloseCursor(cursor_);
+}
+
+// ---- range ----
+SlidingWindows::Iterator SlidingWindows::begin() {
+    if (!started_) {
+        started_ = true;
+        Fetch();
+    }
+    return Iterator(this);
+}
+
+void SlidingWindows::Stop() noexcept {
+    stop_.store(true, std::memory_order_seq_cst);
+    store_.NotifyWaiters(); // 眠っていれば起こす
+}
+
+void SlidingWindows::Advance() {
+    if (done_) return;
+    store_.CursorAdvance(cursor_, opt_.Step); // ここで前の窓を手放す（Backpressure なら writer が進める）
+    Fetch();
+}
+
+void SlidingWindows::Fetch() {
+    using namespace std::chrono;
+    const int  h        = opt_.Height;
+    const bool infinite = (opt_.Timeout == nanoseconds::max());
+    const auto deadline = infinite ? steady_clock::time_point::max() : steady_clock::now() + opt_.Timeout;
+
+    i64 gap = 0;
+    for (;;) {
+        if (stop_.load(std::memory_order_relaxed) || store_.IsDisposed()) break;
+
+        const i64 pos = store_.GetCursorInfo(cursor_).Position;
+        if (opt_.EndRowAbs >= 0 && pos + h > opt_.EndRowAbs) break;
+
+        i64  rowAbs = -1, g = 0;
+        auto r      = store_.CursorAcquire(cursor_, h, rowAbs, g);
+        gap += g;
+        if (r == ReadResult::Overwritten) continue; // ReportGap：最古の行へ移した。続きから読む
+        if (r == ReadResult::Ok && opt_.EndRowAbs >= 0 && rowAbs + h > opt_.EndRowAbs) break; // 飛ばした先が終端を越えた
+
+        if (r == ReadResult::Ok) {
+            WindowView v;
+            v.RowAbs  = rowAbs;
+            v.Width   = opt_.Width;
+            v.Height  = h;
+            v.GapRows = gap;
+            r = store_.TryBeginWindow(rowAbs, opt_.Width, h, opt_.X0, v.Ptr, v.StrideBytes, v.TimeSec, v.Ticket);
+            if (r == ReadResult::Wrapped) {
+                const int rb = opt_.Width * store_.ElemSizeBytes();
+                scratch_.resize(static_cast<size_t>(h) * static_cast<size_t>(rb));
+                r = store_.TryCopyWindow(rowAbs, opt_.Width, h, opt_.X0, scratch_.data(), rb, v.TimeSec);
+                v.Ptr         = scratch_.data();
+                v.StrideBytes = rb;
+                v.Copied      = true;
+                v.Ticket      = WindowTicket{};
+            }
+            if (r == ReadResult::Ok) {
+                view_ = v;
+                return;
+            }
+            if (r == ReadResult::Overwritten) continue; // 次の CursorAcquire がポリシーどおりに直す
+            throw std::logic_error("SlidingWindows: unexpected read result");
+        }
+
+        // NotReady：窓の末尾まで行が入るのを待って見直す（Stop / Dispose でも起こされる）。
+        // CursorWait と同じく HeadTotal を先に読んで、絶対行の不足分に換算する
+        nanoseconds left = nanoseconds::max();
+        if (!infinite) {
+            left = duration_cast<nanoseconds>(deadline - steady_clock::now());
+            if (left <= nanoseconds::zero()) { timedOut_ = true; break; }
+        }
+        const i64 head = store_.HeadTotal();
+        store_.WaitForLines(head + std::max<i64>(pos + h - store_.EndRowAbs(), 1), left, &stop_);
+    }
+
+    done_ = true;
+    view_ = WindowView{};
+}
@@ -0,0 +1,123 @@
+#pragma once
+// LineStoreWindows.hpp
+// 重なりのある窓（高さ H、S 行ずつずらす）を C++20 の range として順に読む
+//
+//   SlidingWindowOptions o; o.Height = 256; o.Step = 64;
+//   for (const WindowView& w : SlidingWindows(store, o)) { ... w.Row<std::uint16_t>(y) ... }
+//
+// 中身は読み出しカーソル 1 つ（OpenCursor / CursorAcquire / CursorAdvance）。次の窓の最後の行が書かれるまで
+// WaitForLines と同じく眠り、書かれたらすぐ TryBeginWindow のゼロコピーの窓を返す。窓がリングの物理末尾を跨ぐときだけ
+// 内部のバッファへ TryCopyWindow でコピーする（Mirrored ならいつもゼロコピー）。
+// 1 つの SlidingWindows = 1 reader スレッド（カーソルと同じ）。窓は次の ++ までだけ有効
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+#include "lineStore2.hpp"
+
+struct SlidingWindowOptions
+{
+    int Height = 0; // 窓の行数 H
+    int Step   = 0; // 次の窓までの行数 S（0 なら H：重ならない）
+    int X0     = 0; // ROI 内の列 [X0, X0 + Width)。Width = 0 なら X0 から右端まで
+    int Width  = 0;
+
+    std::int64_t StartRowAbs = -1; // 最初の窓の先頭（絶対行）。< 0 なら作った時点の末尾から
+    std::int64_t EndRowAbs   = -1; // 窓がこの行を超えるところで終わる（< 0 なら Stop / Dispose / タイムアウトまで）
+
+    // 追い越されたとき：SkipToLatest / ReportGap は飛ばした行数を WindowView::GapRows に入れて続ける。
+    // Backpressure なら今の窓の先頭から後ろは writer に上書きさせない
+    CursorPolicy Policy = CursorPolicy::SkipToLatest;
+
+    // 1 つの窓を待つ上限。超えたら range は終わる（TimedOut() が true）
+    std::chrono::nanoseconds Timeout = std::chrono::nanoseconds::max();
+};
+
+struct WindowView
+{
+    std::int64_t RowAbs      = -1;
+    const void*  Ptr         = nullptr;
+    int          StrideBytes = 0;
+    int          Width       = 0;
+    int          Height      = 0;
+    double       TimeSec     = 0.0; // 先頭行の時刻
+    std::int64_t GapRows     = 0;   // 前の窓からこの窓までに追い越しで飛ばした行数
+    bool         Copied      = false; // リングの物理末尾を跨いだのでコピーした（検証済み）
+    WindowTicket Ticket;              // ゼロコピーの窓の検証用（LineStore::ValidateWindow）
+
+    template <class T>
+    const T* Row(int y) const noexcept {
+        return reinterpret_cast<const T*>(static_cast<const std::uint8_t*>(Ptr) + static_cast<std::int64_t>(y) * StrideBytes);
+    }
+};
+
+class SlidingWindows
+{
+public:
+    using i64 = std::int64_t;
+
+    class Iterator
+    {
+    public:
+        using iterator_concept = std::input_iterator_tag;
+        using value_type       = WindowView;
+        using difference_type  = std::ptrdiff_t;
+
+        Iterator() = default;
+
+        const WindowView& operator*()  const noexcept { return owner_->view_; }
+        const WindowView* operator->() const noexcept { return &owner_->view_; }
+
+        Iterator& operator++() { owner_->Advance(); return *this; }
+        void      operator++(int) { ++*this; }
+
+        friend bool operator==(const Iterator& it, std::default_sentinel_t) noexcept { return it.AtEnd(); }
+
+    private:
+        friend class SlidingWindows;
+        explicit Iterator(SlidingWindows* owner) noexcept : owner_(owner) {}
+        bool AtEnd() const noexcept { return !owner_ || owner_->done_; }
+        SlidingWindows* owner_ = nullptr;
+    };
+
+    // カーソルを 1 つ使う（空きが無ければ例外）。store はこれより長く生きること
+    SlidingWindows(LineStore& store, const SlidingWindowOptions& opt);
+    ~SlidingWindows();
+
+    SlidingWindows(const SlidingWindows&) = delete;
+    SlidingWindows& operator=(const SlidingWindows&) = delete;
+
+    // 最初の窓が読めるまで待つ（2 回目以降は今の位置をそのまま返す）
+    Iterator                begin();
+    std::default_sentinel_t end() const noexcept { return {}; }
+
+    // 別スレッドから：待っていれば起こして range を終わらせる
+    void Stop() noexcept;
+
+    bool       TimedOut() const noexcept { return timedOut_; }
+    CursorInfo Info() const { return store_.GetCursorInfo(cursor_); }
+
+    // ゼロコピーの窓をまだ上書きされずに読めたか（コピーした窓は常に true）
+    bool Validate(const WindowView& w) const noexcept { return w.Copied || store_.ValidateWindow(w.Ticket); }
+
+private:
+    void Advance();
+    void Fetch(); // カーソル位置の窓が読めるまで待って view_ に入れる（終わりなら done_）
+
+    LineStore&           store_;
+    SlidingWindowOptions opt_;
+    int                  cursor_;
+    std::vector<std::uint8_t> scratch_; // 物理末尾を跨ぐ窓のコピー先
+
+    WindowView        view_;
+    bool              started_;
+    bool              done_;
+    bool              timedOut_;
+    std::atomic<bool> stop_;
+};
+
+static_assert(std::input_iterator<SlidingWindows::Iterator>);
+static_assert(std::sentinel_for<std::default_sentinel_t, SlidingWindows::Iterator>);
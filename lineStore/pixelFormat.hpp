@@ -0,0 +1,40 @@
+#pragma once
+// PixelFormat.hpp
+// 画素形式（LineStore に保存する形式と、カメラから届く取り込み元の形式）
+
+// 保存形式
+enum class PixelType
+{
+    U8,
+    U16,
+};
+
+// 取り込み元の形式（名前は GenICam PFNC に合わせる）
+enum class SourceFormat
+{
+    Auto,    // PixelType と同じ（U8 → Mono8, U16 → Mono16）
+    Mono8,
+    Mono16,  // 10/12/16bit を 16bit コンテナに下詰め
+    Mono10p, // 4 画素 / 5 byte（LSB から詰める）
+    Mono12p, // 2 画素 / 3 byte（LSB から詰める）
+};
+
+constexpr int PixelTypeBytes(PixelType pt) noexcept {
+    return pt == PixelType::U8 ? 1 : 2;
+}
+
+constexpr SourceFormat ResolveSourceFormat(SourceFormat f, PixelType pt) noexcept {
+    if (f != SourceFormat::Auto) return f;
+    return pt == PixelType::U8 ? SourceFormat::Mono8 : SourceFormat::Mono16;
+}
+
+// 1 画素あたりのビット数（Auto は解決済みであること）
+constexpr int SourceBitsPerPixel(SourceFormat f) noexcept {
+    switch (f) {
+    case SourceFormat::Mono8:   return 8;
+    case SourceFormat::Mono16:  return 16;
+    case SourceFormat::Mono10p: return 10;
+    case SourceFormat::Mono12p: return 12;
+    default:                    return 0;
+    }
+}
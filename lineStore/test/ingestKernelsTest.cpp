@@ -0,0 +1,121 @@
+// IngestKernelsTest.cpp
+// 取り込み・ビニング・列統計のカーネル（ingestKernels.cpp）。CPU に合わせて選ばれたものをスカラーの参照と突き合わせる
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "lineStore/ingestKernels.hpp"
+#include "testCheck.hpp"
+
+namespace {
+
+using i64 = std::int64_t;
+
+unsigned unpack_ref(SourceFormat f, const std::uint8_t* r, int x) {
+    const int bits = (f == SourceFormat::Mono8) ? 8 : (f == SourceFormat::Mono16) ? 16
+                   : (f == SourceFormat::Mono10p) ? 10 : 12;
+    unsigned v = 0;
+    for (int b = 0; b < bits; ++b) {
+        const long p = static_cast<long>(bits) * x + b; // LSB から詰めた並び（Mono8 / Mono16 もこの式で同じになる）
+        v |= static_cast<unsigned>((r[p / 8] >> (p % 8)) & 1) << b;
+    }
+    return v;
+}
+
+LS_TEST(kernels) {
+    std::printf("  isa=%s\n", IngestIsaName());
+    std::mt19937 rng(1);
+
+    // 取り込み：ROI 位置・画素数・シフトを散らして、SIMD の本体と端数の両方を通す
+    for (auto f : { SourceFormat::Mono8, SourceFormat::Mono16, SourceFormat::Mono10p, SourceFormat::Mono12p })
+        for (auto dt : { PixelType::U8, PixelType::U16 }) {
+            const RowConvertFn fn = SelectRowConverter(f, dt);
+            for (int it = 0; it < 500; ++it) {
+                const int W  = 1 + static_cast<int>(rng() % 300);
+                const int x0 = static_cast<int>(rng() % W);
+                const int n  = 1 + static_cast<int>(rng() % (W - x0));
+                const int sh = static_cast<int>(rng() % 5);
+                std::vector<std::uint8_t> row(static_cast<size_t>(W) * 2 + 8);
+                for (auto& b : row) b = static_cast<std::uint8_t>(rng());
+                std::vector<std::uint8_t> out(static_cast<size_t>(n) * 2 + 4, 0xEE);
+                fn(row.data(), x0, n, out.data(), sh);
+
+                for (int i = 0; i < n; ++i) {
+                    unsigned v = unpack_ref(f, row.data(), x0 + i) >> sh;
+                    unsigned got;
+                    if (dt == PixelType::U8) { v = std::min(v, 255u); got = out[static_cast<size_t>(i)]; }
+                    else                     got = out[2 * static_cast<size_t>(i)] | out[2 * static_cast<size_t>(i) + 1] << 8;
+                    REQUIRE(got == v);
+                }
+                REQUIRE(out[dt == PixelType::U8 ? n : 2 * n] == 0xEE); // 書き過ぎない
+            }
+        }
+
+    // ビニング：組の和と、丸めつきの縮小（飽和を含む）
+    for (int eb : { 1, 2, 4 }) {
+        const BinPairSumFn fn = SelectBinPairSum(eb);
+        for (int it = 0; it < 200; ++it) {
+            const int count = 1 + static_cast<int>(rng() % 100);
+            std::vector<std::uint8_t>  src(static_cast<size_t>(count) * 2 * eb);
+            std::vector<std::uint32_t> acc(static_cast<size_t>(count) + 1), ref;
+            for (auto& b : src) b = static_cast<std::uint8_t>(rng());
+            if (eb == 4) for (size_t i = 3; i < src.size(); i += 4) src[i] &= 0x3F; // 和が u32 に収まる範囲
+            for (auto& a : acc) a = rng() % 1000;
+            ref = acc;
+
+            auto elem = [&](int i) {
+                std::uint32_t v = 0;
+                std::memcpy(&v, &src[static_cast<size_t>(i) * eb], static_cast<size_t>(eb));
+                return v;
+            };
+            for (int i = 0; i < count; ++i) ref[static_cast<size_t>(i)] += elem(2 * i) + elem(2 * i + 1);
+            fn(src.data(), count, acc.data());
+            REQUIRE(acc == ref);
+        }
+    }
+    for (auto dt : { PixelType::U8, PixelType::U16 }) {
+        const BinStoreFn fn  = SelectBinStore(dt);
+        const unsigned   max = (dt == PixelType::U8) ? 0xFFu : 0xFFFFu;
+        for (int it = 0; it < 200; ++it) {
+            const int count = 1 + static_cast<int>(rng() % 100);
+            const int shift = static_cast<int>(rng() % 5);
+            std::vector<std::uint32_t> acc(static_cast<size_t>(count));
+            for (auto& a : acc) a = rng() % (max * 8);
+            std::vector<std::uint8_t> out(static_cast<size_t>(count) * 2);
+            fn(acc.data(), count, shift, out.data());
+            for (int i = 0; i < count; ++i) {
+                const unsigned v   = std::min((acc[static_cast<size_t>(i)] + ((1u << shift) >> 1)) >> shift, max);
+                const unsigned got = (dt == PixelType::U8) ? out[static_cast<size_t>(i)]
+                                   : out[2 * static_cast<size_t>(i)] | out[2 * static_cast<size_t>(i) + 1] << 8;
+                REQUIRE(got == v);
+            }
+        }
+    }
+
+    // 列統計：u64 で正確に足すので完全一致
+    for (auto px : { PixelType::U8, PixelType::U16 }) {
+        const ColumnSumFn fn = SelectColumnSum(px);
+        const int         eb = (px == PixelType::U8) ? 1 : 2;
+        for (int it = 0; it < 200; ++it) {
+            const int count = 1 + static_cast<int>(rng() % 100);
+            std::vector<std::uint8_t>  row(static_cast<size_t>(count) * eb);
+            std::vector<std::uint64_t> sum(static_cast<size_t>(count), 5), sq(static_cast<size_t>(count), 7);
+            for (auto& b : row) b = static_cast<std::uint8_t>(rng());
+            auto refSum = sum, refSq = sq;
+            for (int i = 0; i < count; ++i) {
+                std::uint64_t v = 0;
+                std::memcpy(&v, &row[static_cast<size_t>(i) * eb], static_cast<size_t>(eb));
+                refSum[static_cast<size_t>(i)] += v;
+                refSq[static_cast<size_t>(i)]  += v * v;
+            }
+            fn(row.data(), count, sum.data(), sq.data());
+            REQUIRE(sum == refSum && sq == refSq);
+        }
+    }
+}
+
+} // namespace
@@ -0,0 +1,78 @@
+// LineMemoryTest.cpp
+// 画素バッファの確保（lineMemory.cpp）：NUMA の配置、ヒュージページ・NUMA が使えないときの通常の配置
+
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "lineStore/lineStore2.hpp"
+#include "testCheck.hpp"
+
+namespace {
+
+using i64 = std::int64_t;
+
+LS_TEST(numa_current_on_writer) {
+    // NUMA_CURRENT は最初に Push したスレッドで決める。それまではプリフォールトも始めない
+    const int W = 64;
+    LineStoreOptions o;
+    o.Circular             = true;
+    o.Memory.NumaNode      = LineMemoryOptions::NUMA_CURRENT;
+    o.Memory.Prefault      = true;
+    o.Memory.PrefaultAsync = true;
+    LineStore s(W, 0, W, 4096, 8, PixelType::U8, o);
+
+    CHECK(s.Memory().NumaPending());
+    CHECK(!s.Memory().PrefaultDone());
+    CHECK(s.Stats().NumaNode == -1);
+
+    int writerNode = -1;
+    std::thread writer([&] {
+        writerNode = LineMemory::CurrentNumaNode();
+        std::vector<std::uint8_t> row(static_cast<size_t>(W) * 8, 7);
+        s.PushBlock(row.data(), 8, W);
+        s.Commit();
+        s.PushBlock(row.data(), 8, W);
+    });
+    writer.join();
+
+    CHECK(!s.Memory().NumaPending());
+    CHECK(s.Memory().PrefaultDone()); // Commit が待つ
+    const auto st = s.Stats();
+    // 置けたなら writer のノード、置けなければ（NUMA の無いカーネル・権限）errno を残して通常の配置
+    CHECK((st.NumaNode == writerNode && st.NumaBindError == 0) || (st.NumaNode == -1 && st.NumaBindError != 0));
+    CHECK(s.EndRowAbs() == 16);
+}
+
+LS_TEST(numa_bind_failure_falls_back) {
+    // 無いノード（mbind が EINVAL）でも確保は失敗させず、通常の配置で使える
+    LineMemoryOptions mo;
+    mo.NumaNode = 1000;
+    mo.Prefault = true;
+    LineMemory m(1 << 20, mo);
+    REQUIRE(m.Data() != nullptr);
+    std::memset(m.Data(), 0x5a, m.Bytes());
+    CHECK(m.Data()[m.Bytes() - 1] == 0x5a);
+    CHECK(m.NumaNode() == -1);
+#if defined(__linux__)
+    CHECK(m.NumaBindError() != 0);
+#endif
+}
+
+LS_TEST(hugepage_fallback) {
+    // ヒュージページが取れなくても（プールが空・THP 無効）通常ページで確保して使える
+    for (auto huge : { HugePages::Explicit, HugePages::Transparent }) {
+        LineMemoryOptions mo;
+        mo.Huge     = huge;
+        mo.Prefault = true;
+        LineMemory m(3 << 20, mo);
+        REQUIRE(m.Data() != nullptr);
+        CHECK(reinterpret_cast<std::uintptr_t>(m.Data()) % 4096 == 0);
+        std::memset(m.Data(), 0x11, m.Bytes());
+        CHECK(m.Data()[0] == 0x11 && m.Data()[m.Bytes() - 1] == 0x11);
+        std::printf("  huge=%d active=%d\n", static_cast<int>(huge), m.HugePagesActive() ? 1 : 0);
+    }
+}
+
+} // namespace
@@ -0,0 +1,262 @@
+// LineStore2Test.cpp
+// LineStore 本体（lineStore2.cpp）：ウォームアップ、窓の取得、上書き検出、アドレッシング
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "lineStore/lineStore2.hpp"
+#include "testCheck.hpp"
+
+namespace {
+
+using i64 = std::int64_t;
+
+// 取り込み元の行 r の画素 x（行ごとに違う値）
+std::uint16_t pixel(i64 r, int x) { return static_cast<std::uint16_t>(r * 3 + x); }
+
+void push_rows(LineStore& s, i64 from, int n, int W, double timeSec) {
+    std::vector<std::uint16_t> src(static_cast<size_t>(W) * n);
+    for (int y = 0; y < n; ++y)
+        for (int x = 0; x < W; ++x) src[static_cast<size_t>(y) * W + x] = pixel(from + y, x);
+    s.PushBlock(src.data(), n, W * 2, timeSec);
+}
+
+// ptr の窓（行間隔 stride）が取り込み元の行 [srcRow, srcRow + h) の列 [x0, x0 + w) と一致するか
+bool window_is(const void* ptr, int stride, i64 srcRow, int w, int h, int x0) {
+    const auto* p = static_cast<const std::uint8_t*>(ptr);
+    for (int y = 0; y < h; ++y) {
+        const auto* row = reinterpret_cast<const std::uint16_t*>(p + static_cast<i64>(y) * stride);
+        for (int x = 0; x < w; ++x)
+            if (row[x] != pixel(srcRow + y, x0 + x)) return false;
+    }
+    return true;
+}
+
+// ---- ウォームアップ ----
+// リングが一周した後も、継ぎ目を跨ぐ窓（最新の窓を含む）が読める。時刻は行を入れた Push のもの
+void check_warmup_windows(LineStore& s, int W, int warmupMax, int blk, i64 total) {
+    for (i64 r = 0; r < total; r += blk) {
+        push_rows(s, r, blk, W, r * 0.01);
+        const i64 pushed = r + blk;
+        const i64 stored = std::min<i64>(pushed, warmupMax);
+        REQUIRE(s.StoredLines() == stored);
+
+        // 最新の窓
+        const int   h   = static_cast<int>(std::min<i64>(stored, 20));
+        const void* ptr = nullptr;
+        int         stride = 0;
+        double      t = 0;
+        REQUIRE(s.TryGetLatestWindowPtr(W - 4, h, 2, ptr, stride, t));
+        REQUIRE(window_is(ptr, stride, pushed - h, W - 4, h, 2));
+        const i64 top = pushed - h;
+        CHECK(t == (top / blk) * blk * 0.01);
+
+        // 全ての開始行（継ぎ目を跨ぐものを含む）
+        for (i64 st = 0; st + h <= stored; ++st) {
+            REQUIRE(s.TryGetWindowPtr(st, W, h, 0, ptr, stride, t));
+            REQUIRE(window_is(ptr, stride, pushed - stored + st, W, h, 0));
+        }
+    }
+}
+
+LS_TEST(warmup_seam_windows) {
+    const int W = 16;
+    LineStoreOptions o;
+    o.Circular = true;
+    LineStore s(W, 0, W, 200, 50, PixelType::U16, o);
+    check_warmup_windows(s, W, 50, 7, 140);
+}
+
+LS_TEST(warmup_seam_windows_mirrored) {
+    // ウォームアップ領域がリング全体：継ぎ目は二重マップで続いている（無ければ写しで読む）
+    const int W = 16;
+    LineStoreOptions o;
+    o.Circular = true;
+    o.Mirrored = true;
+    LineStore s(W, 0, W, 256, 256, PixelType::U16, o);
+    check_warmup_windows(s, W, 256, 40, 600);
+}
+
+LS_TEST(warmup_rotation_at_commit) {
+    // 一周したリングを Commit で回すと、最古の行から物理順に並ぶ（窓は継ぎ目無しでそのまま指せる）
+    const int W = 16;
+    LineStoreOptions o;
+    o.Circular = true;
+    LineStore s(W, 0, W, 200, 50, PixelType::U16, o);
+    for (i64 r = 0; r < 140; r += 7) push_rows(s, r, 7, W, r * 0.01);
+    s.Commit();
+
+    CHECK(s.StoredLines() == 50);
+    CHECK(s.OldestRowAbs() == 0 && s.EndRowAbs() == 50);
+
+    const void* ptr = nullptr;
+    int         stride = 0;
+    double      t = 0;
+    REQUIRE(s.TryGetWindowPtr(0, W, 50, 0, ptr, stride, t));
+    CHECK(window_is(ptr, stride, 90, W, 50, 0)); // 保持しているのは取り込み元の行 [90, 140)
+    CHECK(t == 84 * 0.01);                        // 行 90 は r = 84 の Push で入った
+
+    // Commit 後の行はその続き
+    push_rows(s, 140, 30, W, 1.40);
+    std::vector<std::uint16_t> d(static_cast<size_t>(W) * 40);
+    REQUIRE(s.TryCopyWindow(40, W, 40, 0, d.data(), W * 2, t) == ReadResult::Ok);
+    CHECK(window_is(d.data(), W * 2, 130, W, 40, 0));
+}
+
+// ---- 上書き検出 ----
+LS_TEST(overwrite_detection) {
+    // 容量 64 のリング：読めるのは末尾 64 行。それより古い行・まだ無い行は読まない
+    const int W = 16;
+    LineStoreOptions o;
+    o.Circular = true;
+    LineStore s(W, 0, W, 64, 8, PixelType::U16, o);
+    std::vector<std::uint16_t> d(static_cast<size_t>(W) * 8);
+    double t = 0;
+    CHECK(s.TryCopyWindow(0, W, 8, 0, d.data(), W * 2, t) == ReadResult::NotReady); // 未 Commit
+    s.Commit();
+    for (i64 r = 0; r < 100; r += 10) push_rows(s, r, 10, W, r * 0.01);
+
+    CHECK(s.OldestRowAbs() == 36);
+    CHECK(s.TryCopyWindow(35, W, 8, 0, d.data(), W * 2, t) == ReadResult::Overwritten);
+    CHECK(s.TryCopyWindow(96, W, 8, 0, d.data(), W * 2, t) == ReadResult::NotReady);
+    CHECK(s.TryCopyWindow(36, W, 8, 0, d.data(), W * 2, t) == ReadResult::Ok);
+    CHECK(window_is(d.data(), W * 2, 36, W, 8, 0));
+    CHECK(s.TryCopyWindow(36, W, 65, 0, d.data(), W * 2, t) == ReadResult::InvalidArg);
+
+    // ゼロコピー版：使っている間に一周されればチケットの検証で分かる
+    const void*  ptr    = nullptr;
+    int          stride = 0;
+    WindowTicket ticket;
+    REQUIRE(s.TryBeginWindow(40, W, 8, 0, ptr, stride, t, ticket) == ReadResult::Ok);
+    CHECK(s.ValidateWindow(ticket));
+    push_rows(s, 100, 10, W, 1.0);
+    CHECK(!s.ValidateWindow(ticket));
+    CHECK(s.TryBeginWindow(60, W, 8, 0, ptr, stride, t, ticket) == ReadResult::Wrapped); // 物理末尾を跨ぐ
+    CHECK(s.Stats().OverwrittenReads == 2);
+}
+
+LS_TEST(overwrite_detection_concurrent) {
+    // 最古の行を読み続ける reader：Ok を返した窓は必ず取り込み元の行と一致する（書きかけ・上書き済みを返さない）
+    // 大きめの Push で最古の行を次々に潰す（コピー中に上書きされる読み出しが必ず出る）
+    const int W = 512, blk = 32, h = 32;
+    LineStoreOptions o;
+    o.Circular = true;
+    LineStore s(W, 0, W, 64, 8, PixelType::U16, o);
+    s.Commit();
+
+    std::atomic<bool> done{ false };
+    std::atomic<int>  reads{ 0 };
+    int               ok = 0, overwritten = 0, wrong = 0;
+    std::thread reader([&] {
+        std::vector<std::uint16_t> d(static_cast<size_t>(W) * h);
+        double t = 0;
+        while (!done.load(std::memory_order_acquire)) {
+            const i64 row = s.OldestRowAbs();
+            const auto r = s.TryCopyWindow(row, W, h, 0, d.data(), W * 2, t);
+            reads.fetch_add(1);
+            if (r == ReadResult::Ok) {
+                ++ok;
+                if (!window_is(d.data(), W * 2, row, W, h, 0)) ++wrong;
+            } else if (r == ReadResult::Overwritten) {
+                ++overwritten;
+            }
+        }
+    });
+    while (reads.load() == 0) std::this_thread::yield();
+    for (i64 r = 0; r < 200000; r += blk) push_rows(s, r, blk, W, r * 1e-6);
+    done.store(true, std::memory_order_release);
+    reader.join();
+
+    CHECK(wrong == 0);
+    CHECK(s.Stats().OverwrittenReads == overwritten);
+    std::printf("  ok=%d overwritten=%d\n", ok, overwritten);
+}
+
+// ---- アドレッシング ----
+// Commit 後のリングへ続きの行を blk 行ずつ total 行まで Push しながら、保持している全ての開始行を TryBeginWindow で読む。
+// 物理末尾を跨ぐ窓（Wrapped）を wrapped に数える。Ok の窓は取り込み元と一致し、行の先頭は RowPitchBytes 間隔
+void check_begin_windows(LineStore& s, int W, int blk, i64 total, i64& wrapped) {
+    wrapped = 0;
+    for (i64 r = s.EndRowAbs(); r < total; r += blk) {
+        push_rows(s, r, blk, W, r * 0.01);
+        const i64 stored = s.StoredLines();
+        const int h      = static_cast<int>(std::min<i64>(stored, 24));
+        for (i64 st = s.OldestRowAbs(); st + h <= s.EndRowAbs(); ++st) {
+            const void*  ptr    = nullptr;
+            int          stride = 0;
+            double       t      = 0;
+            WindowTicket ticket;
+            const auto   res = s.TryBeginWindow(st, W, h, 0, ptr, stride, t, ticket);
+            if (res == ReadResult::Wrapped) { ++wrapped; continue; }
+            REQUIRE(res == ReadResult::Ok);
+            REQUIRE(stride == s.RowPitchBytes());
+            REQUIRE(window_is(ptr, stride, st, W, h, 0));
+            REQUIRE(s.ValidateWindow(ticket));
+        }
+    }
+}
+
+LS_TEST(mirrored_ring_windows) {
+    // 二重マップ：容量はマップ粒度に切り上げ、末尾を跨ぐ窓もそのまま指せる（二重マップできなければ Wrapped で写しに回す）
+    const int W = 16;
+    LineStoreOptions o;
+    o.Circular = true;
+    o.Mirrored = true;
+    LineStore s(W, 0, W, 100, 8, PixelType::U16, o);
+    s.Commit();
+    CHECK(s.CapacityLines() >= 100);
+    CHECK(s.CapacityLines() * s.RowPitchBytes() % static_cast<i64>(LineMemory::MirrorGranularity()) == 0);
+
+    i64 wrapped = -1;
+    check_begin_windows(s, W, 13, s.CapacityLines() * 3, wrapped);
+    std::printf("  mirrored=%d wrapped=%lld\n", s.Mirrored() ? 1 : 0, static_cast<long long>(wrapped));
+    CHECK(s.Mirrored() ? wrapped == 0 : wrapped > 0);
+
+    bool threw = false;
+    LineStoreOptions lin;
+    lin.Mirrored = true;
+    try { LineStore bad(W, 0, W, 100, 8, PixelType::U16, lin); } catch (const std::invalid_argument&) { threw = true; }
+    CHECK(threw);
+}
+
+LS_TEST(row_pitch_and_pow2) {
+    // 行の間隔は RowAlignBytes に切り上げ（行の先頭がそろう）。容量は 2 のべき乗に切り上げて & で物理行を求める
+    const int W = 20; // 40 バイト
+    LineStoreOptions o;
+    o.Circular           = true;
+    o.RowAlignBytes      = 64;
+    o.PowerOfTwoCapacity = true;
+    LineStore s(W, 0, W, 100, 8, PixelType::U16, o);
+    s.Commit();
+    CHECK(s.CapacityLines() == 128);
+    CHECK(s.RowBytes() == 40 && s.RowPitchBytes() == 64);
+
+    i64 wrapped = -1;
+    check_begin_windows(s, W, 11, 600, wrapped);
+    CHECK(wrapped > 0);
+
+    const void* ptr    = nullptr;
+    int         stride = 0;
+    for (int k = 0; k < 5; ++k) {
+        push_rows(s, s.EndRowAbs(), 1, W, 7.0 + k * 0.01);
+        REQUIRE(s.TryGetLatestWindowPtr(W, 1, 0, ptr, stride));
+        CHECK(reinterpret_cast<std::uintptr_t>(ptr) % 64 == 0);
+    }
+
+    auto throws = [&](LineStoreOptions bad) {
+        try { LineStore x(W, 0, W, 100, 8, PixelType::U16, bad); } catch (const std::invalid_argument&) { return true; }
+        return false;
+    };
+    LineStoreOptions odd = o;
+    odd.RowAlignBytes = 48;
+    CHECK(throws(odd));
+    LineStoreOptions lin = o;
+    lin.Circular = false;
+    CHECK(throws(lin));
+}
+
+} // namespace
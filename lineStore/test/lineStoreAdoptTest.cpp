@@ -0,0 +1,149 @@
+// LineStoreAdoptTest.cpp
+// 取り込みブロックの採用（lineStoreAdopt.cpp）：フレームを指す窓、ブロックを跨ぐ窓のコピー、保持期間・記述子数での解放
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include "lineStore/lineStore2.hpp"
+#include "testCheck.hpp"
+
+namespace {
+
+using i64 = std::int64_t;
+
+constexpr int SW = 24, RX = 4, W = 16; // 取り込み元の全幅・ROI
+
+std::uint16_t pixel(i64 r, int x) { return static_cast<std::uint16_t>(r * 3 + x); }
+
+// 取り込み元の行 [from, from + n)（全幅、行間隔 stride バイト）
+std::vector<std::uint8_t> frame_rows(i64 from, int n, int stride) {
+    std::vector<std::uint8_t> buf(static_cast<size_t>(stride) * n, 0xee);
+    for (int y = 0; y < n; ++y)
+        for (int x = 0; x < SW; ++x) {
+            const std::uint16_t v = pixel(from + y, x);
+            std::memcpy(buf.data() + static_cast<size_t>(y) * stride + x * 2, &v, 2);
+        }
+    return buf;
+}
+
+// ptr の窓が ROI 内の列 [0, w) の行 [srcRow, srcRow + h) と一致するか
+bool window_is(const void* ptr, int stride, i64 srcRow, int w, int h) {
+    const auto* p = static_cast<const std::uint8_t*>(ptr);
+    for (int y = 0; y < h; ++y) {
+        const auto* row = reinterpret_cast<const std::uint16_t*>(p + static_cast<i64>(y) * stride);
+        for (int x = 0; x < w; ++x)
+            if (row[x] != pixel(srcRow + y, RX + x)) return false;
+    }
+    return true;
+}
+
+LineStoreOptions adopt_options(int maxFrames) {
+    LineStoreOptions o;
+    o.Circular       = true;
+    o.AdoptFrames    = true;
+    o.AdoptMaxFrames = maxFrames;
+    return o;
+}
+
+struct Held
+{
+    i64                 Start;
+    int                 Rows;
+    const std::uint8_t* Data;
+    int                 Stride;
+};
+
+LS_TEST(adopt_frames_windows) {
+    // 容量 64 行。ブロックの行数・行間隔はまちまち
+    LineStore s(SW, RX, W, 64, 8, PixelType::U16, adopt_options(1024));
+    std::vector<std::vector<std::uint8_t>> buffers; // ドライバのバッファの代わり（解放後もマップされたまま）
+    std::vector<Held>                      held;
+    const int sizes[] = { 5, 9, 13 };
+    const int h       = 8;
+    int       zeroCopy = 0, copied = 0;
+
+    i64 end = 0;
+    for (int k = 0; end < 400; ++k) {
+        const int rows   = sizes[k % 3];
+        const int stride = SW * 2 + 16 * (k % 2);
+        buffers.push_back(frame_rows(end, rows, stride));
+        auto& b = buffers.back();
+        held.push_back({ end, rows, b.data(), stride });
+        REQUIRE(s.AdoptBlock(CameraFrame(b.data(), b.size(), nullptr), rows, stride, end * 0.01));
+        end += rows;
+        REQUIRE(s.EndRowAbs() == end);
+
+        // 最古の行は、末尾 64 行に掛かる最古のブロックの先頭
+        i64 oldest = end;
+        for (auto it = held.rbegin(); it != held.rend() && it->Start + it->Rows > end - 64; ++it) oldest = it->Start;
+        REQUIRE(s.OldestRowAbs() == oldest);
+
+        for (i64 st = oldest; st + h <= end; ++st) {
+            std::vector<std::uint16_t> d(static_cast<size_t>(W) * h);
+            double t = 0;
+            REQUIRE(s.TryCopyWindow(st, W, h, 0, d.data(), W * 2, t) == ReadResult::Ok);
+            REQUIRE(window_is(d.data(), W * 2, st, W, h));
+
+            // ブロック 1 つに収まる窓はフレームをそのまま指す（行間隔もそのブロックのもの）
+            const Held* blk = nullptr;
+            for (const auto& b2 : held)
+                if (b2.Start <= st && st < b2.Start + b2.Rows) blk = &b2;
+            REQUIRE(blk != nullptr);
+            const void*  ptr    = nullptr;
+            int          stride2 = 0;
+            WindowTicket ticket;
+            const auto   res = s.TryBeginWindow(st, W, h, 0, ptr, stride2, t, ticket);
+            if (res == ReadResult::Ok) {
+                REQUIRE(st + h <= blk->Start + blk->Rows);
+                REQUIRE(ptr == blk->Data + (st - blk->Start) * blk->Stride + RX * 2);
+                REQUIRE(stride2 == blk->Stride);
+                REQUIRE(std::fabs(t - st * 0.01) < 1e-9); // Push の間を補間
+                ++zeroCopy;
+            } else {
+                REQUIRE(res == ReadResult::Wrapped);
+                REQUIRE(st + h > blk->Start + blk->Rows);
+                ++copied;
+            }
+        }
+    }
+    CHECK(zeroCopy > 0 && copied > 0);
+
+    // 解放したブロックの行は読めない
+    std::vector<std::uint16_t> d(static_cast<size_t>(W) * h);
+    double t = 0;
+    CHECK(s.TryCopyWindow(s.OldestRowAbs() - 1, W, 1, 0, d.data(), W * 2, t) == ReadResult::Overwritten);
+
+    // 画素はコピーで入れられない
+    bool threw = false;
+    try { s.PushBlock(buffers[0].data(), 1, SW * 2); } catch (const std::logic_error&) { threw = true; }
+    CHECK(threw);
+}
+
+LS_TEST(adopt_frames_max_frames) {
+    // 記述子が満杯なら、保持期間内でも最古のブロックから解放する
+    LineStore s(SW, RX, W, 1000, 8, PixelType::U16, adopt_options(3)); // 4 に切り上げ
+    std::vector<std::vector<std::uint8_t>> buffers;
+    for (int k = 0; k < 6; ++k) {
+        buffers.push_back(frame_rows(k * 3, 3, SW * 2));
+        auto& b = buffers.back();
+        REQUIRE(s.AdoptBlock(CameraFrame(b.data(), b.size(), nullptr), 3, SW * 2, k * 0.01));
+    }
+    CHECK(s.OldestRowAbs() == 6 && s.EndRowAbs() == 18);
+
+    // 小さすぎるフレーム・リングでない構成は受けない
+    bool threw = false;
+    std::vector<std::uint8_t> small(static_cast<size_t>(SW) * 2);
+    try { s.AdoptBlock(CameraFrame(small.data(), small.size(), nullptr), 2, SW * 2); } catch (const std::invalid_argument&) { threw = true; }
+    CHECK(threw);
+
+    threw = false;
+    LineStoreOptions lin = adopt_options(4);
+    lin.Circular = false;
+    try { LineStore bad(SW, RX, W, 100, 8, PixelType::U16, lin); } catch (const std::invalid_argument&) { threw = true; }
+    CHECK(threw);
+}
+
+} // namespace
@@ -0,0 +1,103 @@
+// LineStoreBinningTest.cpp
+// ビニングレベル（lineStoreBinning.cpp）：f×f の平均・和、ウォームアップ行からの作成、行の時刻の対応
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "lineStore/lineStore2.hpp"
+#include "testCheck.hpp"
+
+namespace {
+
+using i64 = std::int64_t;
+
+std::uint8_t pixel(i64 r, int x) { return static_cast<std::uint8_t>((r * 7 + x * 13) % 256); }
+
+void push_rows(LineStore& s, i64 from, int n, int W, double timeSec) {
+    std::vector<std::uint8_t> src(static_cast<size_t>(W) * n);
+    for (int y = 0; y < n; ++y)
+        for (int x = 0; x < W; ++x) src[static_cast<size_t>(y) * W + x] = pixel(from + y, x);
+    s.PushBlock(src.data(), n, W, timeSec);
+}
+
+// 元の行 [r*f, r*f+f)・列 [c*f, c*f+f) の和
+std::uint32_t block_sum(i64 r, int c, int f) {
+    std::uint32_t sum = 0;
+    for (int y = 0; y < f; ++y)
+        for (int x = 0; x < f; ++x) sum += pixel(r * f + y, c * f + x);
+    return sum;
+}
+
+LS_TEST(bin_levels_mean) {
+    const int W = 36; // 8x では端の 4 列を捨てる
+    LineStoreOptions o;
+    o.Circular  = true;
+    o.BinLevels = 3;
+    LineStore s(W, 0, W, 256, 16, PixelType::U8, o);
+    push_rows(s, 0, 10, W, 0.0); // ウォームアップの行も Commit でレベルに入る
+    s.Commit();
+    for (i64 r = 10; r < 600; r += 5) push_rows(s, r, 5, W, r * 0.01);
+    REQUIRE(s.EndRowAbs() == 600); // レベルの行がすべて元のストアに残っている（8 の倍数）
+
+    CHECK(s.Level(16) == nullptr);
+    for (int f : { 2, 4, 8 }) {
+        const LineStore* lv = s.Level(f);
+        REQUIRE(lv != nullptr);
+        CHECK(lv->BinFactor() == f);
+        CHECK(lv->Width() == W / f);
+        CHECK(lv->CapacityLines() == 256 / f);
+        CHECK(lv->EndRowAbs() == 600 / f);
+
+        const int                 w = lv->Width();
+        std::vector<std::uint8_t> row(static_cast<size_t>(w));
+        bool                      same = true, timesOk = true;
+        for (i64 r = lv->OldestRowAbs(); r < lv->EndRowAbs(); ++r) {
+            double t = 0, parentT = 0;
+            REQUIRE(lv->TryCopyWindow(r, w, 1, 0, row.data(), w, t) == ReadResult::Ok);
+            for (int c = 0; c < w; ++c) {
+                const std::uint32_t n = static_cast<std::uint32_t>(f * f);
+                same = same && row[static_cast<size_t>(c)] == (block_sum(r, c, f) + n / 2) / n;
+            }
+            // 行の時刻は元の先頭行の時刻。時刻 → 行もレベルの行で返す
+            REQUIRE(s.RowTimeSec(r * f, parentT));
+            timesOk = timesOk && t == parentT && lv->FindRowAtTime(t) == r;
+        }
+        CHECK(same);
+        CHECK(timesOk);
+    }
+
+    // レベルへは書き込めない
+    bool threw = false;
+    std::vector<std::uint8_t> src(static_cast<size_t>(W) / 2);
+    try { s.Level(2)->PushBlock(src.data(), 1, W / 2); } catch (const std::logic_error&) { threw = true; }
+    CHECK(threw);
+}
+
+LS_TEST(bin_levels_sum) {
+    // Sum は U16 に保存し、U16 の元なら 65535 で飽和する
+    const int W = 16;
+    LineStoreOptions o;
+    o.Circular  = true;
+    o.BinLevels = 2;
+    o.Bin       = BinMode::Sum;
+    LineStore s8(W, 0, W, 64, 8, PixelType::U8, o);
+    s8.Commit();
+    push_rows(s8, 0, 8, W, 0.0);
+    const LineStore* lv = s8.Level(4);
+    REQUIRE(lv != nullptr && lv->PixelT() == PixelType::U16);
+    std::vector<std::uint16_t> row(static_cast<size_t>(W / 4));
+    double t = 0;
+    REQUIRE(lv->TryCopyWindow(1, W / 4, 1, 0, row.data(), W / 2, t) == ReadResult::Ok);
+    CHECK(row[2] == block_sum(1, 2, 4));
+
+    LineStore s16(W, 0, W, 64, 8, PixelType::U16, o);
+    s16.Commit();
+    std::vector<std::uint16_t> bright(static_cast<size_t>(W) * 4, 60000);
+    s16.PushBlock(bright.data(), 4, W * 2, 0.0);
+    std::vector<std::uint16_t> row2(static_cast<size_t>(W / 2));
+    REQUIRE(s16.Level(2)->TryCopyWindow(0, W / 2, 1, 0, row2.data(), W, t) == ReadResult::Ok);
+    CHECK(row2[0] == 65535);
+}
+
+} // namespace
@@ -0,0 +1,88 @@
+// LineStoreColdTest.cpp
+// コールド層（lineStoreCold.cpp / coldCodec.cpp）
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "lineStore/coldCodec.hpp"
+#include "lineStore/lineStore2.hpp"
+#include "testCheck.hpp"
+
+namespace {
+
+using i64 = std::int64_t;
+
+LS_TEST(cold_codec) {
+    // 行の往復：なめらか / 乱数（圧縮できない）/ 一定、端数のブロックを含む幅で
+    std::mt19937 rng(3);
+    for (int w : { 1, 2, 31, 32, 33, 64, 1000 })
+        for (int eb : { 1, 2 })
+            for (int kind = 0; kind < 3; ++kind) {
+                std::vector<std::uint8_t> src(static_cast<size_t>(w) * eb);
+                for (int x = 0; x < w; ++x) {
+                    const std::uint32_t v = (kind == 0) ? 1000 + static_cast<int>(200 * std::sin(x * 0.01))
+                                          : (kind == 1) ? rng() : 7u;
+                    if (eb == 2) { const auto v16 = static_cast<std::uint16_t>(v); std::memcpy(&src[2 * x], &v16, 2); }
+                    else         src[static_cast<size_t>(x)] = static_cast<std::uint8_t>(v);
+                }
+                std::vector<std::uint8_t> enc(ColdMaxRowBytes(w));
+                const size_t n = ColdEncodeRow(src.data(), w, eb, enc.data());
+                CHECK(n <= enc.size());
+
+                std::vector<std::uint8_t> out(src.size());
+                CHECK(ColdDecodeRow(enc.data(), w, eb, out.data()) == n);
+                CHECK(out == src);
+            }
+
+    // ストア：リングから押し出された行をコールド層から読む（境界を跨ぐ窓も）
+    const int  W = 512;
+    const int  B = 64;
+    const i64  N = 8000; // コールド層の容量内（置き換えは起こさない）
+    LineStoreOptions o;
+    o.Circular          = true;
+    o.ColdCapacityLines = 10000;
+    o.ColdChunkRows     = 256;
+    LineStore s(W, 0, W, 2048, 8, PixelType::U16, o);
+    s.Commit();
+
+    auto pixel = [](i64 row, int x) { return static_cast<std::uint16_t>(2000 + 500 * std::sin(row * 0.01 + x * 0.003)); };
+    std::vector<std::uint16_t> src(static_cast<size_t>(W) * B);
+    for (i64 r = 0; r < N; r += B) {
+        for (int y = 0; y < B; ++y)
+            for (int x = 0; x < W; ++x) src[static_cast<size_t>(y) * W + x] = pixel(r + y, x);
+        s.PushBlock(src.data(), B, W * 2, 100.0 + r * 1e-3);
+
+        // 圧縮スレッドを待つ（時刻が確定したチャンク = 最後のセグメントより前のぶんまで）。取りこぼしがあればテストにならない
+        const i64  ready    = (r / o.ColdChunkRows) * o.ColdChunkRows;
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        for (;;) {
+            const auto st = s.Stats();
+            if (st.ColdRows + st.ColdLostRows >= ready || std::chrono::steady_clock::now() > deadline) break;
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    }
+    const auto st = s.Stats();
+    CHECK(st.ColdLostRows == 0);
+    CHECK(st.ColdRows > 0 && st.ColdBytes < st.ColdRows * W * 2);
+    REQUIRE(s.ColdOldestRowAbs() == 0);
+
+    std::vector<std::uint16_t> d(100 * 32);
+    for (i64 row : { i64{ 5 }, s.OldestRowAbs() - 10, s.OldestRowAbs() + 3 }) {
+        double t = 0;
+        REQUIRE(s.TryCopyWindow(row, 100, 32, 50, d.data(), 200, t) == ReadResult::Ok);
+        bool same = true;
+        for (int y = 0; y < 32; ++y)
+            for (int x = 0; x < 100; ++x) same &= (d[static_cast<size_t>(y) * 100 + x] == pixel(row + y, x + 50));
+        CHECK(same);
+        CHECK(std::fabs(t - (100.0 + row * 1e-3)) < 1e-6);
+        CHECK(s.FindRowAtTime(100.0 + (row + 0.5) * 1e-3) == row); // 行の間の時刻（丸めで隣の行にならないように）
+    }
+    s.Dispose();
+}
+
+} // namespace
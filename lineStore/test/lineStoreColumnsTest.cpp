@@ -0,0 +1,148 @@
+// LineStoreColumnsTest.cpp
+// 取り込み時の列統計とフラットフィールド（lineStoreColumns.cpp）：値、初期化、数え直し、Push 中の読み出し
+
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "lineStore/lineStore2.hpp"
+#include "testCheck.hpp"
+
+namespace {
+
+using i64 = std::int64_t;
+
+LineStoreOptions stats_options(ColumnStatsMode mode, double alpha = 1.0 / 1024) {
+    LineStoreOptions o;
+    o.Circular         = true;
+    o.ColumnStats      = mode;
+    o.ColumnStatsAlpha = alpha;
+    return o;
+}
+
+// 値 v(r, x) の行を n 行
+void push_rows(LineStore& s, int W, int n, std::uint8_t (*v)(int, int)) {
+    std::vector<std::uint8_t> src(static_cast<size_t>(W) * n);
+    for (int y = 0; y < n; ++y)
+        for (int x = 0; x < W; ++x) src[static_cast<size_t>(y) * W + x] = v(y, x);
+    s.PushBlock(src.data(), n, W);
+}
+
+LS_TEST(columns_cumulative) {
+    // 列 x は 0, x, 2x, 3x（平均 1.5x、母分散 1.25x²）
+    const int W = 20;
+    LineStore s(W, 0, W, 256, 8, PixelType::U8, stats_options(ColumnStatsMode::Cumulative));
+    s.Commit();
+    CHECK(s.ColumnStats().Rows == 0);
+    push_rows(s, W, 4, [](int y, int x) { return static_cast<std::uint8_t>(y * x); });
+
+    const auto st = s.ColumnStats();
+    REQUIRE(st.Rows == 4);
+    bool ok = true;
+    for (int x = 0; x < W; ++x)
+        ok = ok && std::fabs(st.Mean[x] - 1.5 * x) < 1e-9 && std::fabs(st.Variance[x] - 1.25 * x * x) < 1e-9;
+    CHECK(ok);
+
+    // 数え直しは次の Push から（それまでは Rows = 0）
+    s.ResetColumnStats();
+    CHECK(s.ColumnStats().Rows == 0);
+    push_rows(s, W, 2, [](int, int x) { return static_cast<std::uint8_t>(x); });
+    const auto re = s.ColumnStats();
+    REQUIRE(re.Rows == 2);
+    CHECK(re.Mean[7] == 7.0 && re.Variance[7] == 0.0);
+}
+
+LS_TEST(columns_exponential_seed) {
+    // 平均は最初の行、分散は 0 から。数え直した後も同じ
+    const int W = 16;
+    LineStore s(W, 0, W, 256, 8, PixelType::U8, stats_options(ColumnStatsMode::Exponential, 0.5));
+    s.Commit();
+    push_rows(s, W, 1, [](int, int x) { return static_cast<std::uint8_t>(100 + x); });
+    auto st = s.ColumnStats();
+    REQUIRE(st.Rows == 1);
+    CHECK(st.Mean[3] == 103.0 && st.Variance[3] == 0.0);
+
+    push_rows(s, W, 1, [](int, int x) { return static_cast<std::uint8_t>(120 + x); });
+    st = s.ColumnStats();
+    CHECK(st.Rows == 2);
+    CHECK(std::fabs(st.Mean[3] - 113.0) < 1e-3);
+    CHECK(st.Variance[3] > 0.0);
+
+    s.ResetColumnStats();
+    push_rows(s, W, 1, [](int, int x) { return static_cast<std::uint8_t>(10 + x); });
+    st = s.ColumnStats();
+    CHECK(st.Rows == 1);
+    CHECK(st.Mean[3] == 13.0 && st.Variance[3] == 0.0);
+}
+
+LS_TEST(columns_off_throws) {
+    LineStore s(8, 0, 8, 256, 8, PixelType::U8, stats_options(ColumnStatsMode::Off));
+    bool threw = false;
+    try { s.ResetColumnStats(); } catch (const std::logic_error&) { threw = true; }
+    CHECK(threw);
+}
+
+LS_TEST(columns_flat_field) {
+    // (v - dark) * gain を丸めて 0..255 に収める。統計は補正前の値
+    const int W = 16;
+    LineStore s(W, 0, W, 256, 8, PixelType::U8, stats_options(ColumnStatsMode::Cumulative));
+    s.Commit();
+    std::vector<float> dark(W, 10.0f), gain(W, 2.0f);
+    gain[1] = 100.0f; // 飽和
+    dark[2] = 200.0f; // 負は 0
+    s.SetFlatField(dark, gain);
+    push_rows(s, W, 2, [](int, int) { return static_cast<std::uint8_t>(50); });
+
+    std::vector<std::uint8_t> out(static_cast<size_t>(W) * 2);
+    double t = 0;
+    REQUIRE(s.TryCopyWindow(0, W, 2, 0, out.data(), W, t) == ReadResult::Ok);
+    CHECK(out[0] == 80 && out[1] == 255 && out[2] == 0 && out[W] == 80);
+    CHECK(s.ColumnStats().Mean[0] == 50.0);
+
+    s.ClearFlatField();
+    push_rows(s, W, 1, [](int, int) { return static_cast<std::uint8_t>(50); });
+    REQUIRE(s.TryCopyWindow(2, W, 1, 0, out.data(), W, t) == ReadResult::Ok);
+    CHECK(out[0] == 50);
+}
+
+LS_TEST(columns_read_while_pushing) {
+    // Push の k 回目の行は列 x で (k % 100) + x。どの写しも Push の区切りのもの（列どうしの差がちょうど x）
+    const int W = 64, blk = 8, pushes = 20000;
+    LineStore s(W, 0, W, 256, 8, PixelType::U8, stats_options(ColumnStatsMode::Cumulative));
+    s.Commit();
+
+    std::atomic<bool> done{ false };
+    std::atomic<int>  reads{ 0 };
+    int               torn = 0;
+    std::thread reader([&] {
+        while (!done.load(std::memory_order_acquire)) {
+            const auto st = s.ColumnStats();
+            ++reads;
+            if (st.Rows % blk != 0) { ++torn; continue; }
+            if (st.Rows == 0) continue;
+            for (int x = 1; x < W; ++x)
+                if (std::fabs(st.Mean[x] - st.Mean[0] - x) > 1e-6) { ++torn; break; }
+        }
+    });
+
+    while (reads.load() == 0) std::this_thread::yield(); // reader が回り始めてから
+
+    std::vector<std::uint8_t> src(static_cast<size_t>(W) * blk);
+    for (int k = 0; k < pushes; ++k) {
+        for (int y = 0; y < blk; ++y)
+            for (int x = 0; x < W; ++x) src[static_cast<size_t>(y) * W + x] = static_cast<std::uint8_t>(k % 100 + x);
+        s.PushBlock(src.data(), blk, W);
+    }
+    done.store(true, std::memory_order_release);
+    reader.join();
+
+    CHECK(torn == 0);
+    std::printf("  reads=%d\n", reads.load());
+    CHECK(s.ColumnStats().Rows == static_cast<i64>(pushes) * blk);
+}
+
+} // namespace
@@ -0,0 +1,75 @@
+// LineStoreCursorTest.cpp
+// 読み出しカーソル（lineStoreCursor.cpp）
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "lineStore/lineStore2.hpp"
+#include "testCheck.hpp"
+
+namespace {
+
+using i64 = std::int64_t;
+
+LS_TEST(cursor) {
+    const int W = 16;
+    LineStoreOptions o;
+    o.Circular = true;
+    std::vector<std::uint8_t> blk(static_cast<size_t>(W) * 600);
+    for (int y = 0; y < 600; ++y) std::memset(&blk[static_cast<size_t>(y) * W], y & 255, W);
+
+    // 追い越し：ReportGap は最古の行へ移して 1 度だけ Overwritten、SkipToLatest は最新の窓へ
+    {
+        LineStore s(W, 0, W, 256, 8, PixelType::U8, o);
+        s.Commit();
+        const int gap  = s.OpenCursor(CursorPolicy::ReportGap, 0);
+        const int skip = s.OpenCursor(CursorPolicy::SkipToLatest, 0);
+        s.PushBlock(blk.data(), 600, W);
+
+        i64 row = -1, lost = 0;
+        CHECK(s.CursorAcquire(gap, 8, row, lost) == ReadResult::Overwritten);
+        CHECK(row == 600 - 256 && lost == 600 - 256);
+        CHECK(s.CursorAcquire(gap, 8, row, lost) == ReadResult::Ok);
+        CHECK(row == 600 - 256 && lost == 0);
+
+        std::vector<std::uint8_t> d(static_cast<size_t>(W) * 8);
+        double t = 0;
+        CHECK(s.TryCopyWindow(row, W, 8, 0, d.data(), W, t) == ReadResult::Ok);
+        CHECK(d[0] == static_cast<std::uint8_t>(row));
+
+        const auto gi = s.GetCursorInfo(gap);
+        CHECK(gi.Overruns == 1 && gi.LostRows == 600 - 256);
+
+        CHECK(s.CursorAcquire(skip, 8, row, lost) == ReadResult::Ok);
+        CHECK(row == 600 - 8 && lost == 600 - 8);
+        CHECK(s.GetCursorInfo(skip).Lag == 8);
+    }
+
+    // Backpressure：未読の行は上書きせず、入り切らない行は捨てて false。読み進めれば書ける
+    {
+        LineStore s(W, 0, W, 256, 8, PixelType::U8, o);
+        s.Commit();
+        const int bp = s.OpenCursor(CursorPolicy::Backpressure, 0);
+
+        CHECK(s.PushBlock(blk.data(), 200, W));
+        CHECK(!s.PushBlock(blk.data() + 200 * W, 100, W));
+        CHECK(s.EndRowAbs() == 256);
+        CHECK(s.DroppedRows() == 44);
+
+        i64 row = -1, lost = 0;
+        CHECK(s.CursorAcquire(bp, 8, row, lost) == ReadResult::Ok);
+        CHECK(row == 0 && lost == 0);
+        s.CursorAdvance(bp, 64);
+        CHECK(s.PushBlock(blk.data(), 64, W));
+        CHECK(s.EndRowAbs() == 320);
+        CHECK(!s.PushBlock(blk.data(), 1, W));
+
+        // 閉じれば制限は外れる
+        s.CloseCursor(bp);
+        CHECK(s.PushBlock(blk.data(), 600, W));
+        CHECK(s.EndRowAbs() == 920);
+    }
+}
+
+} // namespace
@@ -0,0 +1,164 @@
+// LineStoreExportTest.cpp
+// 書き出し（lineStoreExport.cpp）：PinRows の写し、読む前に上書きされた行の報告、終わった依頼の片付け
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "lineStore/lineStoreExport.hpp"
+#include "testCheck.hpp"
+
+namespace {
+
+using i64 = std::int64_t;
+
+std::uint16_t pixel(i64 r, int x) { return static_cast<std::uint16_t>(r * 3 + x); }
+
+// 行 [from, from + n) を 8 行ずつ（時刻は行 × 1 ms）
+void push_rows(LineStore& s, i64 from, i64 n, int W) {
+    std::vector<std::uint16_t> src(static_cast<size_t>(W) * 8);
+    for (i64 r = from; r < from + n; r += 8) {
+        for (int y = 0; y < 8; ++y)
+            for (int x = 0; x < W; ++x) src[static_cast<size_t>(y) * W + x] = pixel(r + y, x);
+        s.PushBlock(src.data(), 8, W * 2, r * 0.001);
+    }
+}
+
+std::vector<char> read_file(const std::string& path) {
+    std::ifstream f(path, std::ios::binary);
+    return { std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>() };
+}
+
+ExportRequest raw_request(const std::string& path, i64 b, i64 e, bool pin) {
+    ExportRequest req;
+    req.Path        = path;
+    req.Format      = ExportFormat::Raw;
+    req.RowBegin    = b;
+    req.RowEnd      = e;
+    req.PinRows     = pin;
+    req.TimeSidecar = false;
+    return req;
+}
+
+LS_TEST(export_pin_copies) {
+    // 前の依頼がまだ書かれていない行を待っている間にリングが何周しても、写した範囲はそのまま書き出せる。
+    // writer は止まらない（行を捨てない）
+    const int W = 16;
+    LineStoreOptions o;
+    o.Circular = true;
+    LineStore s(W, 0, W, 64, 8, PixelType::U16, o);
+    s.Commit();
+    push_rows(s, 0, 64, W);
+
+    const std::string blockPath = lstest::TempPath("ls_export_block.raw");
+    const std::string pinPath   = lstest::TempPath("ls_export_pin.raw");
+    LineStoreExporter ex(s);
+    const int block = ex.Submit(raw_request(blockPath, 1000, 1008, false));
+    auto      req   = raw_request(pinPath, 0, 64, true);
+    req.TimeSidecar = true;
+    const int pin   = ex.Submit(req);
+
+    push_rows(s, 64, 1000, W);
+    CHECK(s.DroppedRows() == 0);
+    CHECK(s.OldestRowAbs() > 64);
+
+    REQUIRE(ex.Wait(pin, std::chrono::seconds(10)));
+    const auto st = ex.Status(pin);
+    CHECK(st.State == ExportState::Done && st.RowsDone == 64 && st.LostRow == -1);
+    CHECK(ex.Status(block).State == ExportState::Done);
+
+    const auto data = read_file(pinPath);
+    REQUIRE(data.size() == static_cast<size_t>(64 * W * 2));
+    const auto* px = reinterpret_cast<const std::uint16_t*>(data.data());
+    bool same = true;
+    for (int r = 0; r < 64; ++r)
+        for (int x = 0; x < W; ++x) same = same && px[r * W + x] == pixel(r, x);
+    CHECK(same);
+
+    // 時刻（最後の Push の行も、後の Push で確定した値）
+    std::ifstream times(pinPath + ".times.csv");
+    std::string   line;
+    int           n = 0;
+    bool          timesOk = true;
+    while (std::getline(times, line)) {
+        long long row;
+        double    t;
+        if (std::sscanf(line.c_str(), "%lld,%lf", &row, &t) != 2) continue;
+        timesOk = timesOk && row == n && std::fabs(t - row * 0.001) < 1e-9;
+        ++n;
+    }
+    CHECK(n == 64 && timesOk);
+
+    // リングにもコールド層にも無い行からは受けない
+    {
+        bool threw = false;
+        try { ex.Submit(raw_request(pinPath, 0, 64, true)); } catch (const std::out_of_range&) { threw = true; }
+        CHECK(threw);
+    }
+    std::remove(blockPath.c_str());
+    std::remove(pinPath.c_str());
+    std::remove((pinPath + ".times.csv").c_str());
+}
+
+LS_TEST(export_lost_rows) {
+    // PinRows=false で読む前に上書きされれば Failed、LostRow に読めなかった最初の行（途中のファイルは残さない）
+    const int W = 16;
+    LineStoreOptions o;
+    o.Circular = true;
+    LineStore s(W, 0, W, 64, 8, PixelType::U16, o);
+    s.Commit();
+
+    const std::string blockPath = lstest::TempPath("ls_export_block2.raw");
+    const std::string lostPath  = lstest::TempPath("ls_export_lost.raw");
+    LineStoreExporter ex(s);
+    const int block = ex.Submit(raw_request(blockPath, 1000, 1008, false));
+    const int lost  = ex.Submit(raw_request(lostPath, 100, 164, false));
+    push_rows(s, 0, 1008, W);
+    CHECK(s.DroppedRows() == 0);
+
+    REQUIRE(ex.Wait(lost, std::chrono::seconds(10)));
+    const auto st = ex.Status(lost);
+    CHECK(st.State == ExportState::Failed);
+    CHECK(st.LostRow == 100);
+    CHECK(!std::ifstream(lostPath).good());
+    CHECK(ex.Status(block).State == ExportState::Done);
+    std::remove(blockPath.c_str());
+}
+
+LS_TEST(export_finished_jobs_removed) {
+    // 終わった依頼は Status で返した時点で消え、取りに来なければ KeepFinished 件を超えた古いものから消える
+    const int W = 16;
+    LineStoreOptions o;
+    o.Circular = true;
+    LineStore s(W, 0, W, 64, 8, PixelType::U16, o);
+    s.Commit();
+    push_rows(s, 0, 64, W);
+
+    const std::string path = lstest::TempPath("ls_export_keep.raw");
+    ExportOptions     eo;
+    eo.KeepFinished = 2;
+    LineStoreExporter ex(s, eo);
+
+    int ids[3];
+    for (int& id : ids) {
+        id = ex.Submit(raw_request(path, 0, 8, true));
+        REQUIRE(ex.Wait(id, std::chrono::seconds(10)));
+    }
+    auto gone = [&](int id) {
+        try { ex.Status(id); } catch (const std::out_of_range&) { return true; }
+        return false;
+    };
+    CHECK(gone(ids[0]));
+    CHECK(ex.Status(ids[1]).State == ExportState::Done);
+    CHECK(gone(ids[1]));
+    CHECK(ex.Status(ids[2]).State == ExportState::Done);
+    std::remove(path.c_str());
+}
+
+} // namespace
@@ -0,0 +1,120 @@
+// LineStoreFileTest.cpp
+// ファイルバック / 再開（lineStoreFile.cpp）
+
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "lineStore/lineStore2.hpp"
+#include "testCheck.hpp"
+
+namespace {
+
+using i64 = std::int64_t;
+
+void push_rows(LineStore& s, i64 from, int n, int W) {
+    std::vector<std::uint16_t> src(static_cast<size_t>(W) * n);
+    for (int y = 0; y < n; ++y)
+        for (int x = 0; x < W; ++x) src[static_cast<size_t>(y) * W + x] = static_cast<std::uint16_t>(from + y + x);
+    s.PushBlock(src.data(), n, W * 2, from * 0.01);
+}
+
+bool rows_match(const LineStore& s, int W) {
+    const i64 end = s.EndRowAbs();
+    std::vector<std::uint16_t> d(static_cast<size_t>(W) * 10);
+    for (i64 r = end - s.StoredLines(); r + 10 <= end; r += 37) {
+        double t = 0;
+        if (s.TryCopyWindow(r, W, 10, 0, d.data(), W * 2, t) != ReadResult::Ok) return false;
+        for (int y = 0; y < 10; ++y)
+            if (d[static_cast<size_t>(y) * W + 5] != static_cast<std::uint16_t>(r + y + 5)) return false;
+        if (std::fabs(t - r * 0.01) > 1e-6) return false;
+    }
+    return true;
+}
+
+LS_TEST(resume_torn) {
+    const int W = 32;
+    const std::string path = lstest::TempPath("lineStore_test_torn.bin");
+    {
+        LineStoreOptions o;
+        o.Circular = true;
+        o.FilePath = path;
+        LineStore s(W, 0, W, 1000, 10, PixelType::U16, o);
+        s.Commit();
+        for (i64 r = 0; r < 1500; r += 50) push_rows(s, r, 50, W);
+    }
+
+    // PushBlock が上書きの予約（ClaimIndex）を書いた後、行を書き終える前に止まった状態を作る
+    {
+        std::fstream f(path, std::ios::in | std::ios::out | std::ios::binary);
+        LineStoreFileHeader h{};
+        f.read(reinterpret_cast<char*>(&h), sizeof h);
+        REQUIRE(f && h.WriteIndex == 1500);
+        h.ClaimIndex = h.WriteIndex + 40;
+        f.seekp(0);
+        f.write(reinterpret_cast<const char*>(&h), sizeof h);
+    }
+
+    {
+        auto s = LineStore::OpenResume(path);
+        // 予約の先 40 行ぶんは上書きされかけているので、残るのは 1000 - 40 行
+        CHECK(s->EndRowAbs() == 1500);
+        CHECK(s->StoredLines() == 960);
+        std::vector<std::uint16_t> d(static_cast<size_t>(W) * 10);
+        double t = 0;
+        CHECK(s->TryCopyWindow(530, W, 10, 0, d.data(), W * 2, t) == ReadResult::Overwritten);
+        CHECK(s->TryCopyWindow(540, W, 10, 0, d.data(), W * 2, t) == ReadResult::Ok);
+        CHECK(rows_match(*s, W));
+
+        push_rows(*s, s->EndRowAbs(), 10, W);
+        CHECK(s->StoredLines() == 970);
+        CHECK(rows_match(*s, W));
+    }
+    std::filesystem::remove(path);
+}
+
+LS_TEST(resume_warmup_times) {
+    // Commit 前に止まっても、ウォームアップの行の時刻（一周したリングの並びのまま）はファイルに残る
+    const int W = 32;
+    const std::string path = lstest::TempPath("lineStore_test_warmup.bin");
+    {
+        LineStoreOptions o;
+        o.Circular = true;
+        o.FilePath = path;
+        LineStore s(W, 0, W, 200, 50, PixelType::U16, o);
+        for (i64 r = 0; r < 70; r += 7) push_rows(s, r, 7, W);
+    }
+
+    // 保持しているのは行 [20, 70)。時刻はその行を入れた Push のもの
+    auto times_match = [&](const LineStore& s, i64 first) {
+        for (i64 st = 0; st < 50; ++st) {
+            const void* ptr = nullptr;
+            int         stride = 0;
+            double      t = -1;
+            if (!s.TryGetWindowPtr(st, W, 1, 0, ptr, stride, t)) return false;
+            const i64 src = first + st;
+            if (static_cast<const std::uint16_t*>(ptr)[0] != static_cast<std::uint16_t>(src)) return false;
+            if (std::fabs(t - (src / 7) * 7 * 0.01) > 1e-9) return false;
+        }
+        return true;
+    };
+    {
+        auto s = LineStore::OpenResume(path);
+        CHECK(s->StoredLines() == 50);
+        CHECK(times_match(*s, 20));
+
+        push_rows(*s, 70, 7, W);
+        s->Commit();
+        CHECK(times_match(*s, 27));
+    }
+    {
+        auto s = LineStore::OpenReadOnly(path);
+        CHECK(times_match(*s, 27));
+    }
+    std::filesystem::remove(path);
+}
+
+} // namespace
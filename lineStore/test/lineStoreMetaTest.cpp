@@ -0,0 +1,125 @@
+// LineStoreMetaTest.cpp
+// 行ごとのメタデータ（lineStoreMeta.cpp）：ウォームアップ・リングを通した値、エンコーダ値 → 行
+
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "lineStore/lineStore2.hpp"
+#include "testCheck.hpp"
+
+namespace {
+
+using i64 = std::int64_t;
+
+// 取り込み元の行 r のメタデータ（エンコーダは 1 行 5 カウント）
+std::int64_t  encoder(i64 r) { return 1000 + 5 * r; }
+std::uint32_t trigger(i64 r) { return static_cast<std::uint32_t>(r + 7); }
+std::uint32_t frame(i64 r)   { return static_cast<std::uint32_t>(r / 8); }
+
+void push_meta(LineStore& s, i64 from, int n, int W) {
+    std::vector<std::uint8_t>  px(static_cast<size_t>(W) * n, 1);
+    std::vector<std::int64_t>  enc(static_cast<size_t>(n));
+    std::vector<std::uint32_t> trg(static_cast<size_t>(n)), frm(static_cast<size_t>(n));
+    for (int i = 0; i < n; ++i) {
+        enc[static_cast<size_t>(i)] = encoder(from + i);
+        trg[static_cast<size_t>(i)] = trigger(from + i);
+        frm[static_cast<size_t>(i)] = frame(from + i);
+    }
+    LineMetaBlock meta;
+    meta.Encoder      = enc.data();
+    meta.TriggerId    = trg.data();
+    meta.FrameCounter = frm.data();
+    s.PushBlock(px.data(), n, W, from * 0.01, meta);
+}
+
+LS_TEST(line_meta_values) {
+    // ウォームアップで一周（取り込み元の行 0..23 のうち 8..23 が残る = 絶対行 0..15）、Commit 後はリングで一周
+    const int W = 8;
+    LineStoreOptions o;
+    o.Circular = true;
+    o.LineMeta = true;
+    LineStore s(W, 0, W, 64, 16, PixelType::U8, o);
+    std::vector<std::int64_t> enc(64);
+    CHECK(s.TryCopyLineMeta(0, 1, enc.data(), nullptr, nullptr) == ReadResult::NotReady);
+    for (i64 r = 0; r < 24; r += 3) push_meta(s, r, 3, W);
+    s.Commit();
+    REQUIRE(s.TryCopyLineMeta(0, 16, enc.data(), nullptr, nullptr) == ReadResult::Ok);
+    bool warm = true;
+    for (int i = 0; i < 16; ++i) warm = warm && enc[static_cast<size_t>(i)] == encoder(i + 8);
+    CHECK(warm);
+    CHECK(s.FindRowAtEncoder(encoder(12)) == 4);
+
+    for (i64 r = 24; r < 24 + 150; r += 10) push_meta(s, r, 10, W);
+
+    const i64 oldest = s.OldestRowAbs(), end = s.EndRowAbs();
+    REQUIRE(end - oldest == 64);
+    std::vector<std::uint32_t> trg(64), frm(64);
+    REQUIRE(s.TryCopyLineMeta(oldest, 64, enc.data(), trg.data(), frm.data()) == ReadResult::Ok);
+    bool same = true;
+    for (int i = 0; i < 64; ++i) {
+        const i64 src = oldest + i + 8;
+        same = same && enc[static_cast<size_t>(i)] == encoder(src) && trg[static_cast<size_t>(i)] == trigger(src)
+                    && frm[static_cast<size_t>(i)] == frame(src);
+    }
+    CHECK(same);
+    CHECK(s.TryCopyLineMeta(oldest - 1, 1, enc.data(), nullptr, nullptr) == ReadResult::Overwritten);
+
+    // メタデータ無しの Push の行は 0
+    std::vector<std::uint8_t> px(static_cast<size_t>(W) * 2, 1);
+    s.PushBlock(px.data(), 2, W, 9.0);
+    REQUIRE(s.TryCopyLineMeta(end, 2, enc.data(), trg.data(), nullptr) == ReadResult::Ok);
+    CHECK(enc[0] == 0 && enc[1] == 0 && trg[0] == 0);
+}
+
+LS_TEST(line_meta_encoder_lookup) {
+    const int W = 8;
+    LineStoreOptions o;
+    o.Circular = true;
+    o.LineMeta = true;
+    LineStore s(W, 0, W, 64, 16, PixelType::U8, o);
+    s.Commit();
+    for (i64 r = 0; r < 200; r += 10) push_meta(s, r, 10, W); // 絶対行 = 取り込み元の行
+
+    const i64 oldest = s.OldestRowAbs();
+    REQUIRE(oldest == 136);
+    bool ok = true;
+    for (i64 r = oldest; r < 200; ++r) {
+        ok = ok && s.FindRowAtEncoder(encoder(r)) == r;       // ちょうどの値
+        ok = ok && s.FindRowAtEncoder(encoder(r) + 4) == r;   // 次の行の手前
+    }
+    CHECK(ok);
+    CHECK(s.FindRowAtEncoder(encoder(oldest) - 1) == -1);     // 最古の行より前
+    CHECK(s.FindRowAtEncoder(encoder(500)) == 199);           // 最新の行より先は最新の行
+
+    CHECK(s.RowAtEncoder(static_cast<double>(encoder(150))) == 150.0);
+    CHECK(std::fabs(s.RowAtEncoder(encoder(150) + 2.5) - 150.5) < 1e-12);
+    CHECK(std::isnan(s.RowAtEncoder(encoder(oldest) - 1.0)));
+    CHECK(std::isnan(s.RowAtEncoder(encoder(199) + 1.0)));
+
+    i64 b = 0, e = 0;
+    REQUIRE(s.GetRowRangeForEncoder(encoder(140), encoder(150) + 3, b, e));
+    CHECK(b == 140 && e == 151);
+    REQUIRE(s.GetRowRangeForEncoder(encoder(140) + 1, encoder(141), b, e));
+    CHECK(b == 141 && e == 142);
+    CHECK(!s.GetRowRangeForEncoder(encoder(140) + 1, encoder(140) + 4, b, e)); // 行の間
+}
+
+LS_TEST(line_meta_off) {
+    const int W = 8;
+    LineStore s(W, 0, W, 64, 16, PixelType::U8, true);
+    s.Commit();
+    std::vector<std::uint8_t> px(W, 1);
+    std::int64_t enc = 0;
+    LineMetaBlock meta;
+    meta.Encoder = &enc;
+    bool threw = false;
+    try { s.PushBlock(px.data(), 1, W, 0.0, meta); } catch (const std::logic_error&) { threw = true; }
+    CHECK(threw);
+    s.PushBlock(px.data(), 1, W, 0.0);
+    CHECK(s.TryCopyLineMeta(0, 1, &enc, nullptr, nullptr) == ReadResult::InvalidArg);
+    CHECK(s.FindRowAtEncoder(0) == -1);
+}
+
+} // namespace
@@ -0,0 +1,92 @@
+// LineStoreSpecializedTest.cpp
+// 特殊化した Push / 窓取得（lineStoreSpecialized.cpp）と BasicLineStore
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "lineStore/basicLineStore.hpp"
+#include "lineStore/lineStore2.hpp"
+#include "testCheck.hpp"
+
+namespace {
+
+using i64 = std::int64_t;
+
+std::uint16_t pixel(i64 r, int x) { return static_cast<std::uint16_t>(r * 5 + x); }
+
+std::vector<std::uint16_t> rows_of(i64 from, int n, int W) {
+    std::vector<std::uint16_t> src(static_cast<size_t>(W) * n);
+    for (int y = 0; y < n; ++y)
+        for (int x = 0; x < W; ++x) src[static_cast<size_t>(y) * W + x] = pixel(from + y, x);
+    return src;
+}
+
+bool window_is(const void* ptr, int stride, i64 srcRow, int w, int h, int x0) {
+    const auto* p = static_cast<const std::uint8_t*>(ptr);
+    for (int y = 0; y < h; ++y) {
+        const auto* row = reinterpret_cast<const std::uint16_t*>(p + static_cast<i64>(y) * stride);
+        for (int x = 0; x < w; ++x)
+            if (row[x] != pixel(srcRow + y, x0 + x)) return false;
+    }
+    return true;
+}
+
+// Commit 後のリングで、末尾を跨ぐ窓も含めて全ての開始行が読める（Mirrored でなければ写しを指す）
+template <class Store, class Ptr>
+void check_ring_windows(Store& s, LineStore& base, int W, i64 cap, int blk, i64 total) {
+    for (i64 r = 0; r < total; r += blk) {
+        const auto src = rows_of(r, blk, W);
+        REQUIRE(s.PushBlock(src.data(), blk, W * 2, r * 0.01));
+        const i64 pushed = r + blk;
+        const i64 stored = std::min(pushed, cap);
+        REQUIRE(base.StoredLines() == stored);
+
+        const int h = static_cast<int>(std::min<i64>(stored, 24));
+        for (i64 st = 0; st + h <= stored; ++st) {
+            Ptr    ptr    = nullptr;
+            int    stride = 0;
+            double t      = 0;
+            REQUIRE(s.TryGetWindowPtr(st, W - 3, h, 1, ptr, stride, t));
+            REQUIRE(window_is(ptr, stride, pushed - stored + st, W - 3, h, 1));
+            REQUIRE(std::fabs(t - (pushed - stored + st) * 0.01) < 1e-9); // Commit 後は Push の間を補間
+        }
+    }
+}
+
+LS_TEST(ring_seam_windows) {
+    const int W = 16;
+    LineStoreOptions o;
+    o.Circular = true;
+    LineStore s(W, 0, W, 100, 8, PixelType::U16, o); // 2 のべき乗でない容量（%）
+    s.Commit();
+    check_ring_windows<LineStore, const void*>(s, s, W, 100, 7, 266);
+}
+
+LS_TEST(ring_seam_windows_featured) {
+    // 付加機能のある Push（Plain でない版）でも同じ行が入る
+    const int W = 16;
+    LineStoreOptions o;
+    o.Circular    = true;
+    o.ColumnStats = ColumnStatsMode::Cumulative;
+    LineStore s(W, 0, W, 100, 8, PixelType::U16, o);
+    s.Commit();
+    check_ring_windows<LineStore, const void*>(s, s, W, 100, 7, 266);
+    CHECK(s.ColumnStats().Rows == 266);
+}
+
+LS_TEST(basic_line_store) {
+    const int W = 16;
+    BasicLineStore<std::uint16_t, true, true> s(W, 0, W, 128, 8);
+    s.Commit();
+    check_ring_windows<BasicLineStore<std::uint16_t, true, true>, const std::uint16_t*>(s, s.Store(), W, 128, 9, 400);
+
+    BasicLineStore<std::uint16_t, false> lin(W, 0, W, 128, 8);
+    lin.Commit();
+    const auto src = rows_of(0, 100, W);
+    CHECK(lin.PushBlock(src.data(), 100, W * 2, 0.0));
+    CHECK(!lin.PushBlock(src.data(), 100, W * 2, 1.0)); // 線形は容量で止まる
+    CHECK(lin.Store().EndRowAbs() == 128 && lin.Store().DroppedRows() == 72);
+}
+
+} // namespace
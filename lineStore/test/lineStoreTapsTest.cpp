@@ -0,0 +1,127 @@
+// LineStoreTapsTest.cpp
+// 分割書き込み（lineStoreTaps.cpp）
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "lineStore/lineStore2.hpp"
+#include "testCheck.hpp"
+
+namespace {
+
+using i64 = std::int64_t;
+
+LS_TEST(taps) {
+    const int W = 64;
+    const i64 N = 5000;
+    for (int circular = 0; circular < 2; ++circular) {
+        LineStoreOptions o;
+        o.Circular = (circular != 0);
+        LineStore s(W, 0, W, circular ? 1000 : N, 8, PixelType::U16, o);
+        const int a = s.RegisterTap(40, 24);
+        const int b = s.RegisterTap(0, 40);
+        bool overlapThrew = false;
+        try { s.RegisterTap(30, 20); } catch (const std::invalid_argument&) { overlapThrew = true; }
+        CHECK(overlapThrew);
+        s.Commit();
+
+        // tap ごとに別のブロック行数で書く（公開は遅い方の tap に合わせて進む）
+        auto writer = [&](int tap, int x0, int w, int blk) {
+            std::vector<std::uint16_t> src(static_cast<size_t>(w) * blk);
+            for (i64 r = 0; r < N;) {
+                const int n = static_cast<int>(std::min<i64>(blk, N - r));
+                for (int y = 0; y < n; ++y)
+                    for (int x = 0; x < w; ++x) src[static_cast<size_t>(y) * w + x] = static_cast<std::uint16_t>(r + y + x0 + x);
+                s.PushTap(tap, src.data(), n, w * 2, r * 0.001);
+                r += n;
+                if (r % 200 < blk) std::this_thread::sleep_for(std::chrono::microseconds(30));
+            }
+        };
+        std::thread t1(writer, a, 40, 24, 13);
+        std::thread t2(writer, b, 0, 40, 7);
+
+        // 公開された行は全 tap のぶんが揃っている（窓の全列が同じ行の値）
+        std::vector<std::uint16_t> buf(static_cast<size_t>(W) * 50);
+        i64  last = 0, checks = 0;
+        bool ordered = true, whole = true;
+        while (s.EndRowAbs() < N) {
+            const i64 e = s.EndRowAbs();
+            ordered &= (e >= last);
+            last = e;
+            if (e < 50) continue;
+            double t = 0;
+            if (s.TryCopyWindow(e - 50, W, 50, 0, buf.data(), W * 2, t) != ReadResult::Ok) continue;
+            ++checks;
+            for (int y = 0; y < 50; ++y)
+                for (int x = 0; x < W; ++x) whole &= (buf[static_cast<size_t>(y) * W + x] == static_cast<std::uint16_t>(e - 50 + y + x));
+        }
+        t1.join();
+        t2.join();
+
+        CHECK(ordered);
+        CHECK(whole);
+        CHECK(s.EndRowAbs() == N && s.HeadTotal() == N);
+        CHECK(s.StoredLines() == (circular ? 1000 : N));
+        std::printf("  circular=%d window checks=%lld\n", circular, static_cast<long long>(checks));
+
+        double t = 0;
+        REQUIRE(s.TryCopyWindow(N - 50, W, 50, 0, buf.data(), W * 2, t) == ReadResult::Ok);
+        CHECK(std::fabs(t - (N - 50) * 0.001) < 0.02);
+    }
+}
+
+LS_TEST(taps_time_published) {
+    // 公開された行には tap 0 の時間セグメントがある（tap 1 が先に進んでも、Push の先頭行の時刻はその Push の時刻。
+    // 時刻は行について非線形なので、セグメントが無ければ前のセグメントからの外挿になって合わない）
+    const int W   = 16;
+    const int BLK = 4;
+    const i64 N   = 4000;
+    LineStoreOptions o;
+    o.Circular = true;
+    LineStore s(W, 0, W, 256, 8, PixelType::U16, o);
+    const int lead = s.RegisterTap(0, 8);
+    const int rest = s.RegisterTap(8, 8);
+    s.Commit();
+
+    auto time_of = [](i64 blk) { return static_cast<double>(blk * blk) * 1e-4; };
+    auto writer  = [&](int tap, int x0, bool slow) {
+        std::vector<std::uint16_t> src(static_cast<size_t>(8) * BLK);
+        for (i64 r = 0; r < N; r += BLK) {
+            for (int y = 0; y < BLK; ++y)
+                for (int x = 0; x < 8; ++x) src[static_cast<size_t>(y) * 8 + x] = static_cast<std::uint16_t>(r + y + x0 + x);
+            s.PushTap(tap, src.data(), BLK, 8 * 2, time_of(r / BLK));
+            if (slow) std::this_thread::yield();
+        }
+    };
+    std::thread t0(writer, lead, 0, true);
+    std::thread t1(writer, rest, 8, false);
+
+    std::vector<std::uint16_t> row(W);
+    i64  checks = 0;
+    bool timed = true, whole = true;
+    while (s.EndRowAbs() < N) {
+        const i64 e = s.EndRowAbs();
+        if (e == 0) continue;
+        const i64 top = (e - 1) / BLK * BLK; // 最後に公開された Push の先頭行
+        double    t   = 0;
+        if (s.TryCopyWindow(top, W, 1, 0, row.data(), W * 2, t) != ReadResult::Ok) continue;
+        ++checks;
+        timed &= (std::fabs(t - time_of(top / BLK)) < 1e-9);
+        for (int x = 0; x < W; ++x) whole &= (row[static_cast<size_t>(x)] == static_cast<std::uint16_t>(top + x));
+    }
+    t0.join();
+    t1.join();
+
+    CHECK(timed);
+    CHECK(whole);
+    CHECK(checks > 0);
+    CHECK(s.EndRowAbs() == N);
+}
+
+} // namespace
@@ -0,0 +1,40 @@
+// LineStoreTest.cpp
+// lineStore_test の実行（ctest から呼ばれる）。失敗があれば終了コードが 0 以外になる
+//
+// 引数: --filter=<name>（テスト名に含む文字列で絞る）
+//
+// テストは対象のソースごとのファイル（<ソース名>Test.cpp）に LS_TEST で置く（testCheck.hpp）
+
+#include <cstdio>
+#include <exception>
+#include <string>
+#include "testCheck.hpp"
+
+int main(int argc, char** argv) {
+    std::string filter;
+    for (int i = 1; i < argc; ++i) {
+        const std::string a = argv[i];
+        if (a.rfind("--filter=", 0) == 0) filter = a.substr(9);
+        else {
+            std::fprintf(stderr, "usage: %s [--filter=<test>]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    int failed = 0;
+    for (const auto& t : lstest::Registry()) {
+        if (!filter.empty() && std::string(t.Name).find(filter) == std::string::npos) continue;
+        std::printf("[ RUN  ] %s\n", t.Name);
+        lstest::g_failures = 0;
+        try {
+            t.Fn();
+        } catch (const std::exception& e) {
+            ++lstest::g_failures;
+            std::printf("  exception: %s\n", e.what());
+        }
+        std::printf("[ %s ] %s\n", lstest::g_failures ? "FAIL" : " OK ", t.Name);
+        if (lstest::g_failures) ++failed;
+        std::fflush(stdout);
+    }
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,142 @@
+// LineStoreWindowsTest.cpp
+// 重なりのある窓の range（lineStoreWindows.cpp）：窓の並び・中身、物理末尾を跨ぐ窓のコピー、飛ばした行、終わり方
+
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "lineStore/lineStoreWindows.hpp"
+#include "testCheck.hpp"
+
+namespace {
+
+using i64 = std::int64_t;
+using namespace std::chrono_literals;
+
+std::uint16_t pixel(i64 r, int x) { return static_cast<std::uint16_t>(r * 3 + x); }
+
+void push_rows(LineStore& s, i64 from, int n, int W) {
+    std::vector<std::uint16_t> src(static_cast<size_t>(W) * n);
+    for (int y = 0; y < n; ++y)
+        for (int x = 0; x < W; ++x) src[static_cast<size_t>(y) * W + x] = pixel(from + y, x);
+    s.PushBlock(src.data(), n, W * 2, from * 0.001);
+}
+
+bool view_is(const WindowView& v, int x0) {
+    for (int y = 0; y < v.Height; ++y)
+        for (int x = 0; x < v.Width; ++x)
+            if (v.Row<std::uint16_t>(y)[x] != pixel(v.RowAbs + y, x0 + x)) return false;
+    return true;
+}
+
+LS_TEST(sliding_windows_follow_writer) {
+    // writer と並行に読む。Backpressure なので writer は読み終えていない行を潰さず、窓は欠けずに Step ずつ進む
+    const int W = 16;
+    LineStoreOptions o;
+    o.Circular = true;
+    LineStore s(W, 0, W, 100, 8, PixelType::U16, o); // 物理末尾を跨ぐ窓が出る（Mirrored でない）
+    s.Commit();
+
+    SlidingWindowOptions wo;
+    wo.Height      = 16;
+    wo.Step        = 6;
+    wo.X0          = 2;
+    wo.Width       = 10;
+    wo.StartRowAbs = 0;
+    wo.EndRowAbs   = 2000;
+    wo.Policy      = CursorPolicy::Backpressure;
+    SlidingWindows windows(s, wo);
+
+    std::thread writer([&] {
+        for (i64 r = 0; r < 2000; ++r) {
+            std::vector<std::uint16_t> src(static_cast<size_t>(W));
+            for (int x = 0; x < W; ++x) src[static_cast<size_t>(x)] = pixel(r, x);
+            while (!s.PushBlock(src.data(), 1, W * 2, r * 0.001)) std::this_thread::yield(); // 入り切らなければ待つ
+        }
+    });
+
+    i64  expect = 0;
+    int  copied = 0;
+    bool ok     = true;
+    for (const WindowView& v : windows) {
+        ok = ok && v.RowAbs == expect && v.GapRows == 0 && v.Width == 10 && v.Height == 16;
+        ok = ok && view_is(v, 2) && windows.Validate(v);
+        copied += v.Copied ? 1 : 0;
+        expect += 6;
+    }
+    writer.join();
+
+    CHECK(ok);
+    CHECK(expect == (2000 - 16) / 6 * 6 + 6); // 最後の窓は [1980, 1996)
+    CHECK(copied > 0);
+    CHECK(!windows.TimedOut());
+}
+
+LS_TEST(sliding_windows_gap_and_timeout) {
+    // 既に押し出された行から始めると、生き残っている最古の窓へ飛んで GapRows に数える。
+    // 行が来なければ Timeout で終わる
+    const int W = 16;
+    LineStoreOptions o;
+    o.Circular = true;
+    LineStore s(W, 0, W, 64, 8, PixelType::U16, o);
+    s.Commit();
+    for (i64 r = 0; r < 200; r += 10) push_rows(s, r, 10, W);
+
+    SlidingWindowOptions wo;
+    wo.Height      = 16;
+    wo.StartRowAbs = 0;
+    wo.Policy      = CursorPolicy::ReportGap;
+    wo.Timeout     = 20ms;
+    SlidingWindows windows(s, wo);
+
+    int  n  = 0;
+    bool ok = true;
+    for (const WindowView& v : windows) {
+        if (n == 0) ok = ok && v.RowAbs == 136 && v.GapRows == 136;
+        else        ok = ok && v.GapRows == 0;
+        ok = ok && view_is(v, 0);
+        ++n;
+    }
+    CHECK(ok);
+    CHECK(n == 4); // 136, 152, 168, 184
+    CHECK(windows.TimedOut());
+}
+
+LS_TEST(sliding_windows_stop) {
+    // 待っている range は別スレッドの Stop で終わる（TimedOut ではない）
+    const int W = 16;
+    LineStoreOptions o;
+    o.Circular = true;
+    LineStore s(W, 0, W, 64, 8, PixelType::U16, o);
+    s.Commit();
+
+    SlidingWindowOptions wo;
+    wo.Height = 8;
+    SlidingWindows windows(s, wo);
+    std::thread stopper([&] {
+        std::this_thread::sleep_for(20ms);
+        windows.Stop();
+    });
+    int n = 0;
+    for (const WindowView& v : windows) { (void)v; ++n; }
+    stopper.join();
+    CHECK(n == 0);
+    CHECK(!windows.TimedOut());
+
+    auto throws = [&](SlidingWindowOptions bad) {
+        try { SlidingWindows w(s, bad); } catch (const std::out_of_range&) { return true; }
+        return false;
+    };
+    SlidingWindowOptions tall;
+    tall.Height = 65;
+    CHECK(throws(tall));
+    SlidingWindowOptions wide;
+    wide.Height = 8;
+    wide.X0     = 10;
+    wide.Width  = 7;
+    CHECK(throws(wide));
+}
+
+} // namespace
@@ -0,0 +1,67 @@
+#pragma once
+// TestCheck.hpp
+// lineStore_test の小さな枠組み（外部のテストライブラリは使わない）
+//
+//   LS_TEST(name) { ... }  でテストを登録する（ファイルごとに、対象のソースに合わせて分ける）
+//   CHECK(cond)            失敗を数えて続ける
+//   REQUIRE(cond)          失敗を数えてテスト関数から抜ける（ループの中で同じ失敗を並べない）
+//
+// 実行は lineStoreTest.cpp の main。--filter=<name> でテスト名に含む文字列で絞る
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace lstest {
+
+using TestFn = void (*)();
+
+struct TestCase
+{
+    const char* Name;
+    TestFn      Fn;
+};
+
+// 登録順（翻訳単位の中では書いた順）
+inline std::vector<TestCase>& Registry() {
+    static std::vector<TestCase> tests;
+    return tests;
+}
+
+inline bool Register(const char* name, TestFn fn) {
+    Registry().push_back({ name, fn });
+    return true;
+}
+
+inline int g_failures = 0; // 今のテストで失敗した CHECK / REQUIRE の数
+
+// 一時ディレクトリのファイル名（ファイルバックのテスト用。使い終えたら消すこと）
+inline std::string TempPath(const char* name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+} // namespace lstest
+
+#define LS_TEST(name)                                                             \
+    static void name();                                                           \
+    static const bool name##_registered = ::lstest::Register(#name, &name);       \
+    static void name()
+
+#define CHECK(cond)                                                               \
+    do {                                                                          \
+        if (!(cond)) {                                                            \
+            ++::lstest::g_failures;                                               \
+            std::printf("  %s:%d: CHECK(%s)\n", __FILE__, __LINE__, #cond);       \
+        }                                                                         \
+    } while (0)
+
+#define REQUIRE(cond)                                                             \
+    do {                                                                          \
+        if (!(cond)) {                                                            \
+            ++::lstest::g_failures;                                               \
+            std::printf("  %s:%d: REQUIRE(%s)\n", __FILE__, __LINE__, #cond);     \
+            return;                                                               \
+        }                                                                         \
+    } while (0)
@@ -0,0 +1,155 @@
+// TimeIndex.cpp
+#include "timeIndex.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+// base から (a → b の傾き) で row の時刻を求める
+double time_from(const TimeSeg& base, const TimeSeg& a, const TimeSeg& b, std::int64_t row) noexcept {
+    const std::int64_t dx = b.Start - a.Start;
+    const double slope = (dx > 0) ? (b.T - a.T) / static_cast<double>(dx) : 0.0; // 秒/行
+    return base.T + static_cast<double>(row - base.Start) * slope;
+}
+
+// base から (a → b の傾き) で時刻 t の行を求める（切り捨て）
+std::int64_t row_from(const TimeSeg& base, const TimeSeg& a, const TimeSeg& b, double t) noexcept {
+    const std::int64_t dx = b.Start - a.Start;
+    const double dt = b.T - a.T;
+    if (dx <= 0 || !(dt > 0.0)) return base.Start; // 傾き無し（同時刻の行が続く）
+    constexpr double LIMIT = 4.0e18;                // i64 への変換で溢れないように
+    const double off = std::clamp((t - base.T) * static_cast<double>(dx) / dt, -LIMIT, LIMIT);
+    return base.Start + static_cast<std::int64_t>(std::floor(off));
+}
+
+} // namespace
+
+TimeIndex::TimeIndex(i64 capacity) {
+    if (capacity <= 0) throw std::out_of_range("capacity");
+    i64 cap = 1;
+    while (cap < capacity) cap <<= 1;
+    slots_.reset(new TimeSeg[static_cast<std::size_t>(cap)]());
+    mask_ = cap - 1;
+}
+
+// ---- writer ----
+void TimeIndex::Append(i64 start, double t) noexcept {
+    const i64 head = head_.load(std::memory_order_relaxed);
+    const i64 tail = tail_.load(std::memory_order_relaxed);
+    if (head - tail > mask_) {
+        // 満杯：最古のスロットを潰す。先に tail_ を進めて reader に知らせる
+        tail_.store(head - mask_, std::memory_order_relaxed);
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+    }
+    // 書くスロットは満杯で潰したものか、TrimBefore で空けたもの。どちらも tail_ を進めた後なので、
+    // release fence 以降のスロット書き込みを見た reader は、その tail_ も必ず見る（TrimBefore の release store は
+    // それより前の書き込みしか並べないので、ここで毎回 fence を置く）
+    std::atomic_thread_fence(std::memory_order_release);
+    slots_[static_cast<std::size_t>(head & mask_)] = TimeSeg{ start, t };
+    head_.store(head + 1, std::memory_order_release);
+}
+
+void TimeIndex::TrimBefore(i64 row) noexcept {
+    const i64 head = head_.load(std::memory_order_relaxed);
+    const i64 tail = tail_.load(std::memory_order_relaxed);
+    i64 t = tail;
+    while (head - t >= 2 && Slot(t + 1).Start <= row) ++t;
+    if (t != tail) tail_.store(t, std::memory_order_release);
+}
+
+void TimeIndex::Assign(const TimeSeg* segs, i64 n) noexcept {
+    const i64 keep = std::min(n, Capacity());
+    for (i64 i = 0; i < keep; ++i)
+        slots_[static_cast<std::size_t>(i)] = segs[n - keep + i];
+    dropped_.fetch_add(n - keep, std::memory_order_relaxed);
+    tail_.store(0, std::memory_order_relaxed);
+    head_.store(keep, std::memory_order_release);
+}
+
+// ---- reader ----
+TimeIndex::i64 TimeIndex::Count() const noexcept {
+    const i64 head = head_.load(std::memory_order_acquire);
+    return head - tail_.load(std::memory_order_acquire);
+}
+
+TimeIndex::i64 TimeIndex::Dropped() const noexcept {
+    return dropped_.load(std::memory_order_relaxed);
+}
+
+bool TimeIndex::TimeAt(i64 row, double& t) const noexcept {
+    for (;;) {
+        const i64 head = head_.load(std::memory_order_acquire);
+        const i64 tail = tail_.load(std::memory_order_acquire);
+        if (head <= tail) return false;
+
+        i64  minRead = head; // 読んだ最小の通し番号
+        auto read    = [&](i64 i) -> const TimeSeg& { minRead = std::min(minRead, i); return Slot(i); };
+
+        // max(Start <= row) を二分探索
+        i64 lo = tail, hi = head - 1, k = tail - 1;
+        while (lo <= hi) {
+            const i64 mid = lo + (hi - lo) / 2;
+            if (read(mid).Start <= row) { k = mid; lo = mid + 1; }
+            else                        { hi = mid - 1; }
+        }
+
+        i64 a, b, base;
+        if (k < tail)           { base = tail; a = tail;                     b = std::min(tail + 1, head - 1); } // 先頭より前：先頭の傾きで外挿
+        else if (k == head - 1) { base = k;    a = std::max(tail, k - 1);    b = k; }                            // 末尾：直前の傾きで外挿
+        else                    { base = k;    a = k;                        b = k + 1; }                        // 区間内：線形補間
+        const TimeSeg sBase = read(base), sA = read(a), sB = read(b);
+
+        // 読んだスロットが潰されていなければ確定（潰されていたら読み直し）
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (tail_.load(std::memory_order_relaxed) > minRead) continue;
+
+        t = time_from(sBase, sA, sB, row);
+        return true;
+    }
+}
+
+bool TimeIndex::RowAt(double t, i64& row) const noexcept {
+    for (;;) {
+        const i64 head = head_.load(std::memory_order_acquire);
+        const i64 tail = tail_.load(std::memory_order_acquire);
+        if (head <= tail) return false;
+
+        i64  minRead = head;
+        auto read    = [&](i64 i) -> const TimeSeg& { minRead = std::min(minRead, i); return Slot(i); };
+
+        // max(T <= t) を二分探索（時刻は単調非減少の前提）
+        i64 lo = tail, hi = head - 1, k = tail - 1;
+        while (lo <= hi) {
+            const i64 mid = lo + (hi - lo) / 2;
+            if (read(mid).T <= t) { k = mid; lo = mid + 1; }
+            else                  { hi = mid - 1; }
+        }
+
+        i64 a, b, base;
+        if (k < tail)           { base = tail; a = tail;                  b = std::min(tail + 1, head - 1); }
+        else if (k == head - 1) { base = k;    a = std::max(tail, k - 1); b = k; }
+        else                    { base = k;    a = k;                     b = k + 1; }
+        const TimeSeg sBase = read(base), sA = read(a), sB = read(b);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (tail_.load(std::memory_order_relaxed) > minRead) continue;
+
+        row = row_from(sBase, sA, sB, t);
+        return true;
+    }
+}
+
+TimeIndex::i64 TimeIndex::CopyTo(TimeSeg* out, i64 maxN) const noexcept {
+    for (;;) {
+        const i64 head = head_.load(std::memory_order_acquire);
+        const i64 tail = tail_.load(std::memory_order_acquire);
+        const i64 n    = std::clamp<i64>(head - tail, 0, std::max<i64>(maxN, 0));
+        for (i64 i = 0; i < n; ++i) out[i] = Slot(head - n + i);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (tail_.load(std::memory_order_relaxed) > head - n) continue;
+        return n;
+    }
+}
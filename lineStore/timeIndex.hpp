@@ -0,0 +1,65 @@
+#pragma once
+// TimeIndex.hpp
+// 行 → 時刻の区分線形インデックス（時間セグメントの固定長リング）
+//
+// writer は 1 スレッド（Append / TrimBefore / Assign）、reader は任意スレッドからロック無しで読む。
+// 書き込みで古いスロットを潰す前に tail_ を進めるので、reader は読み終えた後に tail_ を見直して
+// 自分が読んだ範囲が潰されていないことを確認する（潰されていたら読み直す）
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+// 時間セグメント：論理行 Start 以降の行は、次のセグメントまで T から線形に進む
+struct TimeSeg
+{
+    std::int64_t Start; // 論理行インデックス（Commit 時のウォームアップ末尾 = 0）
+    double       T;     // Unix sec
+};
+
+class TimeIndex
+{
+public:
+    using i64 = std::int64_t;
+
+    // capacity は 2 のべき乗に切り上げる
+    explicit TimeIndex(i64 capacity);
+
+    TimeIndex(const TimeIndex&) = delete;
+    TimeIndex& operator=(const TimeIndex&) = delete;
+
+    // ---- writer ----
+    // 末尾に追加。満杯なら最古のセグメントを捨てる（Dropped() に数える）
+    void Append(i64 start, double t) noexcept;
+
+    // 論理行 row より前の行だけを覆うセグメントを捨てる（row を覆うセグメントは残す）
+    void TrimBefore(i64 row) noexcept;
+
+    // 中身を segs[0..n) で置き換える（容量を超える分は古い方を捨てる）。reader がいない時に呼ぶこと
+    void Assign(const TimeSeg* segs, i64 n) noexcept;
+
+    // ---- reader ----
+    i64 Capacity() const noexcept { return mask_ + 1; }
+    i64 Count()    const noexcept; // 現在保持しているセグメント数
+    i64 Dropped()  const noexcept; // 満杯で捨てたセグメント数（その区間の時刻は外挿になる）
+
+    // 論理行 row の時刻（セグメント間は線形補間、末尾は直前の傾きで外挿）。空なら false
+    bool TimeAt(i64 row, double& t) const noexcept;
+
+    // 時刻 t に対応する論理行の推定値（TimeAt の逆写像）。空なら false
+    // 補間の丸めで前後 1 行ずれることがあるので、厳密な境界は呼び出し側で TimeAt を使って詰める
+    bool RowAt(double t, i64& row) const noexcept;
+
+    // 保持しているセグメントのうち新しい方の最大 maxN 個を古い順に out へ写す。写した数を返す
+    i64 CopyTo(TimeSeg* out, i64 maxN) const noexcept;
+
+private:
+    const TimeSeg& Slot(i64 i) const noexcept { return slots_[static_cast<std::size_t>(i & mask_)]; }
+
+    std::unique_ptr<TimeSeg[]> slots_;
+    i64                        mask_;
+
+    std::atomic<i64> head_{0};    // 次に書く通し番号（この値未満が公開済み）
+    std::atomic<i64> tail_{0};    // 最古の有効な通し番号（これ未満のスロットは再利用される）
+    std::atomic<i64> dropped_{0};
+};
@@ -0,0 +1,72 @@
+// WaitWord.cpp
+#include "waitWord.hpp"
+
+#include <algorithm>
+#include <thread>
+
+#if defined(_WIN32)
+  #ifndef NOMINMAX
+    #define NOMINMAX
+  #endif
+  #include <windows.h>
+  #include <synchapi.h>
+#elif defined(__linux__)
+  #include <linux/futex.h>
+  #include <sys/syscall.h>
+  #include <time.h>
+  #include <unistd.h>
+#endif
+
+static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t), "futex word must be 32bit");
+
+void WaitWord(const std::atomic<std::uint32_t>& word, std::uint32_t expected,
+              std::chrono::nanoseconds timeout) noexcept
+{
+    using namespace std::chrono;
+    if (timeout <= nanoseconds::zero()) return;
+    const bool infinite = (timeout == nanoseconds::max());
+
+#if defined(_WIN32)
+    DWORD ms = INFINITE;
+    if (!infinite) {
+        // ミリ秒へ切り上げ（0 にすると待たずに戻ってしまう）
+        const auto m = duration_cast<milliseconds>(timeout + milliseconds(1) - nanoseconds(1)).count();
+        ms = static_cast<DWORD>(std::min<long long>(m, INFINITE - 1));
+    }
+    auto* addr = const_cast<std::atomic<std::uint32_t>*>(&word);
+    WaitOnAddress(addr, &expected, sizeof(expected), ms);
+#elif defined(__linux__)
+    timespec ts{};
+    timespec* pts = nullptr;
+    if (!infinite) {
+        const auto s = duration_cast<seconds>(timeout);
+        ts.tv_sec  = static_cast<time_t>(s.count());
+        ts.tv_nsec = static_cast<long>((timeout - s).count());
+        pts = &ts;
+    }
+    // FUTEX_WAIT の timeout は相対時間。値が expected でなければ EAGAIN ですぐ戻る
+    syscall(SYS_futex, reinterpret_cast<const std::uint32_t*>(&word), FUTEX_WAIT_PRIVATE, expected, pts, nullptr, 0);
+#else
+    // タイムアウト付きの待機が無い環境：無期限なら atomic::wait、それ以外は短い間隔で見直す
+    if (infinite) {
+        word.wait(expected, std::memory_order_acquire);
+        return;
+    }
+    const auto deadline = steady_clock::now() + timeout;
+    while (word.load(std::memory_order_acquire) == expected) {
+        const auto now = steady_clock::now();
+        if (now >= deadline) return;
+        std::this_thread::sleep_for(std::min<nanoseconds>(deadline - now, microseconds(50)));
+    }
+#endif
+}
+
+void WakeWordAll(std::atomic<std::uint32_t>& word) noexcept {
+#if defined(_WIN32)
+    WakeByAddressAll(&word);
+#elif defined(__linux__)
+    syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAKE_PRIVATE, INT32_MAX, nullptr, nullptr, 0);
+#else
+    word.notify_all();
+#endif
+}
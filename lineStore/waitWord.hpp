@@ -0,0 +1,17 @@
+#pragma once
+// WaitWord.hpp
+// 32bit の atomic 語に対する待機/起床（Linux: futex, Windows: WaitOnAddress）
+// std::atomic::wait にはタイムアウトが無いので、タイムアウト付きの待機をここで用意する
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// word が expected のままなら起こされるまで（最大 timeout）眠る。
+// 値が既に違う・起こされた・タイムアウト・見かけ上の起床のどれでも戻るので、呼び出し側で条件を見直すこと。
+// timeout == nanoseconds::max() なら無期限
+void WaitWord(const std::atomic<std::uint32_t>& word, std::uint32_t expected,
+              std::chrono::nanoseconds timeout) noexcept;
+
+// word で眠っている全スレッドを起こす
+void WakeWordAll(std::atomic<std::uint32_t>& word) noexcept;